@@ -134,6 +134,15 @@ main(int argc, char **argv)
             print.slice();
             print.write_svg(outfile);
             boost::nowide::cout << "SVG file exported to " << outfile << std::endl;
+        } else if (cli_config.export_png) {
+            std::string outfile = cli_config.output.value;
+            if (outfile.empty()) outfile = model.objects.front()->input_file + ".zip";
+            
+            SLAPrint print(&model);
+            print.config.apply(print_config, true);
+            print.slice();
+            print.write_png(outfile);
+            boost::nowide::cout << "PNG images exported to " << outfile << std::endl;
         } else if (cli_config.export_3mf) {
             std::string outfile = cli_config.output.value;
             if (outfile.empty()) outfile = model.objects.front()->input_file;
@@ -145,6 +154,17 @@ main(int argc, char **argv)
                 outfile = outfile.substr(0, outfile.find_last_of('.')) + ".3mf";
             IO::TMF::write(model, outfile);
             boost::nowide::cout << "File file exported to " << outfile << std::endl;
+        } else if (cli_config.export_snapshot) {
+            std::string outfile = cli_config.output.value;
+            if (outfile.empty()) outfile = model.objects.front()->input_file + ".snapshot";
+            
+            // store the repaired meshes, so that reloading the snapshot skips the repair
+            model.repair();
+            if (!IO::Snapshot::write(model, outfile)) {
+                boost::nowide::cerr << "Failed to write " << outfile << std::endl;
+                return 1;
+            }
+            boost::nowide::cout << "Snapshot exported to " << outfile << std::endl;
         } else if (cli_config.cut_x > 0 || cli_config.cut_y > 0 || cli_config.cut > 0) {
             model.repair();
             model.translate(0, 0, -model.bounding_box().min.z);
@@ -0,0 +1,100 @@
+#include "Config.hpp"
+#include "Layer.hpp"
+#include "Model.hpp"
+#include "Print.hpp"
+#include "PrintConfig.hpp"
+#include "Surface.hpp"
+#include "libslic3r.h"
+#include "Fill/Fill.hpp"
+#include <boost/nowide/args.hpp>
+#include <boost/nowide/iostream.hpp>
+#include <chrono>
+#include <memory>
+
+using namespace Slic3r;
+
+void confess_at(const char *file, int line, const char *func, const char *pat, ...){}
+
+int
+main(int argc, char **argv)
+{
+    // Convert arguments to UTF-8 (needed on Windows).
+    // argv then points to memory owned by a.
+    boost::nowide::args a(argc, argv);
+
+    // read config: the print options plus the number of timed passes
+    ConfigDef config_def;
+    {
+        ConfigOptionDef* def = config_def.add("passes", coInt);
+        def->label = "Number of timed passes";
+        def->cli = "passes=i";
+        def->default_value = new ConfigOptionInt(3);
+    }
+    config_def.merge(print_config_def);
+    DynamicConfig config(&config_def);
+    t_config_option_keys input_files;
+    config.read_cli(argc, argv, &input_files);
+    const int passes = std::max(1, config.option("passes", true)->getInt());
+
+    DynamicPrintConfig print_config;
+    print_config.apply(config, true);
+    PrintRegionConfig region_config;
+    region_config.apply(config, true);
+
+    // the scanline patterns at the sparse densities, plus solid rectilinear infill
+    const char* patterns[] = { "rectilinear", "grid", "triangles", "stars", "cubic" };
+    const float densities[] = { 0.05f, 0.1f, 0.15f, 0.2f, 0.4f, 1.f };
+
+    for (t_config_option_keys::const_iterator it = input_files.begin(); it != input_files.end(); ++it) {
+        Model model = Model::read_from_file(*it);
+        model.add_default_instances();
+
+        // slice the objects once, every pattern then fills the same layer slices
+        Print print;
+        print.apply_config(print_config);
+        for (ModelObject* object : model.objects)
+            print.add_model_object(object);
+        std::vector<std::pair<const PrintObject*, const Layer*>> layers;
+        FOREACH_OBJECT(&print, object) {
+            (*object)->_slice();
+            FOREACH_LAYER(*object, layer)
+                layers.push_back(std::make_pair(*object, *layer));
+        }
+        if (layers.empty()) continue;
+
+        for (const char* pattern : patterns) {
+            for (float density : densities) {
+                std::unique_ptr<Fill> fill(Fill::new_from_type(pattern));
+                if (density > 0.9999f && !fill->can_solid()) continue;
+                fill->min_spacing = 0.45;  // typical infill spacing of a 0.4 mm nozzle
+                fill->angle = Geometry::deg2rad(region_config.fill_angle.value);
+                fill->density = density;
+
+                size_t polylines = 0;
+                double length = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (int pass = 0; pass < passes; ++pass) {
+                    polylines = 0;
+                    length = 0;
+                    for (const std::pair<const PrintObject*, const Layer*> &layer : layers) {
+                        fill->bounding_box = layer.first->bounding_box();
+                        fill->layer_id = layer.second->id();
+                        fill->z = layer.second->print_z;
+                        for (const ExPolygon &expolygon : layer.second->slices.expolygons) {
+                            const Polylines pp = fill->fill_surface(Surface(stInternal, expolygon));
+                            polylines += pp.size();
+                            for (const Polyline &p : pp)
+                                length += p.length();
+                        }
+                    }
+                }
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                boost::nowide::cout << *it << ": " << pattern << " " << int(density * 100 + 0.5) << "%: "
+                    << (layers.size() * passes / seconds) << " layers/s, "
+                    << polylines << " polylines, " << unscale(length) << " mm" << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
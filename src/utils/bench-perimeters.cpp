@@ -0,0 +1,84 @@
+#include "Config.hpp"
+#include "Layer.hpp"
+#include "Model.hpp"
+#include "Print.hpp"
+#include "PrintConfig.hpp"
+#include "libslic3r.h"
+#include "clipper.hpp"
+#include <boost/nowide/args.hpp>
+#include <boost/nowide/iostream.hpp>
+#include <chrono>
+
+using namespace Slic3r;
+
+void confess_at(const char *file, int line, const char *func, const char *pat, ...){}
+
+int
+main(int argc, char **argv)
+{
+    // Convert arguments to UTF-8 (needed on Windows).
+    // argv then points to memory owned by a.
+    boost::nowide::args a(argc, argv);
+
+    // read config: the print options plus the number of timed passes
+    ConfigDef config_def;
+    {
+        ConfigOptionDef* def = config_def.add("passes", coInt);
+        def->label = "Number of timed passes";
+        def->cli = "passes=i";
+        def->default_value = new ConfigOptionInt(3);
+    }
+    config_def.merge(print_config_def);
+    DynamicConfig config(&config_def);
+    t_config_option_keys input_files;
+    config.read_cli(argc, argv, &input_files);
+    const int passes = std::max(1, config.option("passes", true)->getInt());
+
+    DynamicPrintConfig print_config;
+    print_config.apply(config, true);
+
+    for (t_config_option_keys::const_iterator it = input_files.begin(); it != input_files.end(); ++it) {
+        Model model = Model::read_from_file(*it);
+        model.add_default_instances();
+
+        // slice the objects once, the perimeters are then generated from the same slices at every pass
+        Print print;
+        print.apply_config(print_config);
+        for (ModelObject* object : model.objects)
+            print.add_model_object(object);
+        size_t layers = 0, islands = 0;
+        FOREACH_OBJECT(&print, object) {
+            (*object)->_slice();
+            layers += (*object)->layers.size();
+            FOREACH_LAYER(*object, layer)
+                FOREACH_LAYERREGION(*layer, layerm)
+                    islands += (*layerm)->slices.surfaces.size();
+        }
+        if (layers == 0) continue;
+
+        size_t loops = 0;
+        const ClipperLib::AllocationStats stats_start = ClipperLib::GetAllocationStats();
+        const auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            loops = 0;
+            FOREACH_OBJECT(&print, object) {
+                FOREACH_LAYER(*object, layer) {
+                    FOREACH_LAYERREGION(*layer, layerm) {
+                        SurfaceCollection fill_surfaces;
+                        (*layerm)->make_perimeters((*layerm)->slices, &fill_surfaces);
+                        loops += (*layerm)->perimeters.items_count();
+                    }
+                }
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const ClipperLib::AllocationStats stats = ClipperLib::GetAllocationStats();
+        boost::nowide::cout << *it << ": " << layers << " layers, " << islands << " islands, "
+            << loops << " perimeter collections: "
+            << (layers * passes / seconds) << " layers/s, "
+            << (stats.Objects - stats_start.Objects) << " Clipper structures from "
+            << (stats.HeapBlocks - stats_start.HeapBlocks) << " heap blocks" << std::endl;
+    }
+
+    return 0;
+}
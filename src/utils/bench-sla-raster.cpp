@@ -0,0 +1,73 @@
+#include "Config.hpp"
+#include "Model.hpp"
+#include "PrintConfig.hpp"
+#include "SLAPrint.hpp"
+#include "libslic3r.h"
+#include <boost/bind.hpp>
+#include <boost/nowide/args.hpp>
+#include <boost/nowide/iostream.hpp>
+#include <chrono>
+
+using namespace Slic3r;
+
+void confess_at(const char *file, int line, const char *func, const char *pat, ...){}
+
+static void
+render_layer(const SLAPrint* print, bool encode, size_t i)
+{
+    const Raster raster = print->rasterize_layer(i);
+    if (encode) raster.png();
+}
+
+int
+main(int argc, char **argv)
+{
+    // Convert arguments to UTF-8 (needed on Windows).
+    // argv then points to memory owned by a.
+    boost::nowide::args a(argc, argv);
+
+    // read config: the SLA print options plus the number of timed passes
+    ConfigDef config_def;
+    {
+        ConfigOptionDef* def = config_def.add("passes", coInt);
+        def->label = "Number of timed passes";
+        def->cli = "passes=i";
+        def->default_value = new ConfigOptionInt(3);
+    }
+    config_def.merge(print_config_def);
+    DynamicConfig config(&config_def);
+    t_config_option_keys input_files;
+    config.read_cli(argc, argv, &input_files);
+    const int passes = std::max(1, config.option("passes", true)->getInt());
+
+    for (t_config_option_keys::const_iterator it = input_files.begin(); it != input_files.end(); ++it) {
+        Model model = Model::read_from_file(*it);
+        model.add_default_instances();
+
+        SLAPrint print(&model);
+        print.config.set_defaults();
+        print.config.apply(config, true);
+        print.slice();
+        if (print.layers.empty()) continue;
+
+        for (int encode = 0; encode <= 1; ++encode) {
+            for (int threads = 1; ; threads = std::min(threads * 2, print.config.threads.value)) {
+                const auto start = std::chrono::steady_clock::now();
+                for (int pass = 0; pass < passes; ++pass)
+                    parallelize<size_t>(
+                        0,
+                        print.layers.size() - 1,
+                        boost::bind(&render_layer, &print, encode != 0, _1),
+                        threads
+                    );
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                boost::nowide::cout << *it << ": " << print.layers.size() << " layers, "
+                    << (encode ? "raster + PNG" : "raster") << ", " << threads << " threads: "
+                    << (print.layers.size() * passes / seconds) << " layers/s" << std::endl;
+                if (threads >= print.config.threads.value) break;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -1,4 +1,4 @@
-use Test::More tests => 16;
+use Test::More tests => 22;
 use strict;
 use warnings;
 
@@ -54,6 +54,23 @@ use Slic3r::Test;
         "nested config options";
 }
 
+{
+    my $parser = Slic3r::GCode::PlaceholderParser->new;
+    $parser->set_multiple('foo', ['a', 'b']);
+    $parser->set('bar', '[baz]x');
+    $parser->set('baz', 'Z');
+    $parser->set('self', '[self]!');
+    is $parser->process('[foo_0][foo_1][foo_2]'), 'aba',
+        'index past the last value gets the first value after the previous indices';
+    is $parser->process('[foo_2]'), '[foo_2]',
+        'isolated index past the last value is left unsubstituted';
+    is $parser->process('[foo_1][foo_3]'), 'b[foo_3]',
+        'index past the last value is left unsubstituted after a gap';
+    is $parser->process('[bar]'), 'Zx', 'placeholders in substituted values are expanded';
+    is $parser->process('[self]'), '[self]!', 'self-referencing value is expanded once';
+    is $parser->process('[unknown] [foo_1a]'), '[unknown] [foo_1a]', 'unknown placeholders are left untouched';
+}
+
 {
     my $config = Slic3r::Config->new_from_defaults;
     $config->set('output_filename_format', 'ts_[travel_speed]_lh_[layer_height].gcode');
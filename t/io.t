@@ -0,0 +1,77 @@
+use Test::More tests => 5;
+use strict;
+use warnings;
+
+BEGIN {
+    use FindBin;
+    use lib "$FindBin::Bin/../lib";
+    use local::lib "$FindBin::Bin/../local-lib";
+}
+
+use File::Temp qw(tempdir);
+use Slic3r;
+
+my $dir = tempdir(CLEANUP => 1);
+
+sub write_file {
+    my ($path, $contents) = @_;
+    open my $fh, '>', $path or die "Failed to open $path for writing\n";
+    print $fh $contents;
+    close $fh;
+    return $path;
+}
+
+{
+    # 20mm cube with quads, comment lines and trailing comments
+    my $path = write_file("$dir/cube.obj", <<'EOF');
+# cube exported for the OBJ reader tests
+o cube
+v 0 0 0 # first vertex
+v 20 0 0
+v 20 20 0
+v 0 20 0
+v 0 0 20
+v 20 0 20
+v 20 20 20   # trailing comment after blanks
+v 0 20 20
+vn 0 0 1
+f 1 4 3 2 # bottom
+f 5 6 7 8
+f 1/1 2/2 6/6 5/5
+f 2//1 3//1 7//1 6//1
+f 3 4 8 7#no blank before the comment
+f -8 -4 -1 -5
+EOF
+    my $model = Slic3r::Model->read_from_file($path);
+    is $model->objects_count, 1, 'OBJ with comments is read';
+    my $volume = $model->get_object(0)->get_volume(0);
+    is $volume->mesh->facets_count, 12, 'quads are triangulated and trailing comments are ignored';
+    my $mesh = $volume->mesh->clone;
+    $mesh->repair;
+    ok abs($mesh->volume - 20*20*20) < 1E-2, 'OBJ mesh has the expected volume';
+}
+
+{
+    my $path = write_file("$dir/groups.obj", <<'EOF');
+v 0 0 0
+v 10 0 0
+v 0 10 0
+g first
+f 1 2 3
+# the second group reuses the vertices of the first one
+g second
+f 3 2 1
+EOF
+    my $model = Slic3r::Model->read_from_file($path);
+    is $model->get_object(0)->volumes_count, 2, 'each OBJ group becomes a volume';
+}
+
+{
+    my $path = write_file("$dir/broken.obj", <<'EOF');
+v 0 0 0
+f 1 2 x
+EOF
+    ok !eval { Slic3r::Model->read_from_file($path); 1 }, 'malformed OBJ face is reported';
+}
+
+__END__
@@ -1,4 +1,4 @@
-use Test::More tests => 63;
+use Test::More tests => 64;
 use strict;
 use warnings;
 
@@ -433,6 +433,19 @@ use Slic3r::Test;
     ok Slic3r::Test::gcode($print), 'successful generation of G-code with seam_position = random';
 }
 
+{
+    # the islands of a layer are shared among the threads, the result must not depend on them
+    my $gcode = sub {
+        my ($threads) = @_;
+        my $config = Slic3r::Config->new_from_defaults;
+        $config->set('threads', $threads);
+        my $gcode = Slic3r::Test::gcode(Slic3r::Test::init_print('two_hollow_squares', config => $config));
+        # skip the comments, they hold the time stamp and the config
+        return join "\n", grep !/^;/, split /\n/, $gcode;
+    };
+    ok $gcode->(4) eq $gcode->(1), 'perimeters of several islands do not depend on the number of threads';
+}
+
 {
     my $test = sub {
         my ($model_name) = @_;
@@ -0,0 +1,84 @@
+use Test::More tests => 9;
+use strict;
+use warnings;
+
+BEGIN {
+    use FindBin;
+    use lib "$FindBin::Bin/../lib";
+    use local::lib "$FindBin::Bin/../local-lib";
+}
+
+use File::Temp qw(tempdir);
+use IO::Uncompress::Unzip qw(unzip $UnzipError);
+use Slic3r;
+use Slic3r::Test;
+
+my $dir = tempdir(CLEANUP => 1);
+
+sub sla_print {
+    my ($model_name, %config) = @_;
+
+    my $config = Slic3r::Config->new_from_defaults;
+    # the default infill width is relative to the nozzle, which SLA has none of
+    $config->set('infill_extrusion_width', 0.5);
+    $config->set($_, $config{$_}) for keys %config;
+    # SLAPrint only keeps a pointer to the model, which has to outlive it
+    my $model = Slic3r::Test::model($model_name);
+    my $print = Slic3r::SLAPrint->new($model);
+    $print->apply_config($config);
+    $print->slice;
+    return ($print, $model);
+}
+
+# Returns the width and height of a PNG image, or undef if the data is not a PNG image.
+sub png_size {
+    my ($data) = @_;
+    return undef if substr($data, 0, 8) ne "\x89PNG\r\n\x1a\n" || substr($data, 12, 4) ne 'IHDR';
+    return [ unpack 'NN', substr($data, 16, 8) ];
+}
+
+{
+    # the bridge model is 50mm x 10mm
+    my ($print, $model) = sla_print('bridge', raster_dpi => 254);
+    my $file = "$dir/bridge.zip";
+    $print->write_png($file);
+
+    my @sizes = map {
+        my $name = sprintf 'layer%05d.png', $_;
+        unzip($file => \my $png, Name => $name) ? png_size($png) : undef;
+    } 0..($print->layer_count-1);
+    is scalar(grep defined, @sizes), $print->layer_count, 'one PNG image is exported per layer';
+    ok !unzip($file => \my $png, Name => sprintf('layer%05d.png', $print->layer_count)),
+        'no image is exported past the last layer';
+    ok abs($sizes[0][0] - 500) <= 1 && abs($sizes[0][1] - 100) <= 1, 'image size follows the DPI';
+    is scalar(grep { $_->[0] != $sizes[0][0] || $_->[1] != $sizes[0][1] } @sizes), 0,
+        'all the images have the same size';
+}
+
+{
+    my ($print, $model) = sla_print('bridge', raster_dpi => 254, raster_rotation => 90);
+    my $file = "$dir/bridge_rotated.zip";
+    $print->write_png($file);
+    unzip($file => \my $png, Name => 'layer00000.png');
+    my $size = png_size($png);
+    ok abs($size->[0] - 100) <= 1 && abs($size->[1] - 500) <= 1, 'rotation by 90 degrees swaps the image axes';
+}
+
+{
+    # the span of the bridge model, between 5mm and 8mm, needs support
+    my ($print, $model) = sla_print('bridge', support_material => 1, support_material_spacing => 2);
+    my $pillars = $print->sm_pillars;
+    ok scalar(@$pillars) > 0, 'support pillars are generated under the bridge';
+    
+    my $inside = sub {
+        my ($layer_id, $point) = @_;
+        return scalar grep $_->contains_point($point), @{$print->layer_slices($layer_id)};
+    };
+    is scalar(grep $_->{bottom_layer} > $_->{top_layer}, @$pillars), 0, 'pillars span at least one layer';
+    is scalar(grep { my $p = $_; grep $inside->($_, $p->{point}), $p->{bottom_layer}..$p->{top_layer} } @$pillars), 0,
+        'pillars do not cross the object';
+    is scalar(grep { $_->{top_layer} + 1 >= $print->layer_count || !$inside->($_->{top_layer} + 1, $_->{point}) } @$pillars), 0,
+        'pillars end right under the object';
+}
+
+__END__
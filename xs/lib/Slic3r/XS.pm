@@ -244,6 +244,7 @@ for my $class (qw(
         Slic3r::Geometry::BoundingBox
         Slic3r::Geometry::BoundingBoxf
         Slic3r::Geometry::BoundingBoxf3
+        Slic3r::Geometry::Clipper::Expr
         Slic3r::Layer
         Slic3r::Layer::Region
         Slic3r::Layer::Support
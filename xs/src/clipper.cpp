@@ -47,6 +47,7 @@
 #include <cstdlib>
 #include <ostream>
 #include <functional>
+#include <atomic>
 
 namespace ClipperLib {
 
@@ -145,6 +146,88 @@ inline cInt Abs(cInt val)
   return val < 0 ? -val : val;
 }
 
+//------------------------------------------------------------------------------
+// Arena methods ...
+//------------------------------------------------------------------------------
+
+static size_t const ArenaBlockSize = 64 * 1024;
+static size_t const ArenaAlignment = 16;
+static size_t const ArenaRetainedSize = 16 * ArenaBlockSize;
+
+static std::atomic<unsigned long long> ArenaObjects(0);
+static std::atomic<unsigned long long> ArenaHeapBlocks(0);
+
+Arena::Arena(): m_CurrBlock(0), m_Used(0), m_Objects(0), m_HeapBlocks(0)
+{
+}
+//------------------------------------------------------------------------------
+
+Arena::~Arena()
+{
+  Reset();
+  Trim(0);
+}
+//------------------------------------------------------------------------------
+
+void* Arena::Allocate(size_t size)
+{
+  size = (size + ArenaAlignment - 1) & ~(ArenaAlignment - 1);
+  ++m_Objects;
+  //continue with the next retained block large enough ...
+  while (m_CurrBlock < m_Blocks.size() && m_Used + size > m_Blocks[m_CurrBlock].Size)
+  {
+    ++m_CurrBlock;
+    m_Used = 0;
+  }
+  //or get a new one from the heap ...
+  if (m_CurrBlock == m_Blocks.size())
+  {
+    Block block;
+    block.Size = std::max(size, ArenaBlockSize);
+    block.Data = static_cast<char*>(malloc(block.Size));
+    if (!block.Data) throw std::bad_alloc();
+    m_Blocks.push_back(block);
+    ++m_HeapBlocks;
+    m_Used = 0;
+  }
+  void* result = m_Blocks[m_CurrBlock].Data + m_Used;
+  m_Used += size;
+  return result;
+}
+//------------------------------------------------------------------------------
+
+void Arena::Reset()
+{
+  m_CurrBlock = 0;
+  m_Used = 0;
+  Trim(ArenaRetainedSize);
+  if (m_Objects == 0) return;
+  ArenaObjects += m_Objects;
+  ArenaHeapBlocks += m_HeapBlocks;
+  m_Objects = 0;
+  m_HeapBlocks = 0;
+}
+//------------------------------------------------------------------------------
+
+void Arena::Trim(size_t keep)
+{
+  size_t kept = 0, count = 0;
+  while (count < m_Blocks.size() && kept + m_Blocks[count].Size <= keep)
+    kept += m_Blocks[count++].Size;
+  for (size_t i = count; i < m_Blocks.size(); ++i)
+    free(m_Blocks[i].Data);
+  m_Blocks.resize(count);
+}
+//------------------------------------------------------------------------------
+
+AllocationStats GetAllocationStats()
+{
+  AllocationStats stats;
+  stats.Objects = ArenaObjects;
+  stats.HeapBlocks = ArenaHeapBlocks;
+  return stats;
+}
+
 //------------------------------------------------------------------------------
 // PolyTree methods ...
 //------------------------------------------------------------------------------
@@ -705,14 +788,8 @@ void ReversePolyPtLinks(OutPt *pp)
 
 void DisposeOutPts(OutPt*& pp)
 {
-  if (pp == 0) return;
-    pp->Prev->Next = 0;
-  while( pp )
-  {
-    OutPt *tmpPp = pp;
-    pp = pp->Next;
-    delete tmpPp;
-  }
+  //the points are owned by the arena of the engine ...
+  pp = 0;
 }
 //------------------------------------------------------------------------------
 
@@ -1058,7 +1135,7 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   if ((Closed && highI < 2) || (!Closed && highI < 1)) return false;
 
   //create a new edge array ...
-  TEdge *edges = new TEdge [highI +1];
+  TEdge *edges = static_cast<TEdge*>(m_EdgeArena.Allocate(sizeof(TEdge) * (highI +1)));
 
   bool IsFlat = true;
   //1. Basic (first) edge initialization ...
@@ -1077,7 +1154,6 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   }
   catch(...)
   {
-    delete [] edges;
     throw; //range test fails
   }
   TEdge *eStart = &edges[0];
@@ -1117,10 +1193,7 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   }
 
   if ((!Closed && (E == E->Next)) || (Closed && (E->Prev == E->Next)))
-  {
-    delete [] edges;
     return false;
-  }
 
   if (!Closed)
   { 
@@ -1144,11 +1217,7 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   //to LocalMinima list to avoid endless loops etc ...
   if (IsFlat) 
   {
-    if (Closed) 
-    {
-      delete [] edges;
-      return false;
-    }
+    if (Closed) return false;
     E->Prev->OutIdx = Skip;
     MinimaList::value_type locMin;
     locMin.Y = E->Bot.Y;
@@ -1164,11 +1233,9 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
       E = E->Next;
     }
     m_MinimaList.push_back(locMin);
-    m_edges.push_back(edges);
 	  return true;
   }
 
-  m_edges.push_back(edges);
   bool leftBoundIsForward;
   TEdge* EMin = 0;
 
@@ -1233,12 +1300,7 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
 void ClipperBase::Clear()
 {
   DisposeLocalMinimaList();
-  for (EdgeList::size_type i = 0; i < m_edges.size(); ++i)
-  {
-    TEdge* edges = m_edges[i];
-    delete [] edges;
-  }
-  m_edges.clear();
+  m_EdgeArena.Reset();
   m_UseFullRange = false;
   m_HasOpenPaths = false;
 }
@@ -1349,17 +1411,14 @@ bool ClipperBase::PopScanbeam(cInt &Y)
 //------------------------------------------------------------------------------
 
 void ClipperBase::DisposeAllOutRecs(){
-  for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); ++i)
-    DisposeOutRec(i);
   m_PolyOuts.clear();
+  m_OutArena.Reset();
 }
 //------------------------------------------------------------------------------
 
 void ClipperBase::DisposeOutRec(PolyOutList::size_type index)
 {
-  OutRec *outRec = m_PolyOuts[index];
-  if (outRec->Pts) DisposeOutPts(outRec->Pts);
-  delete outRec;
+  //the record and its points are owned by the arena ...
   m_PolyOuts[index] = 0;
 }
 //------------------------------------------------------------------------------
@@ -1379,7 +1438,7 @@ void ClipperBase::DeleteFromAEL(TEdge *e)
 
 OutRec* ClipperBase::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result = m_OutArena.New<OutRec>();
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -1941,7 +2000,7 @@ void Clipper::CopyAELToSEL()
 
 void Clipper::AddJoin(OutPt *op1, OutPt *op2, const IntPoint OffPt)
 {
-  Join* j = new Join;
+  Join* j = m_OutArena.New<Join>();
   j->OutPt1 = op1;
   j->OutPt2 = op2;
   j->OffPt = OffPt;
@@ -1951,23 +2010,19 @@ void Clipper::AddJoin(OutPt *op1, OutPt *op2, const IntPoint OffPt)
 
 void Clipper::ClearJoins()
 {
-  for (JoinList::size_type i = 0; i < m_Joins.size(); i++)
-    delete m_Joins[i];
   m_Joins.resize(0);
 }
 //------------------------------------------------------------------------------
 
 void Clipper::ClearGhostJoins()
 {
-  for (JoinList::size_type i = 0; i < m_GhostJoins.size(); i++)
-    delete m_GhostJoins[i];
   m_GhostJoins.resize(0);
 }
 //------------------------------------------------------------------------------
 
 void Clipper::AddGhostJoin(OutPt *op, const IntPoint OffPt)
 {
-  Join* j = new Join;
+  Join* j = m_OutArena.New<Join>();
   j->OutPt1 = op;
   j->OutPt2 = 0;
   j->OffPt = OffPt;
@@ -2466,7 +2521,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
   {
     OutRec *outRec = CreateOutRec();
     outRec->IsOpen = (e->WindDelta == 0);
-    OutPt* newOp = new OutPt;
+    OutPt* newOp = m_OutArena.New<OutPt>();
     outRec->Pts = newOp;
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
@@ -2486,7 +2541,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
 	if (ToFront && (pt == op->Pt)) return op;
     else if (!ToFront && (pt == op->Prev->Pt)) return op->Prev;
 
-    OutPt* newOp = new OutPt;
+    OutPt* newOp = m_OutArena.New<OutPt>();
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
     newOp->Next = op;
@@ -2847,8 +2902,6 @@ bool Clipper::ProcessIntersections(const cInt topY)
 
 void Clipper::DisposeIntersectNodes()
 {
-  for (size_t i = 0; i < m_IntersectList.size(); ++i )
-    delete m_IntersectList[i];
   m_IntersectList.clear();
 }
 //------------------------------------------------------------------------------
@@ -2882,7 +2935,7 @@ void Clipper::BuildIntersectList(const cInt topY)
       {
         IntersectPoint(*e, *eNext, Pt);
         if (Pt.Y < topY) Pt = IntPoint(TopX(*e, topY), topY);
-        IntersectNode * newNode = new IntersectNode;
+        IntersectNode * newNode = m_OutArena.New<IntersectNode>();
         newNode->Edge1 = e;
         newNode->Edge2 = eNext;
         newNode->Pt = Pt;
@@ -2912,7 +2965,6 @@ void Clipper::ProcessIntersectList()
       IntersectEdges( iNode->Edge1, iNode->Edge2, iNode->Pt);
       SwapPositionsInAEL( iNode->Edge1 , iNode->Edge2 );
     }
-    delete iNode;
   }
   m_IntersectList.clear();
 }
@@ -3126,7 +3178,6 @@ void Clipper::FixupOutPolyline(OutRec &outrec)
       OutPt *tmpPP = pp->Prev;
       tmpPP->Next = pp->Next;
       pp->Next->Prev = tmpPP;
-      delete pp;
       pp = tmpPP;
     }
   }
@@ -3164,11 +3215,9 @@ void Clipper::FixupOutPolygon(OutRec &outrec)
             (!preserveCol || !Pt2IsBetweenPt1AndPt3(pp->Prev->Pt, pp->Pt, pp->Next->Pt))))
         {
             lastOK = 0;
-            OutPt *tmp = pp;
             pp->Prev->Next = pp->Next;
             pp->Next->Prev = pp->Prev;
             pp = pp->Prev;
-            delete tmp;
         }
         else if (pp == lastOK) break;
         else
@@ -3345,9 +3394,9 @@ void Clipper::InsertEdgeIntoAEL(TEdge *edge, TEdge* startEdge)
 }
 //----------------------------------------------------------------------
 
-OutPt* DupOutPt(OutPt* outPt, bool InsertAfter)
+OutPt* DupOutPt(Arena& arena, OutPt* outPt, bool InsertAfter)
 {
-  OutPt* result = new OutPt;
+  OutPt* result = arena.New<OutPt>();
   result->Pt = outPt->Pt;
   result->Idx = outPt->Idx;
   if (InsertAfter)
@@ -3368,7 +3417,7 @@ OutPt* DupOutPt(OutPt* outPt, bool InsertAfter)
 }
 //------------------------------------------------------------------------------
 
-bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
+bool JoinHorz(Arena& arena, OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
   const IntPoint Pt, bool DiscardLeft)
 {
   Direction Dir1 = (op1->Pt.X > op1b->Pt.X ? dRightToLeft : dLeftToRight);
@@ -3386,12 +3435,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op1->Next->Pt.X >= op1->Pt.X && op1->Next->Pt.Y == Pt.Y)  
         op1 = op1->Next;
     if (DiscardLeft && (op1->Pt.X != Pt.X)) op1 = op1->Next;
-    op1b = DupOutPt(op1, !DiscardLeft);
+    op1b = DupOutPt(arena, op1, !DiscardLeft);
     if (op1b->Pt != Pt) 
     {
       op1 = op1b;
       op1->Pt = Pt;
-      op1b = DupOutPt(op1, !DiscardLeft);
+      op1b = DupOutPt(arena, op1, !DiscardLeft);
     }
   } 
   else
@@ -3400,12 +3449,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op1->Next->Pt.X <= op1->Pt.X && op1->Next->Pt.Y == Pt.Y) 
         op1 = op1->Next;
     if (!DiscardLeft && (op1->Pt.X != Pt.X)) op1 = op1->Next;
-    op1b = DupOutPt(op1, DiscardLeft);
+    op1b = DupOutPt(arena, op1, DiscardLeft);
     if (op1b->Pt != Pt)
     {
       op1 = op1b;
       op1->Pt = Pt;
-      op1b = DupOutPt(op1, DiscardLeft);
+      op1b = DupOutPt(arena, op1, DiscardLeft);
     }
   }
 
@@ -3415,12 +3464,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op2->Next->Pt.X >= op2->Pt.X && op2->Next->Pt.Y == Pt.Y)
         op2 = op2->Next;
     if (DiscardLeft && (op2->Pt.X != Pt.X)) op2 = op2->Next;
-    op2b = DupOutPt(op2, !DiscardLeft);
+    op2b = DupOutPt(arena, op2, !DiscardLeft);
     if (op2b->Pt != Pt)
     {
       op2 = op2b;
       op2->Pt = Pt;
-      op2b = DupOutPt(op2, !DiscardLeft);
+      op2b = DupOutPt(arena, op2, !DiscardLeft);
     };
   } else
   {
@@ -3428,12 +3477,12 @@ bool JoinHorz(OutPt* op1, OutPt* op1b, OutPt* op2, OutPt* op2b,
       op2->Next->Pt.X <= op2->Pt.X && op2->Next->Pt.Y == Pt.Y) 
         op2 = op2->Next;
     if (!DiscardLeft && (op2->Pt.X != Pt.X)) op2 = op2->Next;
-    op2b = DupOutPt(op2, DiscardLeft);
+    op2b = DupOutPt(arena, op2, DiscardLeft);
     if (op2b->Pt != Pt)
     {
       op2 = op2b;
       op2->Pt = Pt;
-      op2b = DupOutPt(op2, DiscardLeft);
+      op2b = DupOutPt(arena, op2, DiscardLeft);
     };
   };
 
@@ -3485,8 +3534,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
     if (reverse1 == reverse2) return false;
     if (reverse1)
     {
-      op1b = DupOutPt(op1, false);
-      op2b = DupOutPt(op2, true);
+      op1b = DupOutPt(m_OutArena, op1, false);
+      op2b = DupOutPt(m_OutArena, op2, true);
       op1->Prev = op2;
       op2->Next = op1;
       op1b->Next = op2b;
@@ -3496,8 +3545,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       return true;
     } else
     {
-      op1b = DupOutPt(op1, true);
-      op2b = DupOutPt(op2, false);
+      op1b = DupOutPt(m_OutArena, op1, true);
+      op2b = DupOutPt(m_OutArena, op2, false);
       op1->Next = op2;
       op2->Prev = op1;
       op1b->Prev = op2b;
@@ -3553,7 +3602,7 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       Pt = op2b->Pt; DiscardLeftSide = (op2b->Pt.X > op2->Pt.X);
     }
     j->OutPt1 = op1; j->OutPt2 = op2;
-    return JoinHorz(op1, op1b, op2, op2b, Pt, DiscardLeftSide);
+    return JoinHorz(m_OutArena, op1, op1b, op2, op2b, Pt, DiscardLeftSide);
   } else
   {
     //nb: For non-horizontal joins ...
@@ -3589,8 +3638,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
 
     if (Reverse1)
     {
-      op1b = DupOutPt(op1, false);
-      op2b = DupOutPt(op2, true);
+      op1b = DupOutPt(m_OutArena, op1, false);
+      op2b = DupOutPt(m_OutArena, op2, true);
       op1->Prev = op2;
       op2->Next = op1;
       op1b->Next = op2b;
@@ -3600,8 +3649,8 @@ bool Clipper::JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2)
       return true;
     } else
     {
-      op1b = DupOutPt(op1, true);
-      op2b = DupOutPt(op2, false);
+      op1b = DupOutPt(m_OutArena, op1, true);
+      op2b = DupOutPt(m_OutArena, op2, false);
       op1->Next = op2;
       op2->Prev = op1;
       op1b->Prev = op2b;
@@ -3794,13 +3843,32 @@ ClipperOffset::ClipperOffset(double miterLimit, double arcTolerance)
 ClipperOffset::~ClipperOffset()
 {
   Clear();
+  for (PolyNodes::size_type i = 0; i < m_freeNodes.size(); ++i)
+    delete m_freeNodes[i];
 }
 //------------------------------------------------------------------------------
 
+static size_t const OffsetRetainedNodes = 1024;
+static size_t const OffsetRetainedPoints = 4096;
+
 void ClipperOffset::Clear()
 {
+  //keep the nodes and the capacity of their contours for the next paths,
+  //up to a bound so that one big offset doesn't hold its memory forever ...
   for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+  {
+    PolyNode* node = m_polyNodes.Childs[i];
+    if (m_freeNodes.size() >= OffsetRetainedNodes ||
+      node->Contour.capacity() > OffsetRetainedPoints)
+    {
+      delete node;
+      continue;
+    }
+    node->Contour.clear();
+    node->Childs.clear();
+    node->Parent = 0;
+    m_freeNodes.push_back(node);
+  }
   m_polyNodes.Childs.clear();
   m_lowest.X = -1;
 }
@@ -3810,7 +3878,14 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode;
+  if (m_freeNodes.empty())
+    newNode = new PolyNode();
+  else
+  {
+    newNode = m_freeNodes.back();
+    m_freeNodes.pop_back();
+  }
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3831,7 +3906,8 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
     }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    newNode->Contour.clear();
+    m_freeNodes.push_back(newNode);
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -3891,7 +3967,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3921,7 +3999,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -58,6 +58,7 @@
 #include <ostream>
 #include <functional>
 #include <queue>
+#include <new>
 
 namespace ClipperLib {
 
@@ -207,6 +208,41 @@ struct OutPt;
 struct OutRec;
 struct Join;
 
+//Arena: bump allocator for the internal structures of the clipping engines.
+//Nothing is freed individually, Reset() releases everything at once and keeps
+//up to ArenaRetainedSize bytes of memory blocks for the next operations of the
+//same engine, the larger blocks of an exceptionally big operation are freed.
+class Arena
+{
+public:
+  Arena();
+  ~Arena();
+  void* Allocate(size_t size);
+  template <class T> T* New() { return new (Allocate(sizeof(T))) T; }
+  void Reset();
+  //Frees the memory blocks past the first ones totalling at most keep bytes,
+  //the arena must have been reset.
+  void Trim(size_t keep);
+private:
+  struct Block { char* Data; size_t Size; };
+  std::vector<Block> m_Blocks;
+  size_t m_CurrBlock;
+  size_t m_Used;
+  unsigned long long m_Objects;
+  unsigned long long m_HeapBlocks;
+  Arena(const Arena&);
+  Arena& operator=(const Arena&);
+};
+
+//Number of structures allocated by the arenas of all the engines, and number of
+//heap allocations they needed. Updated each time an arena is reset or destroyed.
+struct AllocationStats
+{
+  unsigned long long Objects;
+  unsigned long long HeapBlocks;
+};
+AllocationStats GetAllocationStats();
+
 typedef std::vector < OutRec* > PolyOutList;
 typedef std::vector < TEdge* > EdgeList;
 typedef std::vector < Join* > JoinList;
@@ -249,7 +285,8 @@ protected:
   MinimaList           m_MinimaList;
 
   bool              m_UseFullRange;
-  EdgeList          m_edges;
+  Arena             m_EdgeArena;  //edges, released by Clear()
+  Arena             m_OutArena;   //output points, records, joins and intersections, released after each Execute()
   bool              m_PreserveCollinear;
   bool              m_HasOpenPaths;
   PolyOutList       m_PolyOuts;
@@ -373,6 +410,8 @@ private:
   Paths m_destPolys;
   Path m_srcPoly;
   Path m_destPoly;
+  PolyNodes m_freeNodes;  //nodes released by Clear(), reused by AddPath()
+  Clipper m_clipper;      //cleans up the offset polygons, reused by each Execute()
   std::vector<DoublePoint> m_normals;
   double m_delta, m_sinA, m_sin, m_cos;
   double m_miterLim, m_StepsPerRad;
@@ -52,6 +52,116 @@ BridgeDetector::BridgeDetector(const ExPolygon &_expolygon, const ExPolygonColle
     #endif
 }
 
+/// Edge of a polygon not parallel to the x axis, with bot.y < top.y and
+/// the winding contribution of its original direction.
+struct ScanlineEdge
+{
+    Point bot, top;
+    int   winding;
+};
+
+/// Polygon prepared for scanning horizontal lines: its edges and its bounding box.
+struct ScanlinePolygon
+{
+    const Polygon* polygon;
+    BoundingBox bb;
+    std::vector<ScanlineEdge> edges;
+};
+
+static std::vector<ScanlinePolygon>
+scanline_polygons(const Polygons &polygons)
+{
+    std::vector<ScanlinePolygon> out(polygons.size());
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        const Points &pts = polygons[i].points;
+        ScanlinePolygon &sp = out[i];
+        sp.polygon = &polygons[i];
+        sp.bb = BoundingBox(pts);
+        for (size_t j = 0; j < pts.size(); ++j) {
+            const Point &a = pts[j];
+            const Point &b = pts[(j+1) % pts.size()];
+            if (a.y == b.y) continue;
+            ScanlineEdge e;
+            e.bot     = a.y < b.y ? a : b;
+            e.top     = a.y < b.y ? b : a;
+            e.winding = a.y < b.y ? 1 : -1;
+            sp.edges.push_back(e);
+        }
+    }
+    return out;
+}
+
+/// Clips the horizontal line at y between min_x and max_x with the polygons
+/// using the non-zero fill rule, as intersection_ln() does. The crossings are rounded
+/// the way Clipper rounds them, so that the endpoints are the same.
+static void
+clip_scanline(const std::vector<ScanlinePolygon> &polygons, coord_t y, coord_t min_x, coord_t max_x, Lines* out)
+{
+    std::vector<std::pair<coord_t,int> > crossings;
+    for (const ScanlinePolygon &sp : polygons) {
+        if (y < sp.bb.min.y || y >= sp.bb.max.y) continue;
+        for (const ScanlineEdge &e : sp.edges) {
+            if (y < e.bot.y || y >= e.top.y) continue;
+            // Clipper measures from the endpoint with the larger y
+            const double dx = double(e.bot.x - e.top.x) / double(e.bot.y - e.top.y);
+            const double x  = dx * double(y - e.top.y);
+            crossings.push_back(std::make_pair(e.top.x + coord_t(x < 0 ? x - 0.5 : x + 0.5), e.winding));
+        }
+    }
+    std::sort(crossings.begin(), crossings.end());
+    
+    int winding = 0;
+    for (size_t i = 0; i + 1 < crossings.size(); ++i) {
+        winding += crossings[i].second;
+        if (winding == 0) continue;
+        const coord_t a = std::max(crossings[i].first, min_x);
+        const coord_t b = std::min(crossings[i+1].first, max_x);
+        if (a < b)
+            out->push_back(Line(Point(a, y), Point(b, y)));
+    }
+}
+
+/// Signed area of the polygon clipped to the axis aligned rectangle, computed by
+/// Sutherland-Hodgman clipping: the output may have degenerate bridges along
+/// the rectangle sides, but they do not contribute to the area.
+static double
+clipped_area(const Polygon &polygon, double min_x, double min_y, double max_x, double max_y)
+{
+    std::vector<Pointf> pts, clipped;
+    pts.reserve(polygon.points.size());
+    for (const Point &p : polygon.points)
+        pts.push_back(Pointf(p.x, p.y));
+    
+    for (int side = 0; side < 4 && !pts.empty(); ++side) {
+        // side 0: x >= min_x, 1: x <= max_x, 2: y >= min_y, 3: y <= max_y
+        const bool   along_x = side < 2;
+        const double limit   = side == 0 ? min_x : side == 1 ? max_x : side == 2 ? min_y : max_y;
+        const double sign    = (side % 2 == 0) ? 1. : -1.;
+        clipped.clear();
+        for (size_t i = 0; i < pts.size(); ++i) {
+            const Pointf &a = pts[i];
+            const Pointf &b = pts[(i+1) % pts.size()];
+            const double da = sign * ((along_x ? a.x : a.y) - limit);
+            const double db = sign * ((along_x ? b.x : b.y) - limit);
+            if (da >= 0)
+                clipped.push_back(a);
+            if ((da >= 0) != (db >= 0)) {
+                const double t = da / (da - db);
+                clipped.push_back(Pointf(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)));
+            }
+        }
+        std::swap(pts, clipped);
+    }
+    
+    double area = 0;
+    for (size_t i = 0; i < pts.size(); ++i) {
+        const Pointf &a = pts[i];
+        const Pointf &b = pts[(i+1) % pts.size()];
+        area += a.x * b.y - b.x * a.y;
+    }
+    return area / 2.;
+}
+
 bool
 BridgeDetector::detect_angle()
 {
@@ -107,6 +217,7 @@ BridgeDetector::detect_angle()
     }
     
     const coord_t line_increment = this->extrusion_width;
+    const coord_t half_width     = this->extrusion_width/2;
     bool have_coverage = false;
     for (BridgeDirection &candidate : candidates) {
         Polygons my_clip_area = clip_area;
@@ -123,11 +234,11 @@ BridgeDetector::detect_angle()
         for (const ExPolygon &e : my_anchors)
             bb.merge(e.bounding_box());
         
-        Lines lines;
+        // clip the lines with a scanline over the polygon edges instead of a Clipper run
+        const std::vector<ScanlinePolygon> clip_edges = scanline_polygons(my_clip_area);
+        Lines clipped_lines;
         for (coord_t y = bb.min.y; y <= bb.max.y; y += line_increment)
-            lines.push_back(Line(Point(bb.min.x, y), Point(bb.max.x, y)));
-        
-        const Lines clipped_lines = intersection_ln(lines, my_clip_area);
+            clip_scanline(clip_edges, y, bb.min.x, bb.max.x, &clipped_lines);
         
         for (const Line &line : clipped_lines) {
             // skip any line not having both endpoints within anchors
@@ -139,12 +250,15 @@ BridgeDetector::detect_angle()
             // Calculate coverage as actual covered area, because length of centerlines
             // is not accurate enough when such lines are slightly skewed and not parallel
             // to the sides; calculating area will compute them as triangles.
-            // TODO: use a faster algorithm for computing covered area by using a sweep line
-            // instead of intersecting many lines.
-            candidate.coverage += Slic3r::Geometry::area(intersection(
-                my_clip_area,
-                offset((Polyline)line, +this->extrusion_width/2)
-            ));
+            // The area covered by the line is the clip area within the rectangle
+            // of its butt-ended offset, computed analytically.
+            const double min_x = std::min(line.a.x, line.b.x);
+            const double max_x = std::max(line.a.x, line.b.x);
+            const double min_y = double(line.a.y) - half_width;
+            const double max_y = double(line.a.y) + half_width;
+            for (const ScanlinePolygon &sp : clip_edges)
+                if (sp.bb.min.x < max_x && sp.bb.max.x > min_x && sp.bb.min.y < max_y && sp.bb.max.y > min_y)
+                    candidate.coverage += clipped_area(*sp.polygon, min_x, min_y, max_x, max_y);
         }
         if (candidate.coverage > 0) have_coverage = true;
         
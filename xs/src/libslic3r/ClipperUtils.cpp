@@ -1,8 +1,40 @@
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
+#include <boost/thread/tss.hpp>
 
 namespace Slic3r {
 
+// Clipping and offsetting engines reused by all the operations of a thread,
+// so that their arenas and buffers keep their memory from one operation to the next.
+// An engine must not be held across a call to another operation.
+static boost::thread_specific_ptr<ClipperLib::Clipper> thread_clipper_ptr;
+static boost::thread_specific_ptr<ClipperLib::ClipperOffset> thread_clipper_offset_ptr;
+
+static ClipperLib::Clipper&
+thread_clipper()
+{
+    if (thread_clipper_ptr.get() == NULL)
+        thread_clipper_ptr.reset(new ClipperLib::Clipper());
+    ClipperLib::Clipper &clipper = *thread_clipper_ptr;
+    clipper.Clear();
+    clipper.PreserveCollinear(false);
+    clipper.StrictlySimple(false);
+    clipper.ReverseSolution(false);
+    return clipper;
+}
+
+static ClipperLib::ClipperOffset&
+thread_clipper_offset()
+{
+    if (thread_clipper_offset_ptr.get() == NULL)
+        thread_clipper_offset_ptr.reset(new ClipperLib::ClipperOffset());
+    ClipperLib::ClipperOffset &co = *thread_clipper_offset_ptr;
+    co.Clear();
+    co.MiterLimit   = 2.0;
+    co.ArcTolerance = 0.25;
+    return co;
+}
+
 //-----------------------------------------------------------
 // legacy code from Clipper documentation
 void AddOuterPolyNodeToExPolygons(ClipperLib::PolyNode& polynode, ExPolygons* expolygons)
@@ -35,6 +67,7 @@ T
 ClipperPath_to_Slic3rMultiPoint(const ClipperLib::Path &input)
 {
     T retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.push_back(Point( (*pit).X, (*pit).Y ));
     return retval;
@@ -46,17 +79,18 @@ T
 ClipperPaths_to_Slic3rMultiPoints(const ClipperLib::Paths &input)
 {
     T retval;
+    retval.reserve(input.size());
     for (ClipperLib::Paths::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.push_back(ClipperPath_to_Slic3rMultiPoint<typename T::value_type>(*it));
     return retval;
 }
+template Polygons ClipperPaths_to_Slic3rMultiPoints<Polygons>(const ClipperLib::Paths &input);
 
 ExPolygons
 ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input)
 {
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLib::Clipper &clipper = thread_clipper();
     
     // perform union
     clipper.AddPaths(input, ClipperLib::ptSubject, true);
@@ -71,6 +105,7 @@ ClipperLib::Path
 Slic3rMultiPoint_to_ClipperPath(const MultiPoint &input)
 {
     ClipperLib::Path retval;
+    retval.reserve(input.points.size());
     for (Points::const_iterator pit = input.points.begin(); pit != input.points.end(); ++pit)
         retval.push_back(ClipperLib::IntPoint( (*pit).x, (*pit).y ));
     return retval;
@@ -81,10 +116,12 @@ ClipperLib::Paths
 Slic3rMultiPoints_to_ClipperPaths(const T &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (typename T::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.push_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
 }
+template ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths<Polygons>(const Polygons &input);
 
 void
 scaleClipperPolygons(ClipperLib::Paths &polygons, const double scale)
@@ -98,55 +135,42 @@ scaleClipperPolygons(ClipperLib::Paths &polygons, const double scale)
 }
 
 ClipperLib::Paths
-_offset(const Polygons &polygons, const float delta,
+_offset(ClipperLib::Paths input, ClipperLib::EndType endType, const float delta,
     double scale, ClipperLib::JoinType joinType, double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
-    
     // scale input
-    scaleClipperPolygons(input, scale);
+    if (scale != 1) scaleClipperPolygons(input, scale);
     
     // perform offset
-    ClipperLib::ClipperOffset co;
+    ClipperLib::ClipperOffset &co = thread_clipper_offset();
     if (joinType == jtRound) {
         co.ArcTolerance = miterLimit;
     } else {
         co.MiterLimit = miterLimit;
     }
-    co.AddPaths(input, joinType, ClipperLib::etClosedPolygon);
+    co.AddPaths(input, joinType, endType);
     ClipperLib::Paths retval;
     co.Execute(retval, (delta*scale));
     
     // unscale output
-    scaleClipperPolygons(retval, 1/scale);
+    if (scale != 1) scaleClipperPolygons(retval, 1/scale);
     return retval;
 }
 
+ClipperLib::Paths
+_offset(const Polygons &polygons, const float delta,
+    double scale, ClipperLib::JoinType joinType, double miterLimit)
+{
+    return _offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon,
+        delta, scale, joinType, miterLimit);
+}
+
 ClipperLib::Paths
 _offset(const Polylines &polylines, const float delta,
     double scale, ClipperLib::JoinType joinType, double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polylines);
-    
-    // scale input
-    scaleClipperPolygons(input, scale);
-    
-    // perform offset
-    ClipperLib::ClipperOffset co;
-    if (joinType == jtRound) {
-        co.ArcTolerance = miterLimit;
-    } else {
-        co.MiterLimit = miterLimit;
-    }
-    co.AddPaths(input, joinType, ClipperLib::etOpenButt);
-    ClipperLib::Paths retval;
-    co.Execute(retval, (delta*scale));
-    
-    // unscale output
-    scaleClipperPolygons(retval, 1/scale);
-    return retval;
+    return _offset(Slic3rMultiPoints_to_ClipperPaths(polylines), ClipperLib::etOpenButt,
+        delta, scale, joinType, miterLimit);
 }
 
 Polygons
@@ -208,17 +232,14 @@ offset_ex(const ExPolygons &expolygons, const float delta,
 }
 
 ClipperLib::Paths
-_offset2(const Polygons &polygons, const float delta1, const float delta2,
+_offset2(ClipperLib::Paths input, const float delta1, const float delta2,
     const double scale, const ClipperLib::JoinType joinType, const double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
-    
     // scale input
-    scaleClipperPolygons(input, scale);
+    if (scale != 1) scaleClipperPolygons(input, scale);
     
     // prepare ClipperOffset object
-    ClipperLib::ClipperOffset co;
+    ClipperLib::ClipperOffset &co = thread_clipper_offset();
     if (joinType == jtRound) {
         co.ArcTolerance = miterLimit;
     } else {
@@ -237,10 +258,17 @@ _offset2(const Polygons &polygons, const float delta1, const float delta2,
     co.Execute(retval, (delta2*scale));
     
     // unscale output
-    scaleClipperPolygons(retval, 1/scale);
+    if (scale != 1) scaleClipperPolygons(retval, 1/scale);
     return retval;
 }
 
+ClipperLib::Paths
+_offset2(const Polygons &polygons, const float delta1, const float delta2,
+    const double scale, const ClipperLib::JoinType joinType, const double miterLimit)
+{
+    return _offset2(Slic3rMultiPoints_to_ClipperPaths(polygons), delta1, delta2, scale, joinType, miterLimit);
+}
+
 Polygons
 offset2(const Polygons &polygons, const float delta1, const float delta2,
     const double scale, const ClipperLib::JoinType joinType, const double miterLimit)
@@ -265,29 +293,24 @@ offset2_ex(const Polygons &polygons, const float delta1, const float delta2,
 
 template <class T>
 T
-_clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject, 
-    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+_clipper_do(const ClipperLib::ClipType clipType, const ClipperLib::Paths &subject, 
+    const ClipperLib::Paths &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
+    // perform safety offset on a copy of the input
+    ClipperLib::Paths grown;
     if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
+        grown = (clipType == ClipperLib::ctUnion) ? subject : clip;
+        safety_offset(&grown);
     }
+    const bool grown_subject = safety_offset_ && clipType == ClipperLib::ctUnion;
+    const bool grown_clip    = safety_offset_ && clipType != ClipperLib::ctUnion;
     
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLib::Clipper &clipper = thread_clipper();
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    clipper.AddPaths(grown_subject ? grown : subject, ClipperLib::ptSubject, true);
+    clipper.AddPaths(grown_clip    ? grown : clip,    ClipperLib::ptClip,    true);
     
     // perform operation
     T retval;
@@ -295,38 +318,31 @@ _clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject,
     return retval;
 }
 
+template <class T>
+T
+_clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject, 
+    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+{
+    return _clipper_do<T>(clipType, Slic3rMultiPoints_to_ClipperPaths(subject),
+        Slic3rMultiPoints_to_ClipperPaths(clip), fillType, safety_offset_);
+}
+
 // The Clipper library has difficulties processing overlapping polygons.
 // Namely, the function Clipper::JoinCommonEdges() has potentially a terrible time complexity if the output
 // of the operation is of the PolyTree type.
 // This function implements a following workaround:
 // 1) Peform the Clipper operation with the output to Paths. This method handles overlaps in a reasonable time.
 // 2) Run Clipper Union once again to extract the PolyTree from the result of 1).
-inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const Polygons &subject, 
-    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const ClipperLib::Paths &subject, 
+    const ClipperLib::Paths &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
-    }
-    
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
-    // Perform the operation with the output to input_subject.
+    // Perform the operation with the output to Paths.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overlapping edges.
-    clipper.Execute(clipType, input_subject, fillType, fillType);
+    ClipperLib::Paths output = _clipper_do<ClipperLib::Paths>(clipType, subject, clip, fillType, safety_offset_);
     // Perform an additional Union operation to generate the PolyTree ordering.
-    clipper.Clear();
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    ClipperLib::Clipper &clipper = thread_clipper();
+    clipper.AddPaths(output, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree retval;
     clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
@@ -345,8 +361,7 @@ _clipper_do(const ClipperLib::ClipType clipType, const Polylines &subject,
     if (safety_offset_) safety_offset(&input_clip);
     
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLib::Clipper &clipper = thread_clipper();
     
     // add polygons
     clipper.AddPaths(input_subject, ClipperLib::ptSubject, false);
@@ -369,9 +384,16 @@ _clipper(ClipperLib::ClipType clipType, const Polygons &subject,
     return ClipperPaths_to_Slic3rMultiPoints<Polygons>(output);
 }
 
+ClipperLib::Paths
+_clipper(ClipperLib::ClipType clipType, const ClipperLib::Paths &subject, 
+    const ClipperLib::Paths &clip, bool safety_offset_)
+{
+    return _clipper_do<ClipperLib::Paths>(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_);
+}
+
 ExPolygons
-_clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject, 
-    const Polygons &clip, bool safety_offset_)
+_clipper_ex(ClipperLib::ClipType clipType, const ClipperLib::Paths &subject, 
+    const ClipperLib::Paths &clip, bool safety_offset_)
 {
     // perform operation
     ClipperLib::PolyTree polytree = _clipper_do_polytree2(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_);
@@ -380,6 +402,14 @@ _clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject,
     return PolyTreeToExPolygons(polytree);
 }
 
+ExPolygons
+_clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject, 
+    const Polygons &clip, bool safety_offset_)
+{
+    return _clipper_ex(clipType, Slic3rMultiPoints_to_ClipperPaths(subject),
+        Slic3rMultiPoints_to_ClipperPaths(clip), safety_offset_);
+}
+
 Polylines
 _clipper_pl(ClipperLib::ClipType clipType, const Polylines &subject, 
     const Polygons &clip, bool safety_offset_)
@@ -516,7 +546,7 @@ simplify_polygons(const Polygons &subject, bool preserve_collinear)
     
     ClipperLib::Paths output;
     if (preserve_collinear) {
-        ClipperLib::Clipper c;
+        ClipperLib::Clipper &c = thread_clipper();
         c.PreserveCollinear(true);
         c.StrictlySimple(true);
         c.AddPaths(input_subject, ClipperLib::ptSubject, true);
@@ -541,7 +571,7 @@ simplify_polygons_ex(const Polygons &subject, bool preserve_collinear)
     
     ClipperLib::PolyTree polytree;
     
-    ClipperLib::Clipper c;
+    ClipperLib::Clipper &c = thread_clipper();
     c.PreserveCollinear(true);
     c.StrictlySimple(true);
     c.AddPaths(input_subject, ClipperLib::ptSubject, true);
@@ -557,7 +587,7 @@ void safety_offset(ClipperLib::Paths* paths)
     scaleClipperPolygons(*paths, CLIPPER_OFFSET_SCALE);
     
     // perform offset (delta = scale 1e-05)
-    ClipperLib::ClipperOffset co;
+    ClipperLib::ClipperOffset &co = thread_clipper_offset();
     co.MiterLimit = 2;
     co.AddPaths(*paths, ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
     co.Execute(*paths, 10.0 * CLIPPER_OFFSET_SCALE);
@@ -566,4 +596,208 @@ void safety_offset(ClipperLib::Paths* paths)
     scaleClipperPolygons(*paths, 1.0/CLIPPER_OFFSET_SCALE);
 }
 
+struct ClipperExpr::Node
+{
+    enum Type { ntPaths, ntBoolean, ntOffset };
+    Type type;
+    
+    // ntPaths: the operand converted to Clipper paths, and whether they are oriented
+    ClipperLib::Paths paths;
+    bool oriented;
+    
+    // ntBoolean: the first operand is the subject and the other ones are the clip,
+    // all the operands of a union are subjects. mergeable is set if the operands
+    // combined in this run are all oriented, so that more of them may be added.
+    // ntOffset: the only operand is offset by delta.
+    std::vector<ClipperExpr> operands;
+    ClipperLib::ClipType clip_type;
+    bool safety_offset;
+    bool mergeable;
+    float delta;
+    ClipperLib::JoinType join_type;
+    double miter_limit;
+    
+    Node(Type type)
+        : type(type), oriented(false), clip_type(ClipperLib::ctUnion), safety_offset(false),
+          mergeable(false), delta(0), join_type(ClipperLib::jtMiter), miter_limit(3)
+        {}
+};
+
+ClipperExpr::ClipperExpr()
+{}
+
+ClipperExpr::ClipperExpr(const ClipperLib::Paths &paths)
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntPaths);
+    node->paths = paths;
+    this->node = node;
+}
+
+ClipperExpr::ClipperExpr(const Polygons &polygons)
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntPaths);
+    node->paths = Slic3rMultiPoints_to_ClipperPaths(polygons);
+    this->node = node;
+}
+
+static void
+append_ExPolygon_to_ClipperPaths(const ExPolygon &expolygon, ClipperLib::Paths* paths)
+{
+    paths->push_back(Slic3rMultiPoint_to_ClipperPath(expolygon.contour));
+    for (const Polygon &hole : expolygon.holes)
+        paths->push_back(Slic3rMultiPoint_to_ClipperPath(hole));
+}
+
+ClipperExpr::ClipperExpr(const ExPolygon &expolygon)
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntPaths);
+    node->oriented = true;
+    append_ExPolygon_to_ClipperPaths(expolygon, &node->paths);
+    this->node = node;
+}
+
+ClipperExpr::ClipperExpr(const ExPolygons &expolygons)
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntPaths);
+    node->oriented = true;
+    for (const ExPolygon &expolygon : expolygons)
+        append_ExPolygon_to_ClipperPaths(expolygon, &node->paths);
+    this->node = node;
+}
+
+ClipperExpr::ClipperExpr(const Surfaces &surfaces)
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntPaths);
+    node->oriented = true;
+    for (const Surface &surface : surfaces)
+        append_ExPolygon_to_ClipperPaths(surface.expolygon, &node->paths);
+    this->node = node;
+}
+
+ClipperExpr
+ClipperExpr::boolean(ClipperLib::ClipType clipType, const ClipperExpr &clip, bool safety_offset_) const
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntBoolean);
+    node->clip_type     = clipType;
+    node->safety_offset = safety_offset_;
+    
+    // merge with the previous difference or union, an intersection needs its own run;
+    // overlapping operands of opposite orientation would cancel out in a merged run
+    const bool merge = clipType != ClipperLib::ctIntersection && this->node && this->node->type == Node::ntBoolean
+        && this->node->clip_type == clipType && this->node->safety_offset == safety_offset_
+        && this->node->mergeable && clip.oriented();
+    if (merge) {
+        node->operands = this->node->operands;
+    } else {
+        node->operands.push_back(*this);
+    }
+    node->operands.push_back(clip);
+    node->mergeable = clip.oriented() && (merge || clipType != ClipperLib::ctUnion || this->oriented());
+    return ClipperExpr(node);
+}
+
+/// Clipper results are oriented, plain operands only if they were built from ExPolygons.
+bool
+ClipperExpr::oriented() const
+{
+    return !this->node || this->node->type != Node::ntPaths || this->node->oriented;
+}
+
+ClipperExpr
+ClipperExpr::diff(const ClipperExpr &clip, bool safety_offset_) const
+{
+    return this->boolean(ClipperLib::ctDifference, clip, safety_offset_);
+}
+
+ClipperExpr
+ClipperExpr::intersection(const ClipperExpr &clip, bool safety_offset_) const
+{
+    return this->boolean(ClipperLib::ctIntersection, clip, safety_offset_);
+}
+
+ClipperExpr
+ClipperExpr::union_(const ClipperExpr &other) const
+{
+    return this->boolean(ClipperLib::ctUnion, other, false);
+}
+
+ClipperExpr
+ClipperExpr::offset(const float delta, ClipperLib::JoinType joinType, double miterLimit) const
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntOffset);
+    node->operands.push_back(*this);
+    node->delta       = delta;
+    node->join_type   = joinType;
+    node->miter_limit = miterLimit;
+    return ClipperExpr(node);
+}
+
+ClipperExpr
+ClipperExpr::offset2(const float delta1, const float delta2, ClipperLib::JoinType joinType, double miterLimit) const
+{
+    return this->offset(delta1, joinType, miterLimit).offset(delta2, joinType, miterLimit);
+}
+
+/// Evaluates the operands of a boolean operation into the subject and clip paths.
+void
+ClipperExpr::operands(ClipperLib::Paths* subject, ClipperLib::Paths* clip) const
+{
+    const Node &node = *this->node;
+    for (size_t i = 0; i < node.operands.size(); ++i) {
+        ClipperLib::Paths* out = (i == 0 || node.clip_type == ClipperLib::ctUnion) ? subject : clip;
+        ClipperLib::Paths paths = node.operands[i].paths();
+        if (out->empty()) {
+            std::swap(*out, paths);
+        } else {
+            out->insert(out->end(), paths.begin(), paths.end());
+        }
+    }
+}
+
+ClipperLib::Paths
+ClipperExpr::paths() const
+{
+    if (!this->node) return ClipperLib::Paths();
+    const Node &node = *this->node;
+    
+    if (node.type == Node::ntPaths)
+        return node.paths;
+    
+    if (node.type == Node::ntOffset)
+        return _offset(node.operands.front().paths(), ClipperLib::etClosedPolygon,
+            node.delta, 1, node.join_type, node.miter_limit);
+    
+    ClipperLib::Paths subject, clip;
+    this->operands(&subject, &clip);
+    return _clipper_do<ClipperLib::Paths>(node.clip_type, subject, clip, ClipperLib::pftNonZero, node.safety_offset);
+}
+
+Polygons
+ClipperExpr::polygons() const
+{
+    return ClipperPaths_to_Slic3rMultiPoints<Polygons>(this->paths());
+}
+
+ExPolygons
+ClipperExpr::expolygons() const
+{
+    if (!this->node || this->node->type != Node::ntBoolean)
+        return ClipperPaths_to_Slic3rExPolygons(this->paths());
+    
+    ClipperLib::Paths subject, clip;
+    this->operands(&subject, &clip);
+    ClipperLib::PolyTree polytree = _clipper_do_polytree2(this->node->clip_type, subject, clip,
+        ClipperLib::pftNonZero, this->node->safety_offset);
+    return PolyTreeToExPolygons(polytree);
+}
+
+ClipperExpr
+ClipperExpr::evaluate() const
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>(Node::ntPaths);
+    node->paths    = this->paths();
+    node->oriented = this->oriented();
+    return ClipperExpr(node);
+}
+
 }
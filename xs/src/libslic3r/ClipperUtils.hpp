@@ -6,6 +6,7 @@
 #include "ExPolygon.hpp"
 #include "Polygon.hpp"
 #include "Surface.hpp"
+#include <memory>
 
 // import these wherever we're included
 using ClipperLib::jtMiter;
@@ -75,6 +76,21 @@ Slic3r::ExPolygons offset2_ex(const Slic3r::Polygons &polygons, const float delt
     const float delta2, double scale = CLIPPER_OFFSET_SCALE, ClipperLib::JoinType joinType = ClipperLib::jtMiter, 
     double miterLimit = 3);
 
+// Clipper-native variants of offset, offset2 and the boolean operations, working on paths
+// in the coordinates of the Slic3r polygons. The result of an operation can be passed
+// to the next one without converting it to Slic3r polygons. With scale = 1, the offsets
+// work directly in Slic3r units instead of scaling their input and output.
+ClipperLib::Paths _offset(ClipperLib::Paths input, ClipperLib::EndType endType, const float delta,
+    double scale = CLIPPER_OFFSET_SCALE, ClipperLib::JoinType joinType = ClipperLib::jtMiter, 
+    double miterLimit = 3);
+ClipperLib::Paths _offset2(ClipperLib::Paths input, const float delta1,
+    const float delta2, double scale = CLIPPER_OFFSET_SCALE, ClipperLib::JoinType joinType = ClipperLib::jtMiter, 
+    double miterLimit = 3);
+ClipperLib::Paths _clipper(ClipperLib::ClipType clipType,
+    const ClipperLib::Paths &subject, const ClipperLib::Paths &clip, bool safety_offset_ = false);
+Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
+    const ClipperLib::Paths &subject, const ClipperLib::Paths &clip, bool safety_offset_ = false);
+
 template <class T>
 T _clipper_do(ClipperLib::ClipType clipType, const Slic3r::Polygons &subject, 
     const Slic3r::Polygons &clip, const ClipperLib::PolyFillType fillType, bool safety_offset_ = false);
@@ -215,6 +231,54 @@ ClipperLib::PolyTree union_pt(const Slic3r::Polygons &subject, bool safety_offse
 Slic3r::Polygons union_pt_chained(const Slic3r::Polygons &subject, bool safety_offset_ = false);
 void traverse_pt(ClipperLib::PolyNodes &nodes, Slic3r::Polygons* retval);
 
+// Lazily evaluated chain of boolean operations and offsets, for example
+//     ClipperExpr(a).diff(b, true).offset2(-d, +d).expolygons()
+// The operands are converted to Clipper paths once when they are wrapped, the whole chain
+// is then executed in Clipper space when a result is requested, and only the final result
+// is converted back. Offsets inside a chain work directly in Slic3r units (1 unit = 1nm)
+// instead of scaling and truncating their input and output by CLIPPER_OFFSET_SCALE;
+// for jtRound, miterLimit is the arc tolerance in Slic3r units.
+// Consecutive differences (and unions) are merged into a single Clipper run: the clip
+// operands of (a - b) - c are added together, as the non-zero fill rule unites them anyway.
+// This only holds for oriented operands (contours CCW, holes CW), whose winding numbers
+// are never negative: ExPolygons, Surfaces and evaluated results. Operands built from
+// Polygons or Paths may be oriented either way and get a run of their own.
+// Expressions are immutable and share their operands, so they are cheap to copy, but
+// every request evaluates the whole chain again.
+class ClipperExpr
+{
+    public:
+    ClipperExpr();
+    ClipperExpr(const ClipperLib::Paths &paths);
+    ClipperExpr(const Slic3r::Polygons &polygons);
+    ClipperExpr(const Slic3r::ExPolygon &expolygon);
+    ClipperExpr(const Slic3r::ExPolygons &expolygons);
+    ClipperExpr(const Slic3r::Surfaces &surfaces);
+
+    ClipperExpr diff(const ClipperExpr &clip, bool safety_offset_ = false) const;
+    ClipperExpr intersection(const ClipperExpr &clip, bool safety_offset_ = false) const;
+    ClipperExpr union_(const ClipperExpr &other) const;
+    ClipperExpr offset(const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter,
+        double miterLimit = 3) const;
+    ClipperExpr offset2(const float delta1, const float delta2,
+        ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3) const;
+
+    ClipperLib::Paths paths() const;
+    Slic3r::Polygons polygons() const;
+    Slic3r::ExPolygons expolygons() const;
+    // Evaluates the chain once, for a result used by several other chains.
+    ClipperExpr evaluate() const;
+
+    private:
+    struct Node;
+    std::shared_ptr<const Node> node;
+
+    ClipperExpr(std::shared_ptr<const Node> node) : node(node) {}
+    ClipperExpr boolean(ClipperLib::ClipType clipType, const ClipperExpr &clip, bool safety_offset_) const;
+    bool oriented() const;
+    void operands(ClipperLib::Paths* subject, ClipperLib::Paths* clip) const;
+};
+
 /* OTHER */
 Slic3r::Polygons simplify_polygons(const Slic3r::Polygons &subject, bool preserve_collinear = false);
 Slic3r::ExPolygons simplify_polygons_ex(const Slic3r::Polygons &subject, bool preserve_collinear = false);
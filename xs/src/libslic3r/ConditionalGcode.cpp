@@ -1,6 +1,9 @@
+#include <map>
 #include <string>
 
 #include <sstream>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
 #include <exprtk/exprtk.hpp>
 #include "ConditionalGcode.hpp"
 namespace Slic3r {
@@ -46,16 +49,54 @@ std::string apply_math(const std::string& input) {
 
 
 
+/// Maximum number of evaluated expressions kept by ExpressionEvaluator.
+#define EXPRESSION_CACHE_SIZE 1024
+
+/// exprtk parser and symbol table shared by all evaluations.
+/// Setting up the parser is much more expensive than compiling a short expression,
+/// and as PlaceholderParser has expanded all variables, the expressions are constant,
+/// so the results of the recently evaluated expressions are kept as well.
+class ExpressionEvaluator {
+    public:
+    ExpressionEvaluator() {
+        this->symbol_table.add_constants();
+        this->expression.register_symbol_table(this->symbol_table);
+    };
+    
+    bool compute(const std::string& expression_string, double* result) {
+        boost::lock_guard<boost::mutex> l(this->mutex);
+        std::map<std::string, std::pair<bool,double> >::const_iterator it = this->results.find(expression_string);
+        if (it != this->results.end()) {
+            *result = it->second.second;
+            return it->second.first;
+        }
+        
+        const bool valid = this->parser.compile(expression_string, this->expression);
+        *result = valid ? this->expression.value() : double(0);
+        if (this->results.size() >= EXPRESSION_CACHE_SIZE) this->results.clear();
+        this->results[expression_string] = std::make_pair(valid, *result);
+        return valid;
+    };
+    
+    private:
+    boost::mutex mutex;
+    exprtk::symbol_table<double> symbol_table;
+    exprtk::expression<double> expression;
+    exprtk::parser<double> parser;
+    std::map<std::string, std::pair<bool,double> > results;
+};
+
 /// Evaluate expressions with exprtk
 /// Everything must resolve to a number.
 std::string evaluate(const std::string& expression_string) {
+    static ExpressionEvaluator evaluator;
     std::stringstream result;
 
     #if SLIC3R_DEBUG
     std::cerr << __FILE__ << ":" << __LINE__ << " "<< "Evaluating expression: " << expression_string << std::endl;
     #endif
     double num_result = double(0);
-    if ( exprtk::compute(expression_string, num_result)) { 
+    if (evaluator.compute(expression_string, &num_result)) { 
         result << num_result;
     } else {
         #if SLIC3R_DEBUG
@@ -176,18 +176,6 @@ bool unescape_strings_cstyle(const std::string &str, std::vector<std::string> &o
     }
 }
 
-bool
-operator== (const ConfigOption &a, const ConfigOption &b)
-{
-    return a.serialize().compare(b.serialize()) == 0;
-}
-
-bool
-operator!= (const ConfigOption &a, const ConfigOption &b)
-{
-    return !(a == b);
-}
-
 ConfigOptionDef::ConfigOptionDef(const ConfigOptionDef &other)
     : type(other.type), default_value(NULL),
       gui_type(other.gui_type), gui_flags(other.gui_flags), label(other.label), 
@@ -213,6 +201,7 @@ ConfigDef::add(const t_config_option_key &opt_key, ConfigOptionType type)
 {
     ConfigOptionDef* opt = &this->options[opt_key];
     opt->type = type;
+    this->assign_id(opt_key);
     return opt;
 }
 
@@ -220,26 +209,38 @@ ConfigOptionDef*
 ConfigDef::add(const t_config_option_key &opt_key, const ConfigOptionDef &def)
 {
     this->options.insert(std::make_pair(opt_key, def));
+    this->assign_id(opt_key);
     return &this->options[opt_key];
 }
 
 bool
 ConfigDef::has(const t_config_option_key &opt_key) const
 {
-    return this->options.count(opt_key) > 0;
+    return this->ids.count(opt_key) > 0;
 }
 
 const ConfigOptionDef*
 ConfigDef::get(const t_config_option_key &opt_key) const
 {
-    if (this->options.count(opt_key) == 0) return NULL;
-    return &const_cast<ConfigDef*>(this)->options[opt_key];
+    t_optiondef_map::const_iterator it = this->options.find(opt_key);
+    if (it == this->options.end()) return NULL;
+    return &it->second;
 }
 
 void
 ConfigDef::merge(const ConfigDef &other)
 {
     this->options.insert(other.options.begin(), other.options.end());
+    for (const t_config_option_key &opt_key : other.keys)
+        this->assign_id(opt_key);
+}
+
+void
+ConfigDef::assign_id(const t_config_option_key &opt_key)
+{
+    if (this->ids.count(opt_key) > 0) return;
+    this->ids[opt_key] = this->keys.size();
+    this->keys.push_back(opt_key);
 }
 
 bool
@@ -263,8 +264,14 @@ ConfigBase::apply_only(const ConfigBase &other, const t_config_option_keys &opt_
             continue;
         }
         
-        // not the most efficient way, but easier than casting pointers to subclasses
-        bool res = my_opt->deserialize( other.option(opt_key)->serialize() );
+        const ConfigOption* other_opt = other.option(opt_key);
+        if (typeid(*my_opt) == typeid(*other_opt)) {
+            my_opt->set(*other_opt);
+            continue;
+        }
+        
+        // options of different types are converted through their serialized form
+        bool res = my_opt->deserialize(other_opt->serialize());
         if (!res) {
             std::string error = "Unexpected failure when deserializing serialized value for " + opt_key;
             CONFESS(error.c_str());
@@ -272,8 +279,22 @@ ConfigBase::apply_only(const ConfigBase &other, const t_config_option_keys &opt_
     }
 }
 
+// keys unknown to this->def (or all of them if there's no def) are skipped
+t_config_option_ids
+ConfigBase::ids() const {
+    t_config_option_ids ids;
+    if (this->def == NULL) return ids;
+    for (const t_config_option_key &opt_key : this->keys()) {
+        const t_config_option_id opt_id = this->def->id(opt_key);
+        if (opt_id >= 0) ids.push_back(opt_id);
+    }
+    return ids;
+}
+
 bool
 ConfigBase::equals(const ConfigBase &other) const {
+    if (this->def != NULL && this->def == other.def)
+        return this->diff_ids(other).empty();
     return this->diff(other).empty();
 }
 
@@ -282,13 +303,59 @@ t_config_option_keys
 ConfigBase::diff(const ConfigBase &other) const {
     t_config_option_keys diff;
     
-    for (const t_config_option_key &opt_key : this->keys())
-        if (other.has(opt_key) && other.serialize(opt_key) != this->serialize(opt_key))
+    // configs sharing their definition are matched by option ids, without key lookups
+    if (this->def != NULL && this->def == other.def) {
+        for (t_config_option_id opt_id : this->diff_ids(other))
+            diff.push_back(this->def->key(opt_id));
+        return diff;
+    }
+    
+    for (const t_config_option_key &opt_key : this->keys()) {
+        const ConfigOption* other_opt = other.option(opt_key);
+        if (other_opt != NULL && *this->option(opt_key) != *other_opt)
             diff.push_back(opt_key);
+    }
     
     return diff;
 }
 
+// this will *ignore* options not present in both configs, and the ones unknown to this->def
+t_config_option_ids
+ConfigBase::diff_ids(const ConfigBase &other) const {
+    t_config_option_ids diff;
+    
+    const bool same_def = this->def == other.def;
+    for (t_config_option_id opt_id : this->ids()) {
+        const ConfigOption* my_opt = this->option(opt_id);
+        const ConfigOption* other_opt = same_def
+            ? other.option(opt_id)
+            : other.option(this->def->key(opt_id));
+        if (my_opt != NULL && other_opt != NULL && *my_opt != *other_opt)
+            diff.push_back(opt_id);
+    }
+    
+    return diff;
+}
+
+size_t
+ConfigBase::hash() const {
+    size_t seed = 0;
+    if (this->def == NULL) {
+        for (const t_config_option_key &opt_key : this->keys()) {
+            boost::hash_combine(seed, opt_key);
+            boost::hash_combine(seed, this->option(opt_key)->hash());
+        }
+        return seed;
+    }
+    for (t_config_option_id opt_id : this->ids()) {
+        const ConfigOption* opt = this->option(opt_id);
+        if (opt == NULL) continue;
+        boost::hash_combine(seed, opt_id);
+        boost::hash_combine(seed, opt->hash());
+    }
+    return seed;
+}
+
 std::string
 ConfigBase::serialize(const t_config_option_key &opt_key) const {
     const ConfigOption* opt = this->option(opt_key);
@@ -387,6 +454,22 @@ ConfigBase::option(const t_config_option_key &opt_key, bool create) {
     return this->optptr(opt_key, create);
 }
 
+const ConfigOption*
+ConfigBase::option(t_config_option_id opt_id) const {
+    return const_cast<ConfigBase*>(this)->optptr(opt_id);
+}
+
+ConfigOption*
+ConfigBase::option(t_config_option_id opt_id) {
+    return this->optptr(opt_id);
+}
+
+ConfigOption*
+ConfigBase::optptr(t_config_option_id opt_id) {
+    if (this->def == NULL || opt_id < 0 || opt_id >= (t_config_option_id)this->def->size()) return NULL;
+    return this->optptr(this->def->key(opt_id), false);
+}
+
 void
 ConfigBase::load(const std::string &file)
 {
@@ -452,7 +535,8 @@ DynamicConfig::DynamicConfig (const DynamicConfig& other) {
 
 ConfigOption*
 DynamicConfig::optptr(const t_config_option_key &opt_key, bool create) {
-    if (this->options.count(opt_key) == 0) {
+    t_options_map::iterator it = this->options.find(opt_key);
+    if (it == this->options.end()) {
         if (create) {
             const ConfigOptionDef* optdef = this->def->get(opt_key);
             if (optdef == NULL) return NULL;
@@ -498,7 +582,7 @@ DynamicConfig::optptr(const t_config_option_key &opt_key, bool create) {
             return NULL;
         }
     }
-    return this->options[opt_key];
+    return it->second;
 }
 
 t_config_option_keys
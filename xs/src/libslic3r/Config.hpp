@@ -9,7 +9,10 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <typeinfo>
+#include <unordered_map>
 #include <vector>
+#include <boost/functional/hash.hpp>
 #include "libslic3r.h"
 #include "Point.hpp"
 
@@ -18,12 +21,28 @@ namespace Slic3r {
 /// Name of the configuration option.
 typedef std::string t_config_option_key;
 typedef std::vector<std::string> t_config_option_keys;
+/// Integer id of the configuration option, assigned by its ConfigDef. -1 for unknown options.
+typedef int t_config_option_id;
+typedef std::vector<t_config_option_id> t_config_option_ids;
 
 extern std::string escape_string_cstyle(const std::string &str);
 extern std::string escape_strings_cstyle(const std::vector<std::string> &strs);
 extern bool unescape_string_cstyle(const std::string &str, std::string &out);
 extern bool unescape_strings_cstyle(const std::string &str, std::vector<std::string> &out);
 
+/// Hashing of the point valued options, found by boost::hash through ADL.
+inline std::size_t hash_value(const Pointf &point) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, point.x);
+    boost::hash_combine(seed, point.y);
+    return seed;
+}
+inline std::size_t hash_value(const Pointf3 &point) {
+    std::size_t seed = hash_value(static_cast<const Pointf&>(point));
+    boost::hash_combine(seed, point.z);
+    return seed;
+}
+
 /// \brief Public interface for configuration options. 
 ///
 /// Defines get/set for all supported data types.
@@ -41,8 +60,15 @@ class ConfigOption {
     virtual bool getBool() const { return false; };
     virtual void setInt(int val) {};
     virtual std::string getString() const { return ""; };
-    friend bool operator== (const ConfigOption &a, const ConfigOption &b);
-    friend bool operator!= (const ConfigOption &a, const ConfigOption &b);
+    /// Compares the values of two options of the same type directly.
+    /// Options of different types (i.e. ConfigOptionEnumGeneric vs. ConfigOptionEnum<T>)
+    /// are compared by their serialized form.
+    /// Note that floating point values are compared exactly: values which only differ
+    /// beyond the precision of serialize() (i.e. 0.3 and 0.3000001) are not equal.
+    virtual bool operator== (const ConfigOption &rhs) const = 0;
+    bool operator!= (const ConfigOption &rhs) const { return !(*this == rhs); };
+    /// Hash of the option value. Equal options of the same type have equal hashes.
+    virtual size_t hash() const = 0;
 };
 
 /// Value of a single valued option (bool, int, float, string, point, enum)
@@ -57,6 +83,13 @@ class ConfigOptionSingle : public ConfigOption {
         const ConfigOptionSingle<T>* other = dynamic_cast< const ConfigOptionSingle<T>* >(&option);
         if (other != NULL) this->value = other->value;
     };
+    
+    bool operator== (const ConfigOption &rhs) const {
+        if (typeid(*this) != typeid(rhs)) return this->serialize() == rhs.serialize();
+        return this->value == static_cast<const ConfigOptionSingle<T>&>(rhs).value;
+    };
+    
+    size_t hash() const { return boost::hash<T>()(this->value); };
 };
 
 /// Virtual base class, represents value of a vector valued option (bools, ints, floats, strings, points)
@@ -81,6 +114,13 @@ class ConfigOptionVector : public ConfigOptionVectorBase
         if (other != NULL) this->values = other->values;
     };
     
+    bool operator== (const ConfigOption &rhs) const {
+        if (typeid(*this) != typeid(rhs)) return this->serialize() == rhs.serialize();
+        return this->values == static_cast<const ConfigOptionVector<T>&>(rhs).values;
+    };
+    
+    size_t hash() const { return boost::hash_range(this->values.begin(), this->values.end()); };
+    
     T get_at(size_t i) const {
         try {
             return this->values.at(i);
@@ -311,6 +351,18 @@ class ConfigOptionFloatOrPercent : public ConfigOptionPercent
         }
     };
     
+    bool operator== (const ConfigOption &rhs) const {
+        if (typeid(*this) != typeid(rhs)) return this->serialize() == rhs.serialize();
+        const ConfigOptionFloatOrPercent &other = static_cast<const ConfigOptionFloatOrPercent&>(rhs);
+        return this->value == other.value && this->percent == other.percent;
+    };
+    
+    size_t hash() const {
+        size_t seed = ConfigOptionPercent::hash();
+        boost::hash_combine(seed, this->percent);
+        return seed;
+    };
+    
     double get_abs_value(double ratio_over) const {
         if (this->percent) {
             return ratio_over * this->value / 100;
@@ -667,6 +719,21 @@ class ConfigDef
     bool has(const t_config_option_key &opt_key) const;
     const ConfigOptionDef* get(const t_config_option_key &opt_key) const;
     void merge(const ConfigDef &other);
+    /// Integer id of an option, -1 if not defined.
+    /// Ids are assigned in order of definition and stay valid for the lifetime of this ConfigDef.
+    t_config_option_id id(const t_config_option_key &opt_key) const {
+        std::unordered_map<t_config_option_key,t_config_option_id>::const_iterator it = this->ids.find(opt_key);
+        return (it == this->ids.end()) ? -1 : it->second;
+    };
+    /// Name of the option with the given id.
+    const t_config_option_key& key(t_config_option_id opt_id) const { return this->keys.at(opt_id); };
+    /// Number of assigned option ids.
+    size_t size() const { return this->keys.size(); };
+    
+    private:
+    void assign_id(const t_config_option_key &opt_key);
+    std::unordered_map<t_config_option_key,t_config_option_id> ids;
+    t_config_option_keys keys;
 };
 
 /// An abstract configuration store.
@@ -691,12 +758,24 @@ class ConfigBase
     template<class T> const T* opt(const t_config_option_key &opt_key) const {
         return dynamic_cast<const T*>(this->option(opt_key));
     };
+    const ConfigOption* option(t_config_option_id opt_id) const;
+    ConfigOption* option(t_config_option_id opt_id);
     virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) = 0;
+    /// Resolve an option by its id in this->def. Static configs override this with a table lookup.
+    virtual ConfigOption* optptr(t_config_option_id opt_id);
     virtual t_config_option_keys keys() const = 0;
+    /// Ids of the options returned by keys(), skipping the ones unknown to this->def.
+    virtual t_config_option_ids ids() const;
     void apply(const ConfigBase &other, bool ignore_nonexistent = false);
     void apply_only(const ConfigBase &other, const t_config_option_keys &opt_keys, bool ignore_nonexistent = false);
     bool equals(const ConfigBase &other) const;
     t_config_option_keys diff(const ConfigBase &other) const;
+    /// Same as diff(), returning the ids of the differing options in this->def.
+    /// Options unknown to this->def are skipped.
+    t_config_option_ids diff_ids(const ConfigBase &other) const;
+    /// Hash of the option ids and values of this config.
+    /// Configs sharing their ConfigDef, which compare equal, have equal hashes.
+    size_t hash() const;
     std::string serialize(const t_config_option_key &opt_key) const;
     virtual bool set_deserialize(t_config_option_key opt_key, std::string str, bool append = false);
     double get_abs_value(const t_config_option_key &opt_key) const;
@@ -717,6 +796,7 @@ class DynamicConfig : public virtual ConfigBase
     DynamicConfig& operator= (DynamicConfig other);
     void swap(DynamicConfig &other);
     virtual ~DynamicConfig();
+    using ConfigBase::optptr;
     virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false);
     t_config_option_keys keys() const;
     void erase(const t_config_option_key &opt_key);
@@ -730,6 +810,69 @@ class DynamicConfig : public virtual ConfigBase
     t_options_map options;
 };
 
+/// Lookup table of the statically defined options of a StaticConfig class.
+/// Built once per class by resolving every key of the ConfigDef through the OPT_PTR chain
+/// of the class (_optptr), it stores the offset of each option member indexed by option id.
+/// The offsets are relative to the class itself, so they are valid for stand-alone objects
+/// as well as for base class sub-objects (i.e. PrintObjectConfig inside FullPrintConfig).
+class StaticConfigIndex
+{
+    public:
+    const ConfigDef* def;
+    /// Keys of all options defined by the class, in order of ConfigDef::options.
+    t_config_option_keys keys;
+    /// Ids of the options in keys.
+    t_config_option_ids ids;
+    
+    template<class T> explicit StaticConfigIndex(T* config) : def(config->def) {
+        if (this->def == NULL) return;
+        this->offsets.assign(this->def->size(), -1);
+        for (t_optiondef_map::const_iterator it = this->def->options.begin(); it != this->def->options.end(); ++it) {
+            ConfigOption* opt = config->_optptr(it->first);
+            if (opt == NULL) continue;
+            this->offsets[this->def->id(it->first)] = reinterpret_cast<char*>(opt) - reinterpret_cast<char*>(config);
+            this->keys.push_back(it->first);
+            this->ids.push_back(this->def->id(it->first));
+        }
+    };
+    
+    ConfigOption* get(void* config, t_config_option_id opt_id) const {
+        if (opt_id < 0 || opt_id >= (t_config_option_id)this->offsets.size() || this->offsets[opt_id] < 0) return NULL;
+        return reinterpret_cast<ConfigOption*>(reinterpret_cast<char*>(config) + this->offsets[opt_id]);
+    };
+    
+    private:
+    std::vector<std::ptrdiff_t> offsets;
+};
+
+/// Implements the option lookup of a StaticConfig class through its StaticConfigIndex.
+/// The class has to list its options with OPT_PTR in a non-virtual _optptr(opt_key) method.
+#define STATIC_CONFIG_INDEX(CLASS) \
+    static const StaticConfigIndex& static_index(CLASS* config) { \
+        static const StaticConfigIndex index(config); \
+        return index; \
+    }; \
+    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) { \
+        const StaticConfigIndex &index = CLASS::static_index(this); \
+        if (this->def == NULL || index.def != this->def) return this->CLASS::_optptr(opt_key); \
+        return index.get(this, this->def->id(opt_key)); \
+    }; \
+    virtual ConfigOption* optptr(t_config_option_id opt_id) { \
+        const StaticConfigIndex &index = CLASS::static_index(this); \
+        if (index.def != this->def) return this->ConfigBase::optptr(opt_id); \
+        return index.get(this, opt_id); \
+    }; \
+    virtual t_config_option_keys keys() const { \
+        const StaticConfigIndex &index = CLASS::static_index(const_cast<CLASS*>(this)); \
+        if (index.def != this->def) return this->StaticConfig::keys(); \
+        return index.keys; \
+    }; \
+    virtual t_config_option_ids ids() const { \
+        const StaticConfigIndex &index = CLASS::static_index(const_cast<CLASS*>(this)); \
+        if (index.def != this->def) return this->ConfigBase::ids(); \
+        return index.ids; \
+    };
+
 /// Configuration store with a static definition of configuration values.
 /// In Slic3r, the static configuration stores are during the slicing / g-code generation for efficiency reasons,
 /// because the configuration values could be accessed directly.
@@ -737,13 +880,15 @@ class StaticConfig : public virtual ConfigBase
 {
     public:
     StaticConfig() : ConfigBase() {};
+    using ConfigBase::optptr;
     /// Gets list of config option names for each config option of this->def, which has a static counter-part defined by the derived object
     /// and which could be resolved by this->optptr(key) call.
     t_config_option_keys keys() const;
     /// Set all statically defined config options to their defaults defined by this->def.
     void set_defaults();
-    /// The derived class has to implement optptr to resolve a static configuration value.
-    /// virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) = 0;
+    /// The derived class has to list its options in _optptr and use STATIC_CONFIG_INDEX
+    /// to resolve a static configuration value.
+    /// ConfigOption* _optptr(const t_config_option_key &opt_key);
 };
 
 /// Specialization of std::exception to indicate that an unknown config option has been encountered.
@@ -57,13 +57,16 @@ class ElectronicPart
     void setPosition(double x, double y, double z);
     void setPartHeight(double height) {this->size[2] = height;};
     double getPartHeight() {return this->size[2];};
+    Pointf3 getSize() {return Pointf3(this->size[0], this->size[1], this->size[2]);};
     Pointf3 getPosition() {return this->position;};
     void resetPosition();
     void setRotation(double x, double y, double z);
     Pointf3 getRotation() {return this->rotation;};
     void setPartOrigin(double x, double y, double z);  //internal position of the part, defines origin
+    Pointf3 getPartOrigin() {return Pointf3(this->origin[0], this->origin[1], this->origin[2]);};
     void addPad(std::string type, std::string pad, std::string pin, std::string gate, double x, double y, double rotation, double dx, double dy, double drill, std::string shape);
     bool hasPad(std::string padName);
+    const Padlist* getPadlist() const {return &this->padlist;};
     Pointf3 getAbsPadPosition(std::string padName);
     Pointf3 getAbsPadPositionPerimeter(std::string padName, bool inner);
     void setVisibility(bool visible) {this->visible = visible;};
@@ -8,6 +8,7 @@ ElectronicWireGenerator::ElectronicWireGenerator(Layer* layer, ElectronicWireGen
         double extrusion_overlap, double first_extrusion_overlap, double overlap_min_extrusion_length, double conductive_wire_bed_width, double conductive_wire_channel_width, const double grid_step_size) :
         layer(layer),
         previous_ewg(previous_ewg),
+        next_ewg(nullptr),
         extrusion_width(extrusion_width),
         extrusion_overlap(extrusion_overlap),
         first_extrusion_overlap(first_extrusion_overlap),
@@ -15,7 +16,8 @@ ElectronicWireGenerator::ElectronicWireGenerator(Layer* layer, ElectronicWireGen
         conductive_wire_bed_width(conductive_wire_bed_width),
         conductive_wire_channel_width(conductive_wire_channel_width),
         unrouted_wires(layer->unrouted_wires),
-        grid_step_size(grid_step_size)
+        grid_step_size(grid_step_size),
+        deflated_slices_aligned(false)
 {
     // number of applicable perimeters
     this->max_perimeters = 9999;
@@ -66,91 +68,113 @@ ExPolygonCollections*
 ElectronicWireGenerator::get_contour_set()
 {
     if(this->deflated_slices.size() < 1) {
+        this->_make_contour_set();
+    }
+    // alignment depends on the previous layer and must be done in layer order
+    if(!this->deflated_slices_aligned) {
+        this->_align_to_prev_perimeters();
+        this->deflated_slices_aligned = true;
+    }
+
+    return &this->deflated_slices;
+}
 
-        // collect slices from n previous layers and compute intersection to
-        // use only regions which are supported by at least n layers
+/* Build the deflated contour set of this layer without aligning it to the previous layer.
+ * Only reads slices of adjacent layers and routed wires of the next layers,
+ * so it can be executed for all layers in parallel (see ElectronicWireRouter::_make_contour_sets).
+ */
+void
+ElectronicWireGenerator::_make_contour_set()
+{
+    this->_invalidate_contour_set();
 
-        size_t region_count = this->layer->region_count();
-        ExPolygonCollections slices;
-        slices.resize(region_count);
+    // collect slices from n previous layers and compute intersection to
+    // use only regions which are supported by at least n layers
 
-        if(this->layer->lower_layer != nullptr && this->prev_shells > 0) {
-            Layer* current_layer = this->layer->lower_layer;
-            for(size_t r = 0; r < region_count; r++) {
-                slices[r] = ExPolygonCollection(current_layer->regions[r]->slices);
-            }
-            for(int i = 1; i < this->prev_shells; i++) {
-                if(current_layer->lower_layer != nullptr) {
-                    current_layer = current_layer->lower_layer;
-                    for(size_t r = 0; r < region_count; r++) {
-                        slices[r] = intersection_ex((Polygons)slices[r], (Polygons)current_layer->regions[r]->slices);
-                    }
+    size_t region_count = this->layer->region_count();
+    ExPolygonCollections slices;
+    slices.resize(region_count);
+
+    if(this->layer->lower_layer != nullptr && this->prev_shells > 0) {
+        Layer* current_layer = this->layer->lower_layer;
+        for(size_t r = 0; r < region_count; r++) {
+            slices[r] = ExPolygonCollection(current_layer->regions[r]->slices);
+        }
+        for(int i = 1; i < this->prev_shells; i++) {
+            if(current_layer->lower_layer != nullptr) {
+                current_layer = current_layer->lower_layer;
+                for(size_t r = 0; r < region_count; r++) {
+                    slices[r] = intersection_ex((Polygons)slices[r], (Polygons)current_layer->regions[r]->slices);
                 }
             }
-        }else{
-            for(size_t r = 0; r < region_count; r++) {
-                slices[r] = ExPolygonCollection(this->layer->regions[r]->slices);
-            }
         }
+    }else{
+        for(size_t r = 0; r < region_count; r++) {
+            slices[r] = ExPolygonCollection(this->layer->regions[r]->slices);
+        }
+    }
 
-        // remove cavity polygons again on this layer as we don't want the wires running through components
-        for(const Polygon &p : this->layer->electronic_component_polyons) {
-            for(size_t r = 0; r < region_count; r++) {
-                slices[r] = diff_ex((Polygons)slices[r], p);
-            }
+    // remove cavity polygons again on this layer as we don't want the wires running through components
+    for(const Polygon &p : this->layer->electronic_component_polyons) {
+        for(size_t r = 0; r < region_count; r++) {
+            slices[r] = diff_ex((Polygons)slices[r], p);
         }
+    }
 
-        // handle next layers, coverage doesn't matter, only routed wires must be avoided
-        ElectronicWireGenerator* current_ewg = this;
-        for(int i = 0; i < this->next_shells; i++) {
-            for(size_t r = 0; r < region_count; r++) {
-                // routed wires
-                for(Polyline &pl : current_ewg->routed_wires) {
-                    slices[r] = diff_ex((Polygons)slices[r], this->inflate_wire(pl));
-                }
-                // cavities
-                for(const Polygon &p : current_ewg->layer->electronic_component_polyons) {
-                    for(size_t r = 0; r < region_count; r++) {
-                        slices[r] = diff_ex((Polygons)slices[r], p);
-                    }
-                }
+    // handle next layers, coverage doesn't matter, only routed wires must be avoided
+    ElectronicWireGenerator* current_ewg = this;
+    for(int i = 0; i < this->next_shells; i++) {
+        for(size_t r = 0; r < region_count; r++) {
+            // routed wires
+            for(Polyline &pl : current_ewg->routed_wires) {
+                slices[r] = diff_ex((Polygons)slices[r], this->inflate_wire(pl));
             }
-            if(current_ewg->next_ewg != nullptr) {
-                current_ewg = current_ewg->next_ewg;
-            }else{
-                break;
+            // cavities
+            for(const Polygon &p : current_ewg->layer->electronic_component_polyons) {
+                for(size_t r = 0; r < region_count; r++) {
+                    slices[r] = diff_ex((Polygons)slices[r], p);
+                }
             }
         }
+        if(current_ewg->next_ewg != nullptr) {
+            current_ewg = current_ewg->next_ewg;
+        }else{
+            break;
+        }
+    }
 
-        for(int i=0; i < max_perimeters; i++) {
-            // initialize vector element
-            this->deflated_slices.push_back(ExPolygonCollection());
+    for(int i=0; i < max_perimeters; i++) {
+        // initialize vector element
+        this->deflated_slices.push_back(ExPolygonCollection());
 
-            //for(const auto &region : this->layer->regions) {
-            //    const coord_t perimeters_thickness = this->offset_width(region, i+1);
-            //    this->deflated_slices[i].append(offset_ex((Polygons)region->slices, -perimeters_thickness));
-           // }
+        //for(const auto &region : this->layer->regions) {
+        //    const coord_t perimeters_thickness = this->offset_width(region, i+1);
+        //    this->deflated_slices[i].append(offset_ex((Polygons)region->slices, -perimeters_thickness));
+       // }
 
-            for(int r = 0; r < this->layer->region_count(); r++) {
-                const coord_t perimeters_thickness = this->offset_width(this->layer->regions[r], i+1);
-                this->deflated_slices[i].append(offset_ex((Polygons)slices[r], -perimeters_thickness));
-            }
-            // intersection / offsetting introduces collinear points
-            for(ExPolygon &ep : this->deflated_slices[i].expolygons) {
-                ep.remove_colinear_points();
-            }
+        for(int r = 0; r < this->layer->region_count(); r++) {
+            const coord_t perimeters_thickness = this->offset_width(this->layer->regions[r], i+1);
+            this->deflated_slices[i].append(offset_ex((Polygons)slices[r], -perimeters_thickness));
         }
-
-        // store slices in one collection for in/outside of material checking in graph search
-        this->slices.expolygons.clear();
-        for(ExPolygonCollection &epc : slices) {
-            this->slices.append(epc);
+        // intersection / offsetting introduces collinear points
+        for(ExPolygon &ep : this->deflated_slices[i].expolygons) {
+            ep.remove_colinear_points();
         }
+    }
 
-        this->_align_to_prev_perimeters();
+    // store slices in one collection for in/outside of material checking in graph search
+    this->slices.expolygons.clear();
+    for(ExPolygonCollection &epc : slices) {
+        this->slices.append(epc);
     }
+}
 
-    return &this->deflated_slices;
+// reset deflated slices to trigger re-generation
+void
+ElectronicWireGenerator::_invalidate_contour_set()
+{
+    this->deflated_slices.clear();
+    this->deflated_slices_aligned = false;
 }
 
 /* Compute a set of weighed segments by intersecting
@@ -161,10 +185,10 @@ ElectronicWireGenerator::get_contour_set()
 WireSegments
 ElectronicWireGenerator::get_wire_segments(Lines& wire, const double routing_perimeter_factor, const double routing_hole_factor)
 {
-    // ensure deflated slices are properly initialized
-    if(this->deflated_slices.size() < 1) {
-        this->get_contour_set();
-    }
+    // ensure deflated slices are properly initialized and aligned before the
+    // intersection points are inserted: the contours may have been built in parallel
+    // by ElectronicWireRouter::_make_contour_sets() without being aligned yet
+    this->get_contour_set();
 
     WireSegments segments;
     for(auto &line : wire) {
@@ -223,7 +247,7 @@ ElectronicWireGenerator::add_routed_wire(Polyline &routed_wire)
     // generate channels / beds
     this->channel_from_wire(routed_wire);
     this->routed_wires.push_back(routed_wire);
-    this->deflated_slices.clear();
+    this->_invalidate_contour_set();
 
     // also clear slices from affected prev / next layers
     ElectronicWireGenerator* current_ewg = this;
@@ -234,7 +258,7 @@ ElectronicWireGenerator::add_routed_wire(Polyline &routed_wire)
             break;
         }
         if(current_ewg != nullptr) {
-            current_ewg->deflated_slices.clear();
+            current_ewg->_invalidate_contour_set();
         }
     }
 
@@ -246,7 +270,7 @@ ElectronicWireGenerator::add_routed_wire(Polyline &routed_wire)
             break;
         }
         if(current_ewg != nullptr) {
-            current_ewg->deflated_slices.clear();
+            current_ewg->_invalidate_contour_set();
         }
     }
 }
@@ -53,6 +53,8 @@ public:
     void generate_wires();
 
 private:
+    void _make_contour_set();
+    void _invalidate_contour_set();
     void sort_unrouted_wires();
     void channel_from_wire(Polyline &wire);
     Polygons inflate_wire(const Polyline &wire) const;
@@ -79,6 +81,7 @@ private:
     int next_shells;
     ExPolygonCollection slices;
     ExPolygonCollections deflated_slices;
+    bool deflated_slices_aligned; ///< deflated_slices are aligned to previous_ewg
 
     friend class ElectronicWireRouter;
 };
@@ -93,13 +96,15 @@ public:
             const double routing_hole_factor,
             const double routing_interlayer_factor,
             const double grid_step_size,
-            const int layer_count);
+            const int layer_count,
+            const int threads);
     void append_wire_generator(ElectronicWireGenerator& ewg);
     ElectronicWireGenerator* last_ewg();
     void route(const RubberBand* rb, const Point3 offset, bool autorouting = true);
     void generate_wires();
 
 private:
+    void _make_contour_sets();
     coord_t _map_z_to_layer(coord_t z) const;
 
     ElectronicWireGenerators ewgs;
@@ -110,6 +115,7 @@ private:
     const double routing_hole_factor;
     const double routing_interlayer_factor;
     const double grid_step_size;
+    const int threads;
 };
 
 }
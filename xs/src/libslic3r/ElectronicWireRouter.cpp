@@ -5,13 +5,14 @@ namespace Slic3r {
 
 ElectronicWireRouter::ElectronicWireRouter(const double layer_overlap, const double routing_astar_factor,
         const double routing_perimeter_factor, const double routing_hole_factor,
-        const double routing_interlayer_factor, const double grid_step_size, const int layer_count) :
+        const double routing_interlayer_factor, const double grid_step_size, const int layer_count, const int threads) :
         layer_overlap(layer_overlap),
         routing_astar_factor(routing_astar_factor),
         routing_perimeter_factor(routing_perimeter_factor),
         routing_hole_factor(routing_hole_factor),
         routing_interlayer_factor(routing_interlayer_factor),
-        grid_step_size(grid_step_size)
+        grid_step_size(grid_step_size),
+        threads(threads)
         {
     this->ewgs.reserve(layer_count + 1); // required to avoid reallocations -> invalid previous_ewg references
 }
@@ -44,6 +45,10 @@ ElectronicWireRouter::route(const RubberBand* rb, const Point3 offset, bool auto
 
     if(autorouting) {
 
+        // contours of all invalidated layers are independent of each other, only
+        // the alignment to the previous layer is done sequentially below.
+        this->_make_contour_sets();
+
         // (re-)build routing graph
         Lines wire, last_wire;
         bool overlap_wire_a , overlap_wire_b;
@@ -286,9 +291,14 @@ ElectronicWireRouter::route(const RubberBand* rb, const Point3 offset, bool auto
     }else{ // no autorouting, just use direct connections from rubberbands
         Lines wire;
         bool overlap_wire_a , overlap_wire_b;
-        for (auto &ewg : this->ewgs) {
-            coord_t print_z = ewg.get_scaled_print_z();
-            coord_t bottom_z = ewg.get_scaled_bottom_z();
+        // only visit layers within the z extent of this rubberband. print_z is the upper
+        // bound of each layer, the first affected layer is the first one above z_min.
+        std::map<coord_t, ElectronicWireGenerator*>::iterator it = this->z_map.upper_bound(scale_(rb->getZMin()) - 1);
+        for (; it != this->z_map.end(); ++it) {
+            ElectronicWireGenerator &ewg = *(it->second);
+            if(ewg.get_bottom_z() > rb->getZMax()) {
+                break;
+            }
             // get flat segments for this layer, including pin contact extensions
             wire.clear();
             if(rb->getLayerSegments(ewg.get_bottom_z(), ewg.get_print_z(), this->layer_overlap, &wire, &overlap_wire_a, &overlap_wire_b)) {
@@ -306,12 +316,36 @@ ElectronicWireRouter::route(const RubberBand* rb, const Point3 offset, bool auto
 }
 
 
+// wire generation only touches the layer of each generator, process all layers in parallel
 void
 ElectronicWireRouter::generate_wires()
 {
+    std::queue<ElectronicWireGenerator*> queue;
+    for(auto &ewg : this->ewgs) {
+        queue.push(&ewg);
+    }
+    parallelize<ElectronicWireGenerator*>(
+        queue,
+        boost::bind(&Slic3r::ElectronicWireGenerator::generate_wires, _1),
+        this->threads
+    );
+}
+
+// (re-)build deflated contours for all layers invalidated by previously routed wires
+void
+ElectronicWireRouter::_make_contour_sets()
+{
+    std::queue<ElectronicWireGenerator*> queue;
     for(auto &ewg : this->ewgs) {
-        ewg.generate_wires();
+        if(ewg.deflated_slices.size() < 1) {
+            queue.push(&ewg);
+        }
     }
+    parallelize<ElectronicWireGenerator*>(
+        queue,
+        boost::bind(&Slic3r::ElectronicWireGenerator::_make_contour_set, _1),
+        this->threads
+    );
 }
 
 /* map z-coordinate to
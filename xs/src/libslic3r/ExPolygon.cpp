@@ -55,9 +55,15 @@ ExPolygon::translate(double x, double y)
 void
 ExPolygon::rotate(double angle)
 {
-    contour.rotate(angle);
+    this->rotate(cos(angle), sin(angle));
+}
+
+void
+ExPolygon::rotate(double cos_angle, double sin_angle)
+{
+    contour.rotate(cos_angle, sin_angle);
     for (Polygons::iterator it = holes.begin(); it != holes.end(); ++it) {
-        (*it).rotate(angle);
+        (*it).rotate(cos_angle, sin_angle);
     }
 }
 
@@ -25,6 +25,7 @@ class ExPolygon
     void scale(double factor);
     void translate(double x, double y);
     void rotate(double angle);
+    void rotate(double cos_angle, double sin_angle);
     void rotate(double angle, const Point &center);
     double area() const;
     bool is_valid() const;
@@ -2,7 +2,7 @@
 #include "../ClipperUtils.hpp"
 #include "../PolylineCollection.hpp"
 #include "../Surface.hpp"
-
+#include "FillPatternCache.hpp"
 
 namespace Slic3r {
 
@@ -32,7 +32,7 @@ FillHoneycomb::_fill_surface_single(
     }
     CacheData &m = it_m->second;
 
-    Polygons polygons;
+    std::shared_ptr<const Polygons> pattern;
     {
         // adjust actual bounding box to the nearest multiple of our hex pattern
         // and align it so that it matches across layers
@@ -50,27 +50,47 @@ FillHoneycomb::_fill_surface_single(
             bounding_box.min.align_to_grid(Point(m.hex_width, m.pattern_height));
         }
 
-        for (coord_t x = bounding_box.min.x; x <= bounding_box.max.x; ) {
-            Polygon p;
-            coord_t ax[2] = { x + m.x_offset, x + m.distance - m.x_offset };
-            for (size_t i = 0; i < 2; ++ i) {
-                std::reverse(p.points.begin(), p.points.end()); // turn first half upside down
-                for (coord_t y = bounding_box.min.y; y <= bounding_box.max.y; y += m.y_short + m.hex_side + m.y_short + m.hex_side) {
-                    p.points.push_back(Point(ax[1], y + m.y_offset));
-                    p.points.push_back(Point(ax[0], y + m.y_short - m.y_offset));
-                    p.points.push_back(Point(ax[0], y + m.y_short + m.hex_side + m.y_offset));
-                    p.points.push_back(Point(ax[1], y + m.y_short + m.hex_side + m.y_short - m.y_offset));
-                    p.points.push_back(Point(ax[1], y + m.y_short + m.hex_side + m.y_short + m.hex_side + m.y_offset));
+        // The pattern is shared by the surfaces having the same aligned bounding box,
+        // whose size is rounded down to the steps of the loops below.
+        const coord_t x_step = 2 * m.distance;
+        const coord_t y_step = m.y_short + m.hex_side + m.y_short + m.hex_side;
+        bounding_box.max.x = bounding_box.min.x + (bounding_box.max.x - bounding_box.min.x) / x_step * x_step;
+        bounding_box.max.y = bounding_box.min.y + (bounding_box.max.y - bounding_box.min.y) / y_step * y_step;
+        FillPatternCache<Polygons>::Key key;
+        key.first = "honeycomb";
+        key.second.push_back(this->density);
+        key.second.push_back(this->min_spacing);
+        key.second.push_back(direction.first);
+        key.second.push_back(bounding_box.min.x);
+        key.second.push_back(bounding_box.min.y);
+        key.second.push_back(bounding_box.max.x);
+        key.second.push_back(bounding_box.max.y);
+        pattern = FillPatternCache<Polygons>::get(key, [&]() {
+            Polygons polygons;
+            for (coord_t x = bounding_box.min.x; x <= bounding_box.max.x; ) {
+                Polygon p;
+                coord_t ax[2] = { x + m.x_offset, x + m.distance - m.x_offset };
+                for (size_t i = 0; i < 2; ++ i) {
+                    std::reverse(p.points.begin(), p.points.end()); // turn first half upside down
+                    for (coord_t y = bounding_box.min.y; y <= bounding_box.max.y; y += m.y_short + m.hex_side + m.y_short + m.hex_side) {
+                        p.points.push_back(Point(ax[1], y + m.y_offset));
+                        p.points.push_back(Point(ax[0], y + m.y_short - m.y_offset));
+                        p.points.push_back(Point(ax[0], y + m.y_short + m.hex_side + m.y_offset));
+                        p.points.push_back(Point(ax[1], y + m.y_short + m.hex_side + m.y_short - m.y_offset));
+                        p.points.push_back(Point(ax[1], y + m.y_short + m.hex_side + m.y_short + m.hex_side + m.y_offset));
+                    }
+                    ax[0] = ax[0] + m.distance;
+                    ax[1] = ax[1] + m.distance;
+                    std::swap(ax[0], ax[1]); // draw symmetrical pattern
+                    x += m.distance;
                 }
-                ax[0] = ax[0] + m.distance;
-                ax[1] = ax[1] + m.distance;
-                std::swap(ax[0], ax[1]); // draw symmetrical pattern
-                x += m.distance;
+                p.rotate(-direction.first, m.hex_center);
+                polygons.push_back(p);
             }
-            p.rotate(-direction.first, m.hex_center);
-            polygons.push_back(p);
-        }
+            return polygons;
+        });
     }
+    const Polygons &polygons = *pattern;
     
     if (true || this->complete) {
         // we were requested to complete each loop;
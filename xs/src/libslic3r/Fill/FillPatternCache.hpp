@@ -0,0 +1,88 @@
+#ifndef slic3r_FillPatternCache_hpp_
+#define slic3r_FillPatternCache_hpp_
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+#include "../libslic3r.h"
+
+// minimum number of points held by each pattern cache before it is flushed,
+// PrintObject::_infill() raises it to fit the patterns of the object
+#define FILL_PATTERN_CACHE_POINTS 250000
+
+namespace Slic3r {
+
+// Process-wide cache of the infill patterns which only depend on their parameters
+// and not on the surface being filled, so that the layers sharing the same parameters
+// generate the pattern once and only clip it to their surfaces.
+// T is a collection of MultiPoint (Polylines or Polygons).
+template <class T>
+class FillPatternCache
+{
+public:
+    // name of the pattern and the parameters it was generated from
+    typedef std::pair<std::string, std::vector<coordf_t> > Key;
+
+    // Returns the cached pattern, or calls generate() and caches its result.
+    // generate() runs without holding the lock, so concurrent misses may
+    // generate the same pattern; the first one stored is kept.
+    template <class Generator>
+    static std::shared_ptr<const T> get(const Key &key, Generator generate)
+    {
+        {
+            boost::lock_guard<boost::mutex> l(mutex());
+            typename Patterns::const_iterator it = patterns().find(key);
+            if (it != patterns().end()) return it->second;
+        }
+
+        std::shared_ptr<const T> pattern(new T(generate()));
+        size_t n = 0;
+        for (typename T::const_iterator it = pattern->begin(); it != pattern->end(); ++it)
+            n += it->points.size();
+
+        boost::lock_guard<boost::mutex> l(mutex());
+        std::pair<typename Patterns::iterator, bool> ins = patterns().insert(std::make_pair(key, pattern));
+        if (!ins.second) return ins.first->second;
+        if (points() + n > capacity()) {
+            // flush the cache, the patterns still in use are released by their users
+            patterns().clear();
+            patterns().insert(std::make_pair(key, pattern));
+            points() = 0;
+        }
+        points() += n;
+        return pattern;
+    };
+
+    // Sets the number of points held before the cache is flushed,
+    // it is never lower than FILL_PATTERN_CACHE_POINTS.
+    static void set_capacity(size_t n)
+    {
+        boost::lock_guard<boost::mutex> l(mutex());
+        capacity() = std::max<size_t>(n, FILL_PATTERN_CACHE_POINTS);
+    };
+
+    // Releases the cached patterns, the ones still in use are released by their users.
+    static void clear()
+    {
+        boost::lock_guard<boost::mutex> l(mutex());
+        patterns().clear();
+        points() = 0;
+    };
+
+private:
+    typedef std::map<Key, std::shared_ptr<const T> > Patterns;
+
+    static boost::mutex& mutex()    { static boost::mutex m; return m; };
+    static Patterns&     patterns() { static Patterns p; return p; };
+    static size_t&       points()   { static size_t n = 0; return n; };
+    static size_t&       capacity() { static size_t n = FILL_PATTERN_CACHE_POINTS; return n; };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_FillPatternCache_hpp_
@@ -2,8 +2,11 @@
 #include "../PolylineCollection.hpp"
 #include "../Surface.hpp"
 
+#include "FillPatternCache.hpp"
 #include "FillPlanePath.hpp"
 
+#include <typeinfo>
+
 namespace Slic3r {
 
 void FillPlanePath::_fill_surface_single(
@@ -28,27 +31,41 @@ void FillPlanePath::_fill_surface_single(
     expolygon.translate(-shift.x, -shift.y);
     bounding_box.translate(-shift.x, -shift.y);
 
-    const Pointfs pts = this->_generate(
-        coord_t(ceil(coordf_t(bounding_box.min.x) / distance_between_lines)),
-        coord_t(ceil(coordf_t(bounding_box.min.y) / distance_between_lines)),
-        coord_t(ceil(coordf_t(bounding_box.max.x) / distance_between_lines)),
-        coord_t(ceil(coordf_t(bounding_box.max.y) / distance_between_lines))
-    );
+    // The pattern only depends on its grid, so it is shared by all the layers
+    // having the same bounding box and spacing.
+    const coord_t min_x = coord_t(ceil(coordf_t(bounding_box.min.x) / distance_between_lines));
+    const coord_t min_y = coord_t(ceil(coordf_t(bounding_box.min.y) / distance_between_lines));
+    const coord_t max_x = coord_t(ceil(coordf_t(bounding_box.max.x) / distance_between_lines));
+    const coord_t max_y = coord_t(ceil(coordf_t(bounding_box.max.y) / distance_between_lines));
+    FillPatternCache<Polylines>::Key key;
+    key.first = typeid(*this).name();
+    key.second.push_back(distance_between_lines);
+    key.second.push_back(min_x);
+    key.second.push_back(min_y);
+    key.second.push_back(max_x);
+    key.second.push_back(max_y);
+    const std::shared_ptr<const Polylines> pattern = FillPatternCache<Polylines>::get(key, [&]() {
+        const Pointfs pts = this->_generate(min_x, min_y, max_x, max_y);
+        Polylines pattern;
+        if (pts.size() >= 2) {
+            // Convert points to a polyline, upscale.
+            pattern.push_back(Polyline());
+            Polyline &polyline = pattern.back();
+            polyline.points.reserve(pts.size());
+            for (Pointfs::const_iterator it = pts.begin(); it != pts.end(); ++ it) {
+                polyline.points.push_back(Point(
+                    coord_t(floor(it->x * distance_between_lines + 0.5)), 
+                    coord_t(floor(it->y * distance_between_lines + 0.5))
+                ));
+            }
+        }
+        return pattern;
+    });
 
     Polylines polylines;
-    if (pts.size() >= 2) {
-        // Convert points to a polyline, upscale.
-        polylines.push_back(Polyline());
-        Polyline &polyline = polylines.back();
-        polyline.points.reserve(pts.size());
-        for (Pointfs::const_iterator it = pts.begin(); it != pts.end(); ++ it) {
-            polyline.points.push_back(Point(
-                coord_t(floor(it->x * distance_between_lines + 0.5)), 
-                coord_t(floor(it->y * distance_between_lines + 0.5))
-            ));
-        }
+    if (!pattern->empty()) {
 //      polylines = intersection_pl(polylines_src, offset((Polygons)expolygon, scale_(0.02)));
-        polylines = intersection_pl(polylines, (Polygons)expolygon);
+        polylines = intersection_pl(*pattern, (Polygons)expolygon);
         
         // Extend paths in order to ensure overlap with perimeters
         for (Polyline &p : polylines) {
@@ -20,12 +20,10 @@ void
 FillRectilinear::_fill_single_direction(ExPolygon expolygon,
     const direction_t &direction, coord_t x_shift, Polylines* out)
 {
-    // Remove almost collinear points (vertical ones might break this algorithm
-    // because of rounding).
-    expolygon.remove_vertical_collinear_points(1);
-    
     // rotate polygons so that we can work with vertical lines here
-    expolygon.rotate(-direction.first);
+    const double cos_angle = cos(double(direction.first));
+    const double sin_angle = sin(double(direction.first));
+    expolygon.rotate(cos_angle, -sin_angle);
     
     assert(this->density > 0.0001f && this->density <= 1.f);
     const coord_t min_spacing   = scale_(this->min_spacing);
@@ -33,6 +31,7 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
     
     // We ignore this->bounding_box because it doesn't matter; we're doing align_to_grid below.
     BoundingBox bounding_box    = expolygon.contour.bounding_box();
+    const BoundingBox contour_bb = bounding_box;
     
     // Ignore too small expolygons.
     if (bounding_box.size().x < min_spacing) return;
@@ -63,7 +62,7 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
     }
     
     // Find all the polygons points intersecting the rectilinear vertical lines and store
-    // them in an std::map<> (grid) which orders them automatically by x and y.
+    // them in a table of std::map<> (grid) which orders them automatically by x and y.
     // For each intersection point we store its position (upper/lower): upper means it's
     // the upper endpoint of an intersection line, and vice versa.
     // Whenever between two intersection points we find vertices of the original polygon,
@@ -88,9 +87,16 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
         IntersectionPoint(coord_t x, coord_t y, ipType _type) : Point(x,y), type(_type) {};
     };
     typedef std::map<coord_t,IntersectionPoint> vertical_t; // <y,point>
-    typedef std::map<coord_t,vertical_t>        grid_t;     // <x,<y,point>>
     
-    grid_t grid;
+    // The vertical lines are at bounding_box.min.x + k * line_spacing, so the grid is a table
+    // of the lines crossing the contour, indexed by k - first_line. All the vertical lines
+    // are collected in a single pass over the polygon edges.
+    const coord_t first_line = floor((double) (contour_bb.min.x - bounding_box.min.x) / (double)line_spacing);
+    const coord_t last_line  = floor((double) (contour_bb.max.x - bounding_box.min.x) / (double)line_spacing);
+    std::vector<vertical_t> grid(last_line - first_line + 1);
+    auto vertical = [&grid, &bounding_box, line_spacing, first_line](coord_t x) -> vertical_t& {
+        return grid[(x - bounding_box.min.x) / line_spacing - first_line];
+    };
     {
         const Polygons polygons = expolygon;
         for (Polygons::const_iterator polygon = polygons.begin(); polygon != polygons.end(); ++polygon) {
@@ -111,7 +117,7 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
                 // Does the p-next line belong to an intersection line?
                 if (p->x == next.x && ((p->x - bounding_box.min.x) % line_spacing) == 0) {
                     if (p->y == next.y) continue;  // skip coinciding points
-                    vertical_t &v = grid[p->x];
+                    vertical_t &v = vertical(p->x);
                     
                     // Detect line direction.
                     IntersectionPoint::ipType p_type = IntersectionPoint::ipTypeLower;
@@ -203,7 +209,7 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
                         p->y + double(next.y - p->y) * double(x - p->x) / double(next.x - p->x),
                         line_goes_right ? IntersectionPoint::ipTypeLower : IntersectionPoint::ipTypeUpper
                     );
-                    vertical_t &v = grid[ip.x];
+                    vertical_t &v = vertical(ip.x);
                     
                     // Did we already find this point?
                     // (We might have found it as the endpoint of a vertical line.)
@@ -220,8 +226,7 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
                     }
                     
                     // Store the skipped polygon vertices along with this point.
-                    ip.skipped = skipped_points;
-                    skipped_points.clear();
+                    ip.skipped.swap(skipped_points);
                     
                     #ifdef DEBUG_RECTILINEAR
                     printf("NEW POINT at %f,%f\n", unscale(ip.x), unscale(ip.y));
@@ -230,8 +235,8 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
                     #endif
                     
                     // Store the point.
-                    v[ip.y] = ip;
                     ips.push_back(ip);
+                    v[ip.y] = std::move(ip);
                 }
                 
                 // We're now going past the final point, so save it.
@@ -248,8 +253,8 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
                 // We will sweep only from left to right, so we only need to build connections
                 // in this direction.
                 for (Points::const_iterator it = ips.begin(); it != ips.end(); ++it) {
-                    IntersectionPoint &ip   = grid[it->x][it->y];
-                    IntersectionPoint &next = it == ips.end()-1 ? grid[ips.begin()->x][ips.begin()->y] : grid[(it+1)->x][(it+1)->y];
+                    IntersectionPoint &ip   = vertical(it->x)[it->y];
+                    IntersectionPoint &next = it == ips.end()-1 ? vertical(ips.begin()->x)[ips.begin()->y] : vertical((it+1)->x)[(it+1)->y];
                     
                     #ifdef DEBUG_RECTILINEAR
                     printf("CONNECTING %f,%f to %f,%f\n",
@@ -264,16 +269,17 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
                     if (it == ips.begin())
                         ip.skipped.insert(ip.skipped.begin(), skipped_points.begin(), skipped_points.end());
                 
+                    // The skipped points of 'next' are only used by this connection.
                     if (ip.x <= next.x) {
                         // Link 'ip' to 'next' --->
                         if (ip.next.empty()) {
-                            ip.next = next.skipped;
+                            ip.next = std::move(next.skipped);
                             ip.next.push_back(next);
                         }
                     } else if (next.x < ip.x) {
                         // Link 'next' to 'ip' --->
                         if (next.next.empty()) {
-                            next.next = next.skipped;
+                            next.next = std::move(next.skipped);
                             std::reverse(next.next.begin(), next.next.end());
                             next.next.push_back(ip);
                         }
@@ -284,7 +290,7 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
             // Do some cleanup: remove the 'skipped' points we used for building 
             // connections and also remove the middle intersection points.
             for (Points::const_iterator it = ips.begin(); it != ips.end(); ++it) {
-                vertical_t &v = grid[it->x];
+                vertical_t &v = vertical(it->x);
                 IntersectionPoint &ip = v[it->y];
                 ip.skipped.clear();
                 if (ip.type == IntersectionPoint::ipTypeMiddle)
@@ -298,9 +304,10 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
     svg.draw(expolygon);
     
     printf("GRID:\n");
-    for (grid_t::const_iterator it = grid.begin(); it != grid.end(); ++it) {
-        printf("x = %f:\n", unscale(it->first));
-        for (vertical_t::const_iterator v = it->second.begin(); v != it->second.end(); ++v) {
+    for (std::vector<vertical_t>::const_iterator it = grid.begin(); it != grid.end(); ++it) {
+        if (it->empty()) continue;
+        printf("x = %f:\n", unscale(it->begin()->second.x));
+        for (vertical_t::const_iterator v = it->begin(); v != it->end(); ++v) {
             const IntersectionPoint &ip = v->second;
             printf("   y = %f (%s, next = %f,%f, extra = %zu)\n", unscale(v->first),
                 ip.type == IntersectionPoint::ipTypeLower ? "lower"
@@ -322,13 +329,13 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
     const size_t n_polylines_out_old = out->size();
     
     // Loop until we have no more vertical lines available.
-    while (!grid.empty()) {
+    for (std::vector<vertical_t>::iterator first = grid.begin(); first != grid.end(); ) {
         // Get the first x coordinate.
-        vertical_t &v = grid.begin()->second;
+        vertical_t &v = *first;
         
-        // If this x coordinate does not have any y coordinate, remove it.
+        // If this x coordinate does not have any y coordinate, skip it.
         if (v.empty()) {
-            grid.erase(grid.begin());
+            ++first;
             continue;
         }
         
@@ -338,12 +345,14 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
         assert(v.size() % 2 == 0);
         
         // Get the first lower point.
+        // The points are copied without their connection, which is only needed for
+        // the second endpoint of each vertical line.
         vertical_t::iterator it = v.begin();  // minimum x,y
-        IntersectionPoint p = it->second;
+        IntersectionPoint p(it->second.x, it->second.y, it->second.type);
         if (p.type != IntersectionPoint::ipTypeLower) {
             // Degenerate polygon, this shouldn't happen.
             // We used to have an assert here, but let's be tolerant.
-            grid.erase(p.x);
+            v.clear();
             continue;
         }
         
@@ -356,30 +365,32 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
             // Complete the vertical line by finding the corresponding upper or lower point.
             if (p.type == IntersectionPoint::ipTypeUpper) {
                 // find first point along c.x with y < c.y
-                if (it == grid[p.x].begin()) {
+                if (it == vertical(p.x).begin()) {
                     // Degenerate polygon, this shouldn't happen.
                     // We used to have an assert here, but let's be tolerant.
-                    grid.erase(p.x);
+                    vertical(p.x).clear();
                     break;
                 }
                 --it;
             } else {
                 // find first point along c.x with y > c.y
                 ++it;
-                if (it == grid[p.x].end()) {
+                if (it == vertical(p.x).end()) {
                     // Degenerate polygon, this shouldn't happen.
                     // We used to have an assert here, but let's be tolerant.
-                    grid.erase(p.x);
+                    vertical(p.x).clear();
                     break;
                 }
             }
             
             // Append the point to our polyline.
-            IntersectionPoint b = it->second;
+            // Its connection is taken over since the point is removed below.
+            IntersectionPoint b(it->second.x, it->second.y, it->second.type);
+            b.next.swap(it->second.next);
             if (b.type == p.type) {
                 // Degenerate polygon, this shouldn't happen.
                 // We used to have an assert here, but let's be tolerant.
-                grid.erase(p.x);
+                vertical(p.x).clear();
                 break;
             }
             polyline.append(b);
@@ -387,10 +398,9 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
 
             // Remove the two endpoints of this vertical line from the grid.
             {
-                vertical_t &v = grid[p.x];
+                vertical_t &v = vertical(p.x);
                 v.erase(p.y);
                 v.erase(it);
-                if (v.empty()) grid.erase(p.x);
             }
             // Do we have a connection starting from here?
             // If not, stop the polyline.
@@ -415,8 +425,7 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
             }
             
             // Is the final point still available?
-            if (grid.count(b.next.back().x) == 0
-                || grid[b.next.back().x].count(b.next.back().y) == 0)
+            if (vertical(b.next.back().x).count(b.next.back().y) == 0)
                 // We already used this point or we might have removed this
                 // point while building the grid because it's collinear (middle); in either
                 // cases the connection line from the previous one is legit and worth having.
@@ -424,15 +433,15 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
             
             // Retrieve the intersection point. The next loop will find the correspondent
             // endpoint of the vertical line.
-            it = grid[ b.next.back().x ].find(b.next.back().y);
-            p  = it->second;
+            it = vertical(b.next.back().x).find(b.next.back().y);
+            p  = IntersectionPoint(it->second.x, it->second.y, it->second.type);
             
             // If the connection brought us to another x coordinate, we expect the point 
             // type to be the same.
             if (!(p.type == b.type && p.x > b.x) && !(p.type != b.type && p.x == b.x)) {
                 // Degenerate polygon, this shouldn't happen.
                 // We used to have an assert here, but let's be tolerant.
-                grid.erase(p.x);
+                vertical(p.x).clear();
                 break;
             }
         }
@@ -445,7 +454,16 @@ FillRectilinear::_fill_single_direction(ExPolygon expolygon,
     // paths must be rotated back
     for (Polylines::iterator it = out->begin() + n_polylines_out_old;
         it != out->end(); ++it)
-        it->rotate(direction.first);
+        it->rotate(cos_angle, sin_angle);
+}
+
+void
+FillRectilinear::_remove_vertical_collinear_points(ExPolygon* expolygon)
+{
+    // Remove almost collinear points (vertical ones might break the scanline algorithm
+    // because of rounding). This is done before the rotation, so the patterns made of
+    // several directions do it once for all of them.
+    expolygon->remove_vertical_collinear_points(1);
 }
 
 void FillRectilinear::_fill_surface_single(
@@ -454,6 +472,7 @@ void FillRectilinear::_fill_surface_single(
     ExPolygon                       &expolygon,
     Polylines*                      out)
 {
+    this->_remove_vertical_collinear_points(&expolygon);
     this->_fill_single_direction(expolygon, direction, 0, out);
 }
 
@@ -463,6 +482,7 @@ void FillGrid::_fill_surface_single(
     ExPolygon                       &expolygon,
     Polylines*                      out)
 {
+    this->_remove_vertical_collinear_points(&expolygon);
     FillGrid fill2 = *this;
     fill2.density /= 2.;
     
@@ -479,6 +499,7 @@ void FillTriangles::_fill_surface_single(
     ExPolygon                       &expolygon,
     Polylines*                      out)
 {
+    this->_remove_vertical_collinear_points(&expolygon);
     FillTriangles fill2 = *this;
     fill2.density /= 3.;
     direction_t direction2 = direction;
@@ -499,6 +520,7 @@ void FillStars::_fill_surface_single(
     ExPolygon                       &expolygon,
     Polylines*                      out)
 {
+    this->_remove_vertical_collinear_points(&expolygon);
     FillStars fill2 = *this;
     fill2.density /= 3.;
     direction_t direction2 = direction;
@@ -520,6 +542,7 @@ void FillCubic::_fill_surface_single(
     ExPolygon                       &expolygon,
     Polylines*                      out)
 {
+    this->_remove_vertical_collinear_points(&expolygon);
     FillCubic fill2 = *this;
     fill2.density /= 3.;
     direction_t direction2 = direction;
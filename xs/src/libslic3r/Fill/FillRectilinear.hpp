@@ -21,8 +21,11 @@ protected:
 	    ExPolygon                       &expolygon, 
 	    Polylines*                      polylines_out);
     
+	// Fills the expolygon with lines along the direction. Its almost vertical collinear
+	// points must have been removed by _remove_vertical_collinear_points().
 	void _fill_single_direction(ExPolygon expolygon, const direction_t &direction,
 	    coord_t x_shift, Polylines* out);
+	static void _remove_vertical_collinear_points(ExPolygon* expolygon);
 };
 
 class FillAlignedRectilinear : public FillRectilinear
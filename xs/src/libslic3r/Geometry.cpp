@@ -9,10 +9,10 @@
 #include <cmath>
 #include <list>
 #include <map>
-#include <set>
 #include <utility>
 #include <stack>
 #include <vector>
+#include <boost/thread/tss.hpp>
 
 #ifdef SLIC3R_DEBUG
 #include "SVG.hpp"
@@ -480,17 +480,33 @@ arrange(size_t total_parts, const Pointf &part_size, coordf_t dist, const Boundi
     return true;
 }
 
+/// Voronoi builder and diagram reused by all the medial axes computed by a thread
+/// (thin walls and gap fill of every layer), so that their storage is allocated once.
+struct MedialAxisVoronoi {
+    boost::polygon::default_voronoi_builder builder;
+    voronoi_diagram<double> vd;
+};
+static boost::thread_specific_ptr<MedialAxisVoronoi> thread_voronoi_ptr;
+
 void
 MedialAxis::build(ThickPolylines* polylines)
 {
-    construct_voronoi(this->lines.begin(), this->lines.end(), &this->vd);
+    if (thread_voronoi_ptr.get() == NULL)
+        thread_voronoi_ptr.reset(new MedialAxisVoronoi());
+    MedialAxisVoronoi &voronoi = *thread_voronoi_ptr;
+    voronoi.builder.clear();
+    voronoi.vd.clear();
+    boost::polygon::insert(this->lines.begin(), this->lines.end(), &voronoi.builder);
+    voronoi.builder.construct(&voronoi.vd);
+    this->vd = &voronoi.vd;
+    if (this->vd->edges().empty()) return;
     
     /*
     // DEBUG: dump all Voronoi edges
     {
         SVG svg("voronoi.svg");
         svg.draw(*this->expolygon);
-        for (VD::const_edge_iterator edge = this->vd.edges().begin(); edge != this->vd.edges().end(); ++edge) {
+        for (VD::const_edge_iterator edge = this->vd->edges().begin(); edge != this->vd->edges().end(); ++edge) {
             if (edge->is_infinite()) continue;
             
             ThickPolyline polyline;
@@ -508,41 +524,45 @@ MedialAxis::build(ThickPolylines* polylines)
     */
     
     // collect valid edges (i.e. prune those not belonging to MAT)
-    // note: this keeps twins, so it inserts twice the number of the valid edges
-    this->valid_edges.clear();
+    // note: this keeps twins, so it marks twice the number of the valid edges
+    const size_t num_edges = this->vd->edges().size();
+    this->valid_edges.assign(num_edges, false);
+    this->thickness.resize(num_edges);
     {
-        std::set<const VD::edge_type*> seen_edges;
-        for (VD::const_edge_iterator edge = this->vd.edges().begin(); edge != this->vd.edges().end(); ++edge) {
+        std::vector<bool> seen_edges(num_edges, false);
+        for (VD::const_edge_iterator edge = this->vd->edges().begin(); edge != this->vd->edges().end(); ++edge) {
             // if we only process segments representing closed loops, none if the
             // infinite edges (if any) would be part of our MAT anyway
             if (edge->is_secondary() || edge->is_infinite()) continue;
         
             // don't re-validate twins
-            if (seen_edges.find(&*edge) != seen_edges.end()) continue;  // TODO: is this needed?
-            seen_edges.insert(&*edge);
-            seen_edges.insert(edge->twin());
+            const size_t i = this->edge_index(&*edge);
+            if (seen_edges[i]) continue;  // TODO: is this needed?
+            seen_edges[i] = true;
+            seen_edges[this->edge_index(edge->twin())] = true;
             
             if (!this->validate_edge(&*edge)) continue;
-            this->valid_edges.insert(&*edge);
-            this->valid_edges.insert(edge->twin());
+            this->valid_edges[i] = true;
+            this->valid_edges[this->edge_index(edge->twin())] = true;
         }
     }
     this->edges = this->valid_edges;
     
-    // iterate through the valid edges to build polylines
-    while (!this->edges.empty()) {
-        const VD::edge_type* edge = *this->edges.begin();
+    // iterate through the valid edges to build polylines, in the order of the diagram
+    for (size_t i = 0; i < num_edges; ++i) {
+        if (!this->edges[i]) continue;
+        const VD::edge_type* edge = &this->vd->edges()[i];
         
         // start a polyline
         ThickPolyline polyline;
         polyline.points.push_back(Point( edge->vertex0()->x(), edge->vertex0()->y() ));
         polyline.points.push_back(Point( edge->vertex1()->x(), edge->vertex1()->y() ));
-        polyline.width.push_back(this->thickness[edge].first);
-        polyline.width.push_back(this->thickness[edge].second);
+        polyline.width.push_back(this->thickness[i].first);
+        polyline.width.push_back(this->thickness[i].second);
         
         // remove this edge and its twin from the available edges
-        (void)this->edges.erase(edge);
-        (void)this->edges.erase(edge->twin());
+        this->edges[i] = false;
+        this->edges[this->edge_index(edge->twin())] = false;
         
         // get next points
         this->process_edge_neighbors(edge, &polyline);
@@ -590,22 +610,23 @@ MedialAxis::process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* pol
         std::vector<const VD::edge_type*> neighbors;
         for (const VD::edge_type* neighbor = twin->rot_next(); neighbor != twin;
             neighbor = neighbor->rot_next()) {
-            if (this->valid_edges.count(neighbor) > 0) neighbors.push_back(neighbor);
+            if (this->valid_edges[this->edge_index(neighbor)]) neighbors.push_back(neighbor);
         }
     
         // if we have a single neighbor then we can continue recursively
         if (neighbors.size() == 1) {
             const VD::edge_type* neighbor = neighbors.front();
+            const size_t i = this->edge_index(neighbor);
             
             // break if this is a closed loop
-            if (this->edges.count(neighbor) == 0) return;
+            if (!this->edges[i]) return;
             
             Point new_point(neighbor->vertex1()->x(), neighbor->vertex1()->y());
             polyline->points.push_back(new_point);
-            polyline->width.push_back(this->thickness[neighbor].first);
-            polyline->width.push_back(this->thickness[neighbor].second);
-            (void)this->edges.erase(neighbor);
-            (void)this->edges.erase(neighbor->twin());
+            polyline->width.push_back(this->thickness[i].first);
+            polyline->width.push_back(this->thickness[i].second);
+            this->edges[i] = false;
+            this->edges[this->edge_index(neighbor->twin())] = false;
             edge = neighbor;
         } else if (neighbors.size() == 0) {
             polyline->endpoints.second = true;
@@ -633,18 +654,6 @@ MedialAxis::validate_edge(const VD::edge_type* edge)
         Point( edge->vertex1()->x(), edge->vertex1()->y() )
     );
     
-    // discard edge if it lies outside the supplied shape
-    // this could maybe be optimized (checking inclusion of the endpoints
-    // might give false positives as they might belong to the contour itself)
-    if (this->expolygon != NULL) {
-        if (line.a.coincides_with(line.b)) {
-            // in this case, contains(line) returns a false positive
-            if (!this->expolygon->contains(line.a)) return false;
-        } else {
-            if (!this->expolygon->contains(line)) return false;
-        }
-    }
-    
     // retrieve the original line segments which generated the edge we're checking
     const VD::cell_type* cell_l = edge->cell();
     const VD::cell_type* cell_r = edge->twin()->cell();
@@ -714,8 +723,21 @@ MedialAxis::validate_edge(const VD::edge_type* edge)
     if (w0 > this->max_width && w1 > this->max_width)
         return false;
     
-    this->thickness[edge]         = std::make_pair(w0, w1);
-    this->thickness[edge->twin()] = std::make_pair(w1, w0);
+    // discard edge if it lies outside the supplied shape
+    // this could maybe be optimized (checking inclusion of the endpoints
+    // might give false positives as they might belong to the contour itself)
+    // the inclusion test runs Clipper, so it's done after the cheaper width tests
+    if (this->expolygon != NULL) {
+        if (line.a.coincides_with(line.b)) {
+            // in this case, contains(line) returns a false positive
+            if (!this->expolygon->contains(line.a)) return false;
+        } else {
+            if (!this->expolygon->contains(line)) return false;
+        }
+    }
+    
+    this->thickness[this->edge_index(edge)]         = std::make_pair(w0, w1);
+    this->thickness[this->edge_index(edge->twin())] = std::make_pair(w1, w0);
     
     return true;
 }
@@ -39,15 +39,17 @@ class MedialAxis {
     double max_width;
     double min_width;
     MedialAxis(double _max_width, double _min_width, const ExPolygon* _expolygon = NULL)
-        : expolygon(_expolygon), max_width(_max_width), min_width(_min_width) {};
+        : expolygon(_expolygon), max_width(_max_width), min_width(_min_width), vd(NULL) {};
     void build(ThickPolylines* polylines);
     void build(Polylines* polylines);
     
     private:
     typedef voronoi_diagram<double> VD;
-    VD vd;
-    std::set<const VD::edge_type*> edges, valid_edges;
-    std::map<const VD::edge_type*, std::pair<coordf_t,coordf_t> > thickness;
+    const VD* vd;   // diagram owned by the thread computing the medial axis, valid during build()
+    // flags and thicknesses of the Voronoi edges, indexed by their position in vd->edges()
+    std::vector<bool> edges, valid_edges;
+    std::vector< std::pair<coordf_t,coordf_t> > thickness;
+    size_t edge_index(const VD::edge_type* edge) const { return edge - &this->vd->edges().front(); };
     void process_edge_neighbors(const VD::edge_type* edge, ThickPolyline* polyline);
     bool validate_edge(const VD::edge_type* edge);
     const Line& retrieve_segment(const VD::cell_type* cell) const;
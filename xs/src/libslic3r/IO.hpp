@@ -30,7 +30,7 @@ class AMF
 {
     public:
     static bool read(std::string input_file, Model* model);
-    static bool write(Model& model, std::string output_file);
+    static bool write(Model& model, std::string output_file, bool compressed = false);
 };
 
 class POV
@@ -46,6 +46,15 @@ class TMF
     static bool write(Model& model, std::string output_file);
 };
 
+/// Binary dump of a model, used as a cache to reload meshes without parsing and repairing them again.
+/// The format stores the in-memory mesh layout and is only readable by a build with the same layout.
+class Snapshot
+{
+    public:
+    static bool read(std::string input_file, Model* model);
+    static bool write(Model& model, std::string output_file);
+};
+
 } }
 
 #endif
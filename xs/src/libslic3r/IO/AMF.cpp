@@ -1,9 +1,15 @@
 #include "../IO.hpp"
+#include "../Zip/ZipArchive.hpp"
+#include "NumberBuffer.hpp"
 #include <iostream>
 #include <fstream>
 #include <string.h>
 #include <map>
+#include <sstream>
 #include <string>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem/path.hpp>
 #include <boost/move/move.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/iostream.hpp>
@@ -53,6 +59,21 @@ struct AMFParserContext
         ctx->characters(s, len);    
     }
 
+    /// Feed a chunk of a compressed AMF document to the parser.
+    /// Used as the miniz callback receiving the inflated entry.
+    static size_t parse_chunk(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n)
+    {
+        AMFParserContext *ctx = (AMFParserContext*)pOpaque;
+        if (XML_Parse(ctx->m_parser, (const char*)pBuf, (int)n, 0) == XML_STATUS_ERROR) {
+            printf("AMF parser: Parse error at line %lu:\n%s\n",
+                  XML_GetCurrentLineNumber(ctx->m_parser),
+                  XML_ErrorString(XML_GetErrorCode(ctx->m_parser)));
+            // Returning less than n stops the extraction.
+            return 0;
+        }
+        return n;
+    }
+
     static const char* get_attribute(const char **atts, const char *id) {
         if (atts == NULL)
             return NULL;
@@ -129,10 +150,16 @@ struct AMFParserContext
     std::map<std::string, Object> m_object_instances_map;
     // Vertices parsed for the current m_object.
     std::vector<float>       m_object_vertices;
+    // Coordinates of the vertices of the current m_object, converted at the end of amf/object/mesh/vertices.
+    NumberBuffer             m_vertices_text;
     // Current volume allocated for an amf/object/mesh/volume subtree.
     ModelVolume             *m_volume;
     // Faces collected for the current m_volume.
     std::vector<int>         m_volume_facets;
+    // Vertex indices of the faces of the current m_volume, converted when the volume is closed.
+    NumberBuffer             m_facets_text;
+    // Volumes to be repaired in parallel once the whole document is read.
+    std::vector<ModelVolume*> m_volumes;
     // Current material allocated for an amf/metadata subtree.
     ModelMaterial           *m_material;
     // Current instance allocated for an amf/constellation/instance subtree.
@@ -332,10 +359,10 @@ void AMFParserContext::endElement(const char *name)
     // Object vertices:
     case NODE_TYPE_VERTEX:
         assert(m_object);
-        // Parse the vertex data
-        m_object_vertices.push_back(atof(m_value[0].c_str()));
-        m_object_vertices.push_back(atof(m_value[1].c_str()));
-        m_object_vertices.push_back(atof(m_value[2].c_str()));
+        // Collect the vertex data
+        m_vertices_text.push(m_value[0]);
+        m_vertices_text.push(m_value[1]);
+        m_vertices_text.push(m_value[2]);
         m_value[0].clear();
         m_value[1].clear();
         m_value[2].clear();
@@ -344,18 +371,27 @@ void AMFParserContext::endElement(const char *name)
     // Faces of the current volume:
     case NODE_TYPE_TRIANGLE:
         assert(m_object && m_volume);
-        m_volume_facets.push_back(atoi(m_value[0].c_str()));
-        m_volume_facets.push_back(atoi(m_value[1].c_str()));
-        m_volume_facets.push_back(atoi(m_value[2].c_str()));
+        m_facets_text.push(m_value[0]);
+        m_facets_text.push(m_value[1]);
+        m_facets_text.push(m_value[2]);
         m_value[0].clear();
         m_value[1].clear();
         m_value[2].clear();
         break;
 
+    // Parse the vertex data of the current object.
+    case NODE_TYPE_VERTICES:
+        assert(m_object);
+        m_vertices_text.to_floats(&m_object_vertices);
+        m_vertices_text.clear();
+        break;
+
     // Closing the current volume. Create an STL from m_volume_facets pointing to m_object_vertices.
     case NODE_TYPE_VOLUME:
     {
 		assert(m_object && m_volume);
+        m_facets_text.to_ints(&m_volume_facets);
+        m_facets_text.clear();
         stl_file &stl = m_volume->mesh.stl;
         stl.stats.type = inmemory;
         stl.stats.number_of_facets = int(m_volume_facets.size() / 3);
@@ -367,7 +403,7 @@ void AMFParserContext::endElement(const char *name)
                 memcpy(&facet.vertex[v].x, &m_object_vertices[m_volume_facets[i ++] * 3], 3 * sizeof(float));
         }
         stl_get_size(&stl);
-        m_volume->mesh.repair();
+        m_volumes.push_back(m_volume);
         m_volume_facets.clear();
         m_volume = NULL;
         break;
@@ -429,8 +465,19 @@ void AMFParserContext::endElement(const char *name)
     m_path.pop_back();
 }
 
+static void repair_volume(ModelVolume* volume)
+{
+    volume->mesh.repair();
+}
+
 void AMFParserContext::endDocument()
 {
+    // The meshes are independent, repair them in parallel.
+    std::queue<ModelVolume*> volumes;
+    for (ModelVolume* volume : m_volumes)
+        volumes.push(volume);
+    parallelize<ModelVolume*>(volumes, boost::bind(&repair_volume, _1));
+
     for (const auto &object : m_object_instances_map) {
         if (object.second.idx == -1) {
             printf("Undefined object %s referenced in constellation\n", object.first.c_str());
@@ -456,9 +503,10 @@ AMF::read(std::string input_file, Model* model)
         return false;
     }
     
-    boost::nowide::ifstream fin(input_file, std::ios::in);
+    boost::nowide::ifstream fin(input_file, std::ios::in | std::ios::binary);
     if (!fin.is_open()) {
         boost::nowide::cerr << "Cannot open file: " << input_file << std::endl;
+        XML_ParserFree(parser);
         return false;
     }
 
@@ -467,74 +515,101 @@ AMF::read(std::string input_file, Model* model)
     XML_SetElementHandler(parser, AMFParserContext::startElement, AMFParserContext::endElement);
     XML_SetCharacterDataHandler(parser, AMFParserContext::characters);
 
-    char buff[8192];
+    // A zip compressed AMF starts with the local file header signature.
+    char signature[4] = { 0, 0, 0, 0 };
+    fin.read(signature, sizeof(signature));
+    const bool compressed = fin.gcount() == 4 && memcmp(signature, "PK\x03\x04", 4) == 0;
+    fin.clear();
+    fin.seekg(0);
+
     bool result = false;
-    while (!fin.eof()) {
-		fin.read(buff, sizeof(buff));
-        if (fin.bad()) {
-            printf("AMF parser: Read error\n");
-            break;
-        }
-        if (XML_Parse(parser, buff, fin.gcount(), fin.eof()) == XML_STATUS_ERROR) {
-            printf("AMF parser: Parse error at line %lu:\n%s\n",
-                  XML_GetCurrentLineNumber(parser),
-                  XML_ErrorString(XML_GetErrorCode(parser)));
-            break;
+    if (compressed) {
+        fin.close();
+        // Feed the parser with the inflated chunks of the first .amf entry (or of the first entry).
+        ZipArchive zip_archive(input_file, 'R');
+        std::vector<std::string> entries = zip_archive.entries();
+        std::vector<std::string>::const_iterator entry = entries.begin();
+        for (std::vector<std::string>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+            if (boost::algorithm::iends_with(*it, ".amf")) {
+                entry = it;
+                break;
+            }
+        if (entry != entries.end()
+            && zip_archive.extract_entry_to_callback(*entry, AMFParserContext::parse_chunk, &ctx)) {
+            if (XML_Parse(parser, nullptr, 0, 1) == XML_STATUS_ERROR) {
+                printf("AMF parser: Parse error at line %lu:\n%s\n",
+                      XML_GetCurrentLineNumber(parser),
+                      XML_ErrorString(XML_GetErrorCode(parser)));
+            } else {
+                result = true;
+            }
         }
-        if (fin.eof()) {
-            result = true;
-            break;
+    } else {
+        char buff[8192];
+        while (!fin.eof()) {
+            fin.read(buff, sizeof(buff));
+            if (fin.bad()) {
+                printf("AMF parser: Read error\n");
+                break;
+            }
+            if (XML_Parse(parser, buff, fin.gcount(), fin.eof()) == XML_STATUS_ERROR) {
+                printf("AMF parser: Parse error at line %lu:\n%s\n",
+                      XML_GetCurrentLineNumber(parser),
+                      XML_ErrorString(XML_GetErrorCode(parser)));
+                break;
+            }
+            if (fin.eof()) {
+                result = true;
+                break;
+            }
         }
+        fin.close();
     }
 
     XML_ParserFree(parser);
-    fin.close();
 
     if (result)
         ctx.endDocument();
     return result;
 }
 
-bool
-AMF::write(Model& model, std::string output_file)
+static void
+write_amf(Model& model, std::ostream &file)
 {
     using namespace std;
     
-    boost::nowide::ofstream file;
-    file.open(output_file, ios::out | ios::trunc);
-    
-    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl
-         << "<amf unit=\"millimeter\">" << endl
-         << "  <metadata type=\"cad\">Slic3r " << SLIC3R_VERSION << "</metadata>" << endl;
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         << "<amf unit=\"millimeter\">\n"
+         << "  <metadata type=\"cad\">Slic3r " << SLIC3R_VERSION << "</metadata>\n";
     
     for (const auto &material : model.materials) {
         if (material.first.empty())
             continue;
         // note that material-id must never be 0 since it's reserved by the AMF spec
-        file << "  <material id=\"" << material.first << "\">" << endl;
+        file << "  <material id=\"" << material.first << "\">\n";
         for (const auto &attr : material.second->attributes)
-             file << "    <metadata type=\"" << attr.first << "\">" << attr.second << "</metadata>" << endl;
+             file << "    <metadata type=\"" << attr.first << "\">" << attr.second << "</metadata>\n";
         for (const std::string &key : material.second->config.keys())
              file << "    <metadata type=\"slic3r." << key << "\">"
-                  << material.second->config.serialize(key) << "</metadata>" << endl;
-        file << "  </material>" << endl;
+                  << material.second->config.serialize(key) << "</metadata>\n";
+        file << "  </material>\n";
     }
     
     ostringstream instances;
     for (size_t object_id = 0; object_id < model.objects.size(); ++object_id) {
         ModelObject *object = model.objects[object_id];
-        file << "  <object id=\"" << object_id << "\">" << endl;
+        file << "  <object id=\"" << object_id << "\">\n";
         
         for (const std::string &key : object->config.keys())
             file << "    <metadata type=\"slic3r." << key << "\">"
-                 << object->config.serialize(key) << "</metadata>" << endl;
+                 << object->config.serialize(key) << "</metadata>\n";
         
         if (!object->name.empty())
-            file << "    <metadata type=\"name\">" << object->name << "</metadata>" << endl;
+            file << "    <metadata type=\"name\">" << object->name << "</metadata>\n";
 
         //FIXME: Store the layer height ranges (ModelObject::layer_height_ranges)
-        file << "    <mesh>" << endl;
-        file << "      <vertices>" << endl;
+        file << "    <mesh>\n";
+        file << "      <vertices>\n";
         
         std::vector<size_t> vertices_offsets;
         size_t num_vertices = 0;
@@ -550,70 +625,99 @@ AMF::write(Model& model, std::string output_file)
                 // thus any additional part added will not align with the others.
                 // In order to do this we compensate for this translation in the instance placement
                 // below.
-                file << "         <vertex>" << endl
-                     << "           <coordinates>" << endl
-                     << "             <x>" << (stl.v_shared[i].x - object->origin_translation.x) << "</x>" << endl
-                     << "             <y>" << (stl.v_shared[i].y - object->origin_translation.y) << "</y>" << endl
-                     << "             <z>" << (stl.v_shared[i].z - object->origin_translation.z) << "</z>" << endl
-                     << "           </coordinates>" << endl
-                     << "         </vertex>" << endl;
+                file << "         <vertex>\n"
+                     << "           <coordinates>\n"
+                     << "             <x>" << (stl.v_shared[i].x - object->origin_translation.x) << "</x>\n"
+                     << "             <y>" << (stl.v_shared[i].y - object->origin_translation.y) << "</y>\n"
+                     << "             <z>" << (stl.v_shared[i].z - object->origin_translation.z) << "</z>\n"
+                     << "           </coordinates>\n"
+                     << "         </vertex>\n";
             
             num_vertices += stl.stats.shared_vertices;
         }
-        file << "      </vertices>" << endl;
+        file << "      </vertices>\n";
         
         for (size_t i_volume = 0; i_volume < object->volumes.size(); ++i_volume) {
             ModelVolume *volume = object->volumes[i_volume];
             int vertices_offset = vertices_offsets[i_volume];
             
             if (volume->material_id().empty())
-                file << "      <volume>" << endl;
+                file << "      <volume>\n";
             else
-                file << "      <volume materialid=\"" << volume->material_id() << "\">" << endl;
+                file << "      <volume materialid=\"" << volume->material_id() << "\">\n";
             
             for (const std::string &key : volume->config.keys())
                 file << "        <metadata type=\"slic3r." << key << "\">"
-                     << volume->config.serialize(key) << "</metadata>" << endl;
+                     << volume->config.serialize(key) << "</metadata>\n";
             
             if (!volume->name.empty())
-                file << "        <metadata type=\"name\">" << volume->name << "</metadata>" << endl;
+                file << "        <metadata type=\"name\">" << volume->name << "</metadata>\n";
             
             if (volume->modifier)
-                file << "        <metadata type=\"slic3r.modifier\">1</metadata>" << endl;
+                file << "        <metadata type=\"slic3r.modifier\">1</metadata>\n";
             
             for (int i = 0; i < volume->mesh.stl.stats.number_of_facets; ++i) {
-                file << "        <triangle>" << endl;
+                file << "        <triangle>\n";
                 for (int j = 0; j < 3; ++ j)
                     file << "          <v" << (j+1) << ">"
                          << (volume->mesh.stl.v_indices[i].vertex[j] + vertices_offset)
-                         << "</v" << (j+1) << ">" << endl;
-                file << "        </triangle>" << endl;
+                         << "</v" << (j+1) << ">\n";
+                file << "        </triangle>\n";
             }
-            file << "      </volume>" << endl;
+            file << "      </volume>\n";
         }
-        file << "    </mesh>" << endl;
-        file << "  </object>" << endl;
+        file << "    </mesh>\n";
+        file << "  </object>\n";
         
         for (const ModelInstance* instance : object->instances)
             instances
-                << "    <instance objectid=\"" << object_id << "\">" << endl
-                << "      <deltax>" << instance->offset.x + object->origin_translation.x << "</deltax>" << endl
-                << "      <deltay>" << instance->offset.y + object->origin_translation.y << "</deltay>" << endl
-                << "      <rz>" << instance->rotation << "</rz>" << endl
-                << "      <scale>" << instance->scaling_factor << "</scale>" << endl
-                << "    </instance>" << endl;
+                << "    <instance objectid=\"" << object_id << "\">\n"
+                << "      <deltax>" << instance->offset.x + object->origin_translation.x << "</deltax>\n"
+                << "      <deltay>" << instance->offset.y + object->origin_translation.y << "</deltay>\n"
+                << "      <rz>" << instance->rotation << "</rz>\n"
+                << "      <scale>" << instance->scaling_factor << "</scale>\n"
+                << "    </instance>\n";
     }
     
     std::string instances_str = instances.str();
     if (!instances_str.empty())
-        file << "  <constellation id=\"1\">" << endl
+        file << "  <constellation id=\"1\">\n"
              << instances_str
-             << "  </constellation>" << endl;
+             << "  </constellation>\n";
     
-    file << "</amf>" << endl;
+    file << "</amf>\n";
+}
+
+bool
+AMF::write(Model& model, std::string output_file, bool compressed)
+{
+    if (compressed) {
+        // Write the document in memory and store it as the only entry of a zip archive,
+        // named after the output file.
+        std::ostringstream data;
+        write_amf(model, data);
+        std::string entry_path = boost::filesystem::path(output_file).filename().string();
+        if (boost::algorithm::iends_with(entry_path, ".zip"))
+            entry_path.erase(entry_path.size() - 4);
+        if (!boost::algorithm::iends_with(entry_path, ".amf"))
+            entry_path += ".amf";
+        
+        ZipArchive zip_archive(output_file, 'W');
+        if (!zip_archive.z_stats())
+            return false;
+        const std::string contents = data.str();
+        if (!zip_archive.add_entry_from_buffer(entry_path, contents.data(), contents.size()))
+            return false;
+        return zip_archive.finalize() != 0;
+    }
     
+    boost::nowide::ofstream file;
+    file.open(output_file, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    write_amf(model, file);
     file.close();
-    return true;
+    return !file.fail();
 }
 
 } }
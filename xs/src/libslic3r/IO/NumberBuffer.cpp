@@ -0,0 +1,133 @@
+#include "NumberBuffer.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <boost/bind.hpp>
+
+namespace Slic3r { namespace IO {
+
+double
+parse_double(const char *str)
+{
+    return parse_double(str, NULL);
+}
+
+double
+parse_double(const char *str, const char **end)
+{
+    // Powers of ten exactly representable by a double.
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *p = str;
+    while (isspace((unsigned char)*p)) ++p;
+    bool negative = false;
+    if (*p == '-' || *p == '+') negative = *(p++) == '-';
+
+    unsigned long long mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+    for (; *p >= '0' && *p <= '9'; ++p, has_digits = true) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa != 0) ++significant_digits;
+    }
+    if (*p == '.') {
+        for (++p; *p >= '0' && *p <= '9'; ++p, has_digits = true) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) ++significant_digits;
+            --exponent;
+        }
+    }
+    // No digits (inf, nan, empty string) or hexadecimal notation.
+    if (!has_digits || *p == 'x' || *p == 'X')
+        return strtod(str, (char**)end);
+    if (*p == 'e' || *p == 'E') {
+        const char *e = p + 1;
+        bool negative_exponent = false;
+        if (*e == '-' || *e == '+') negative_exponent = *(e++) == '-';
+        if (*e < '0' || *e > '9')
+            return strtod(str, (char**)end);
+        int e10 = 0;
+        for (; *e >= '0' && *e <= '9'; ++e)
+            if (e10 < 10000)
+                e10 = e10 * 10 + (*e - '0');
+        exponent += negative_exponent ? -e10 : e10;
+        p = e;
+    }
+
+    // The mantissa and the power of ten are exact doubles, their product or quotient
+    // is correctly rounded. Otherwise leave the conversion to strtod().
+    if (significant_digits > 19 || mantissa > (1ULL << 53) || exponent < -22 || exponent > 22)
+        return strtod(str, (char**)end);
+    if (end != NULL)
+        *end = p;
+    double value = double(mantissa);
+    value = (exponent < 0) ? value / pow10[-exponent] : value * pow10[exponent];
+    return negative ? -value : value;
+}
+
+void
+NumberBuffer::clear()
+{
+    this->text.clear();
+    this->chunks.clear();
+    this->count = 0;
+}
+
+void
+NumberBuffer::to_floats(std::vector<float>* values) const
+{
+    this->parse(values);
+}
+
+void
+NumberBuffer::to_ints(std::vector<int>* values) const
+{
+    this->parse(values);
+}
+
+template <class T> void
+NumberBuffer::parse(std::vector<T>* values) const
+{
+    if (this->count == 0) return;
+    const size_t offset = values->size();
+    values->resize(offset + this->count);
+    T* out = values->data() + offset;
+    if (this->chunks.size() == 1) {
+        this->parse_chunk(out, 0);
+    } else {
+        parallelize<size_t>(
+            0,
+            this->chunks.size() - 1,
+            boost::bind(&NumberBuffer::parse_chunk<T>, this, out, _1)
+        );
+    }
+}
+
+static inline void
+parse_value(const char *str, float* value)
+{
+    *value = float(parse_double(str));
+}
+
+static inline void
+parse_value(const char *str, int* value)
+{
+    *value = atoi(str);
+}
+
+template <class T> void
+NumberBuffer::parse_chunk(T* values, size_t chunk) const
+{
+    const size_t first = chunk * NumberBuffer::chunk_size;
+    const size_t last  = std::min(first + NumberBuffer::chunk_size, this->count);
+    const char *str = this->text.c_str() + this->chunks[chunk];
+    for (size_t i = first; i < last; ++i) {
+        parse_value(str, values + i);
+        str += strlen(str) + 1;
+    }
+}
+
+} }
@@ -0,0 +1,60 @@
+#ifndef SLIC3R_IO_NUMBERBUFFER_H
+#define SLIC3R_IO_NUMBERBUFFER_H
+
+#include "../libslic3r.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Slic3r { namespace IO {
+
+/// Parse a decimal floating point number, with the semantics of atof().
+/// Numbers with up to 19 significant digits and a small exponent are converted
+/// exactly without going through strtod(), everything else falls back to it.
+double parse_double(const char *str);
+/// Same as above, storing the end of the parsed number into end, like strtod().
+double parse_double(const char *str, const char **end);
+
+/// Text of the numeric values of a mesh (vertex coordinates, triangle indices)
+/// collected while scanning an XML document. Once a mesh element is complete, the values
+/// are converted to numbers in parallel chunks instead of one by one in the XML callbacks.
+class NumberBuffer
+{
+public:
+    NumberBuffer(): count(0) {};
+
+    /// Append a value. The value may be surrounded by white space.
+    void push(const char *value, size_t len) {
+        if (this->count % NumberBuffer::chunk_size == 0)
+            this->chunks.push_back(this->text.size());
+        this->text.append(value, len);
+        this->text.push_back('\0');
+        ++ this->count;
+    };
+    void push(const char *value) { this->push(value, strlen(value)); };
+    void push(const std::string &value) { this->push(value.data(), value.size()); };
+
+    /// Number of values collected.
+    size_t size() const { return this->count; };
+    bool empty() const { return this->count == 0; };
+    void clear();
+
+    /// Convert the collected values, appending them to values.
+    void to_floats(std::vector<float>* values) const;
+    void to_ints(std::vector<int>* values) const;
+
+private:
+    /// Number of values converted by a single task.
+    static const size_t chunk_size = 65536;
+
+    std::string text; ///< The values separated by '\0'.
+    std::vector<size_t> chunks; ///< Offsets of the first value of each chunk in text.
+    size_t count; ///< Number of values in text.
+
+    template <class T> void parse(std::vector<T>* values) const;
+    template <class T> void parse_chunk(T* values, size_t chunk) const;
+};
+
+} }
+
+#endif //SLIC3R_IO_NUMBERBUFFER_H
@@ -0,0 +1,327 @@
+#include "../IO.hpp"
+#include "NumberBuffer.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <boost/thread.hpp>
+
+namespace Slic3r { namespace IO {
+
+/// Streaming reader of the geometry of an OBJ file.
+/// Only the vertex positions and the faces are parsed, the polygons are triangulated as a fan
+/// and written straight into the admesh storage of the volumes. The file is read in blocks,
+/// each block is split at line boundaries into chunks parsed in parallel, then the chunks
+/// are appended to the model in order.
+/// Each group or object of the file ('g' and 'o' lines) becomes a volume,
+/// and the vertex indices are global to the file.
+class OBJReader
+{
+public:
+    OBJReader(ModelObject* object) : object(object), volume(NULL) {};
+    void read(std::istream &in);
+
+private:
+    /// Size of the blocks read from the file.
+    static const size_t block_size = 16 * 1024 * 1024;
+    /// Minimum size of a chunk parsed by a single thread.
+    static const size_t min_chunk_size = 1024 * 1024;
+
+    struct Chunk
+    {
+        const char *begin, *end;        ///< Text of the chunk, made of complete lines.
+        std::vector<stl_vertex> vertices;
+        std::vector<int> corners;       ///< Vertex indices of the triangles, 3 per triangle.
+        std::vector<size_t> relative;   ///< Corners indexed relatively to the vertices of this chunk.
+        std::vector<size_t> groups;     ///< Triangle index of each group or object start.
+        bool error;
+        Chunk(const char *begin, const char *end) : begin(begin), end(end), error(false) {};
+    };
+
+    /// A corner referencing a vertex defined later in the file.
+    struct ForwardCorner
+    {
+        size_t volume_idx;
+        int facet_idx, corner;
+        int vertex_idx;
+    };
+
+    ModelObject* object;
+    ModelVolume* volume;                ///< Volume receiving the facets, NULL before the first facet of a group.
+    std::vector<stl_vertex> vertices;
+    std::vector<ForwardCorner> forward;
+
+    static void parse_chunk(Chunk* chunk);
+    void append_chunk(Chunk &chunk);
+    void add_facet(const int* corners);
+    void finish();
+};
+
+static inline bool
+is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/// End of the data of a line: its new line or the start of a trailing comment.
+static inline bool
+is_line_end(char c)
+{
+    return c == '\n' || c == '#';
+}
+
+static inline const char*
+skip_blanks(const char *p)
+{
+    while (is_blank(*p)) ++p;
+    return p;
+}
+
+static inline const char*
+skip_token(const char *p)
+{
+    while (!is_blank(*p) && !is_line_end(*p)) ++p;
+    return p;
+}
+
+void
+OBJReader::parse_chunk(Chunk* chunk)
+{
+    std::vector<int> face;
+    std::vector<bool> face_relative;
+    for (const char *p = chunk->begin; p < chunk->end; ) {
+        const char *line_end = (const char*)memchr(p, '\n', chunk->end - p);
+        p = skip_blanks(p);
+        if (p[0] == 'v' && is_blank(p[1])) {
+            // Vertex position, the optional w and color components are ignored.
+            float xyz[3] = { 0.f, 0.f, 0.f };
+            p += 2;
+            for (int i = 0; i < 3; ++i) {
+                p = skip_blanks(p);
+                if (is_line_end(*p)) break;
+                const char *end = p;
+                xyz[i] = float(parse_double(p, &end));
+                p = skip_token(end);
+            }
+            stl_vertex v;
+            v.x = xyz[0];
+            v.y = xyz[1];
+            v.z = xyz[2];
+            chunk->vertices.push_back(v);
+        } else if (p[0] == 'f' && is_blank(p[1])) {
+            // Face made of v, v/vt, v//vn or v/vt/vn references, only v is used.
+            face.clear();
+            face_relative.clear();
+            for (p = skip_blanks(p + 2); !is_line_end(*p); p = skip_blanks(skip_token(p))) {
+                char *end;
+                const long idx = strtol(p, &end, 10);
+                if (end == p || idx == 0) {
+                    chunk->error = true;
+                    return;
+                }
+                // Negative indices are relative to the last vertex read so far.
+                face.push_back(idx > 0 ? int(idx - 1) : int(chunk->vertices.size() + idx));
+                face_relative.push_back(idx < 0);
+                p = end;
+            }
+            for (size_t i = 2; i < face.size(); ++i) {
+                const size_t fan[3] = { 0, i - 1, i };
+                for (int j = 0; j < 3; ++j) {
+                    if (face_relative[fan[j]])
+                        chunk->relative.push_back(chunk->corners.size());
+                    chunk->corners.push_back(face[fan[j]]);
+                }
+            }
+        } else if ((p[0] == 'g' || p[0] == 'o') && is_blank(p[1])) {
+            chunk->groups.push_back(chunk->corners.size() / 3);
+        }
+        p = line_end + 1;
+    }
+}
+
+void
+OBJReader::append_chunk(Chunk &chunk)
+{
+    const int base = int(this->vertices.size());
+    this->vertices.insert(this->vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+    for (size_t corner : chunk.relative)
+        chunk.corners[corner] += base;
+
+    std::vector<size_t>::const_iterator group = chunk.groups.begin();
+    for (size_t i = 0; i * 3 < chunk.corners.size(); ++i) {
+        // A group or an object starts a new volume, unless the current one is still empty.
+        for (; group != chunk.groups.end() && *group <= i; ++group)
+            this->volume = NULL;
+        this->add_facet(&chunk.corners[i * 3]);
+    }
+    if (group != chunk.groups.end())
+        this->volume = NULL;
+}
+
+void
+OBJReader::add_facet(const int* corners)
+{
+    if (this->volume == NULL) {
+        this->volume = this->object->add_volume(TriangleMesh());
+        this->volume->name = this->object->name;
+        this->volume->mesh.stl.stats.type = inmemory;
+    }
+    stl_file &stl = this->volume->mesh.stl;
+    if (stl.stats.number_of_facets == stl.stats.facets_malloced) {
+        stl.stats.facets_malloced = std::max(1024, stl.stats.facets_malloced * 2);
+        stl.facet_start = (stl_facet*)realloc(stl.facet_start, sizeof(stl_facet) * stl.stats.facets_malloced);
+        if (stl.facet_start == NULL)
+            throw std::runtime_error("Out of memory while reading OBJ file");
+    }
+    stl_facet &facet = stl.facet_start[stl.stats.number_of_facets];
+    memset(&facet, 0, sizeof(stl_facet));
+    for (int i = 0; i < 3; ++i) {
+        if (corners[i] < 0)
+            throw std::runtime_error("Error while reading OBJ file: invalid vertex index");
+        if (corners[i] < int(this->vertices.size())) {
+            facet.vertex[i] = this->vertices[corners[i]];
+        } else {
+            ForwardCorner fc;
+            fc.volume_idx = this->object->volumes.size() - 1;
+            fc.facet_idx  = stl.stats.number_of_facets;
+            fc.corner     = i;
+            fc.vertex_idx = corners[i];
+            this->forward.push_back(fc);
+        }
+    }
+    ++ stl.stats.number_of_facets;
+}
+
+static void
+check_volume_topology(ModelVolume* volume)
+{
+    volume->mesh.check_topology();
+}
+
+void
+OBJReader::finish()
+{
+    for (const ForwardCorner &fc : this->forward) {
+        if (fc.vertex_idx >= int(this->vertices.size()))
+            throw std::runtime_error("Error while reading OBJ file: invalid vertex index");
+        this->object->volumes[fc.volume_idx]->mesh.stl.facet_start[fc.facet_idx].vertex[fc.corner] = this->vertices[fc.vertex_idx];
+    }
+    this->vertices.clear();
+    this->vertices.shrink_to_fit();
+
+    std::queue<ModelVolume*> volumes;
+    for (ModelVolume* volume : this->object->volumes) {
+        stl_file &stl = volume->mesh.stl;
+        stl.facet_start = (stl_facet*)realloc(stl.facet_start, sizeof(stl_facet) * stl.stats.number_of_facets);
+        stl.stats.facets_malloced = stl.stats.number_of_facets;
+        stl.stats.original_num_facets = stl.stats.number_of_facets;
+        stl.neighbors_start = (stl_neighbors*)calloc(stl.stats.number_of_facets, sizeof(stl_neighbors));
+        stl_get_size(&stl);
+        volumes.push(volume);
+    }
+    // The volumes are independent, check them in parallel.
+    parallelize<ModelVolume*>(volumes, boost::bind(&check_volume_topology, _1));
+}
+
+void
+OBJReader::read(std::istream &in)
+{
+    const size_t threads = std::max(1u, boost::thread::hardware_concurrency());
+    std::vector<char> buffer;
+    size_t carry = 0;   // Length of the incomplete line at the end of the previous block.
+    while (in) {
+        buffer.resize(carry + block_size + 1);
+        in.read(buffer.data() + carry, block_size);
+        if (in.bad())
+            throw std::runtime_error("Error while reading OBJ file");
+        size_t size = carry + size_t(in.gcount());
+        if (size == 0) break;
+
+        // Process the complete lines, the last line of the file may miss its new line.
+        size_t lines_end;
+        if (in) {
+            for (lines_end = size; lines_end > 0 && buffer[lines_end - 1] != '\n'; --lines_end) ;
+        } else {
+            if (buffer[size - 1] != '\n')
+                buffer[size++] = '\n';
+            lines_end = size;
+        }
+
+        // Split the lines into chunks.
+        std::vector<Chunk> chunks;
+        const size_t chunk_size = std::max(min_chunk_size, lines_end / threads + 1);
+        const char *begin = buffer.data();
+        const char *end   = buffer.data() + lines_end;
+        while (begin < end) {
+            const char *split = begin + std::min(chunk_size, size_t(end - begin)) - 1;
+            split = (const char*)memchr(split, '\n', end - split) + 1;
+            chunks.push_back(Chunk(begin, split));
+            begin = split;
+        }
+        if (chunks.size() == 1) {
+            OBJReader::parse_chunk(&chunks.front());
+        } else if (chunks.size() > 1) {
+            std::queue<Chunk*> queue;
+            for (Chunk &chunk : chunks)
+                queue.push(&chunk);
+            parallelize<Chunk*>(queue, boost::bind(&OBJReader::parse_chunk, _1));
+        }
+        for (Chunk &chunk : chunks) {
+            if (chunk.error)
+                throw std::runtime_error("Error while reading OBJ file");
+            this->append_chunk(chunk);
+        }
+
+        carry = size - lines_end;
+        memmove(buffer.data(), buffer.data() + lines_end, carry);
+    }
+    this->finish();
+}
+
+bool
+OBJ::read(std::string input_file, TriangleMesh* mesh)
+{
+    Model model;
+    OBJ::read(input_file, &model);
+    *mesh = model.mesh();
+
+    return true;
+}
+
+bool
+OBJ::read(std::string input_file, Model* model)
+{
+    boost::nowide::ifstream ifs(input_file, std::ios::in | std::ios::binary);
+    if (!ifs.is_open())
+        throw std::runtime_error("Error while reading OBJ file");
+
+    ModelObject* object = model->add_object();
+    object->name        = boost::filesystem::path(input_file).filename().string();
+    object->input_file  = input_file;
+
+    OBJReader reader(object);
+    reader.read(ifs);
+
+    return true;
+}
+
+bool
+OBJ::write(Model& model, std::string output_file)
+{
+    TriangleMesh mesh = model.mesh();
+    return OBJ::write(mesh, output_file);
+}
+
+bool
+OBJ::write(TriangleMesh& mesh, std::string output_file)
+{
+    mesh.WriteOBJFile(output_file);
+    return true;
+}
+
+} }
@@ -0,0 +1,409 @@
+#include "../IO.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <boost/nowide/iostream.hpp>
+
+namespace Slic3r { namespace IO {
+
+// Layout of a snapshot file:
+//   header: magic, version, byte order mark and the sizes of the admesh structures stored verbatim,
+//   metadata, materials, then objects with their volumes and instances.
+// Strings are stored as a 32 bit length followed by the characters, configs as key / serialized value pairs.
+// Volume meshes are stored as the admesh stats, facets and neighbors arrays, so a repaired mesh
+// is loaded back without being repaired again.
+// The schematic of an object is stored as its parts with their pads and its nets with their pins,
+// followed by the placing and routing state in the XML notation of a 3de file.
+
+static const char     snapshot_magic[8] = { 'S', 'L', 'I', 'C', '3', 'R', 'M', 'S' };
+static const uint32_t snapshot_version  = 2;
+static const uint32_t snapshot_bom      = 0x01020304;
+
+class SnapshotWriter
+{
+public:
+    std::string data;
+
+    template <class T> void pod(const T &value) {
+        this->data.append((const char*)&value, sizeof(T));
+    };
+    void raw(const void* buffer, size_t size) {
+        this->data.append((const char*)buffer, size);
+    };
+    void string(const std::string &str) {
+        this->pod(uint32_t(str.size()));
+        this->data.append(str);
+    };
+    void config(const DynamicPrintConfig &config) {
+        const t_config_option_keys keys = config.keys();
+        this->pod(uint32_t(keys.size()));
+        for (const t_config_option_key &key : keys) {
+            this->string(key);
+            this->string(config.serialize(key));
+        }
+    };
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const char* data, size_t size) : data(data), size(size), pos(0), error(false) {};
+
+    template <class T> T pod() {
+        T value = T();
+        this->raw(&value, sizeof(T));
+        return value;
+    };
+    void raw(void* buffer, size_t size) {
+        if (this->error || size > this->remaining()) {
+            this->error = true;
+            return;
+        }
+        memcpy(buffer, this->data + this->pos, size);
+        this->pos += size;
+    };
+    std::string string() {
+        const uint32_t size = this->pod<uint32_t>();
+        if (this->error || size > this->remaining()) {
+            this->error = true;
+            return std::string();
+        }
+        std::string str(this->data + this->pos, size);
+        this->pos += size;
+        return str;
+    };
+    void config(DynamicPrintConfig* config) {
+        const uint32_t count = this->pod<uint32_t>();
+        for (uint32_t i = 0; i < count && !this->error; ++i) {
+            const std::string key   = this->string();
+            const std::string value = this->string();
+            if (!this->error)
+                config->set_deserialize(key, value);
+        }
+    };
+    bool failed() const { return this->error; };
+    void fail() { this->error = true; };
+    size_t remaining() const { return this->size - this->pos; };
+
+private:
+    const char* data;
+    size_t size;
+    size_t pos;
+    bool error;
+};
+
+static void
+write_mesh(SnapshotWriter &out, const TriangleMesh &mesh)
+{
+    const stl_file &stl = mesh.stl;
+    // The shared vertices are not stored, they are regenerated on demand.
+    stl_stats stats = stl.stats;
+    stats.shared_vertices = 0;
+    stats.shared_malloced = 0;
+    out.pod(uint8_t(mesh.repaired));
+    out.pod(stats);
+    if (stats.number_of_facets > 0) {
+        out.raw(stl.facet_start, sizeof(stl_facet) * stats.number_of_facets);
+        out.pod(uint8_t(stl.neighbors_start != nullptr));
+        if (stl.neighbors_start != nullptr)
+            out.raw(stl.neighbors_start, sizeof(stl_neighbors) * stats.number_of_facets);
+    }
+}
+
+static void
+read_mesh(SnapshotReader &in, TriangleMesh* mesh)
+{
+    stl_file &stl = mesh->stl;
+    const bool repaired = in.pod<uint8_t>() != 0;
+    const stl_stats stats = in.pod<stl_stats>();
+    if (in.failed())
+        return;
+    // check the facet count against the file size before allocating the facets
+    if (stats.number_of_facets < 0 || size_t(stats.number_of_facets) > in.remaining() / sizeof(stl_facet)) {
+        in.fail();
+        return;
+    }
+    stl.stats = stats;
+    stl.stats.type = inmemory;
+    if (stats.number_of_facets == 0)
+        return;
+    stl_allocate(&stl);
+    in.raw(stl.facet_start, sizeof(stl_facet) * stats.number_of_facets);
+    if (in.pod<uint8_t>() != 0)
+        in.raw(stl.neighbors_start, sizeof(stl_neighbors) * stats.number_of_facets);
+    mesh->repaired = repaired && !in.failed();
+}
+
+static void
+write_schematic(SnapshotWriter &out, Schematic &schematic)
+{
+    out.string(schematic.getFilename());
+
+    const ElectronicParts* parts = schematic.getPartlist();
+    out.pod(uint32_t(parts->size()));
+    for (ElectronicPart* part : *parts) {
+        out.string(part->getName());
+        out.string(part->getLibrary());
+        out.string(part->getDeviceset());
+        out.string(part->getDevice());
+        out.string(part->getPackage());
+        out.pod(part->getSize());
+        out.pod(part->getPartOrigin());
+        out.pod(uint8_t(part->isVisible()));
+        const Padlist* pads = part->getPadlist();
+        out.pod(uint32_t(pads->size()));
+        for (const ElectronicPad &pad : *pads) {
+            out.string(pad.type);
+            out.string(pad.pad);
+            out.string(pad.pin);
+            out.string(pad.gate);
+            out.pod(pad.position[0]);
+            out.pod(pad.position[1]);
+            out.pod(pad.rotation[2]);
+            out.pod(pad.size[0]);
+            out.pod(pad.size[1]);
+            out.pod(pad.drill);
+            out.string(pad.shape);
+        }
+    }
+
+    const ElectronicNets* nets = schematic.getNetlist();
+    out.pod(uint32_t(nets->size()));
+    for (ElectronicNet* net : *nets) {
+        out.string(net->getName());
+        const Pinlist* pins = net->getPinList();
+        out.pod(uint32_t(pins->size()));
+        for (const ElectronicNetPin &pin : *pins) {
+            out.string(pin.part);
+            out.string(pin.pin);
+            out.string(pin.gate);
+        }
+    }
+
+    // position, rotation and placing of the parts, waypoints and wires of the nets
+    out.string(schematic.write3deString(schematic.getFilename()));
+}
+
+static void
+read_schematic(SnapshotReader &in, Schematic* schematic)
+{
+    schematic->setFilename(in.string());
+
+    const uint32_t part_count = in.pod<uint32_t>();
+    for (uint32_t i = 0; i < part_count && !in.failed(); ++i) {
+        const std::string name      = in.string();
+        const std::string library   = in.string();
+        const std::string deviceset = in.string();
+        const std::string device    = in.string();
+        const std::string package   = in.string();
+        ElectronicPart* part = schematic->addElectronicPart(name, library, deviceset, device, package);
+        const Pointf3 size   = in.pod<Pointf3>();
+        const Pointf3 origin = in.pod<Pointf3>();
+        part->setSize(size.x, size.y, size.z);
+        part->setPartOrigin(origin.x, origin.y, origin.z);
+        part->setVisibility(in.pod<uint8_t>() != 0);
+        const uint32_t pad_count = in.pod<uint32_t>();
+        for (uint32_t j = 0; j < pad_count && !in.failed(); ++j) {
+            const std::string type = in.string();
+            const std::string pad  = in.string();
+            const std::string pin  = in.string();
+            const std::string gate = in.string();
+            const double x         = in.pod<double>();
+            const double y         = in.pod<double>();
+            const double rotation  = in.pod<double>();
+            const double dx        = in.pod<double>();
+            const double dy        = in.pod<double>();
+            const double drill     = in.pod<double>();
+            part->addPad(type, pad, pin, gate, x, y, rotation, dx, dy, drill, in.string());
+        }
+    }
+
+    const uint32_t net_count = in.pod<uint32_t>();
+    for (uint32_t i = 0; i < net_count && !in.failed(); ++i) {
+        ElectronicNet* net = new ElectronicNet(in.string());
+        const uint32_t pin_count = in.pod<uint32_t>();
+        for (uint32_t j = 0; j < pin_count && !in.failed(); ++j) {
+            const std::string part = in.string();
+            const std::string pin  = in.string();
+            net->addPin(part, pin, in.string());
+        }
+        schematic->addElectronicNet(net);
+    }
+
+    // the parts and nets exist now, apply their placing and routing on top like a 3de file does
+    const std::string placing = in.string();
+    if (!in.failed() && !schematic->load3deString(placing))
+        in.fail();
+}
+
+bool
+Snapshot::write(Model& model, std::string output_file)
+{
+    SnapshotWriter out;
+    out.raw(snapshot_magic, sizeof(snapshot_magic));
+    out.pod(snapshot_version);
+    out.pod(snapshot_bom);
+    out.pod(uint32_t(sizeof(stl_stats)));
+    out.pod(uint32_t(sizeof(stl_facet)));
+    out.pod(uint32_t(sizeof(stl_neighbors)));
+
+    out.pod(uint32_t(model.metadata.size()));
+    for (const auto &metadata : model.metadata) {
+        out.string(metadata.first);
+        out.string(metadata.second);
+    }
+
+    out.pod(uint32_t(model.materials.size()));
+    for (const auto &material : model.materials) {
+        out.string(material.first);
+        out.pod(uint32_t(material.second->attributes.size()));
+        for (const auto &attribute : material.second->attributes) {
+            out.string(attribute.first);
+            out.string(attribute.second);
+        }
+        out.config(material.second->config);
+    }
+
+    out.pod(uint32_t(model.objects.size()));
+    for (ModelObject* object : model.objects) {
+        out.string(object->name);
+        out.string(object->input_file);
+        out.config(object->config);
+        out.pod(uint32_t(object->layer_height_ranges.size()));
+        for (const auto &range : object->layer_height_ranges) {
+            out.pod(range.first.first);
+            out.pod(range.first.second);
+            out.pod(range.second);
+        }
+        out.pod(int32_t(object->part_number));
+        out.pod(object->origin_translation);
+        write_schematic(out, *object->schematic());
+
+        out.pod(uint32_t(object->volumes.size()));
+        for (const ModelVolume* volume : object->volumes) {
+            out.string(volume->name);
+            out.string(volume->material_id());
+            out.pod(uint8_t(volume->modifier));
+            out.config(volume->config);
+            write_mesh(out, volume->mesh);
+        }
+
+        out.pod(uint32_t(object->instances.size()));
+        for (const ModelInstance* instance : object->instances) {
+            out.pod(instance->rotation);
+            out.pod(instance->x_rotation);
+            out.pod(instance->y_rotation);
+            out.pod(instance->scaling_factor);
+            out.pod(instance->scaling_vector);
+            out.pod(instance->offset);
+            out.pod(instance->z_translation);
+        }
+    }
+
+    boost::nowide::ofstream file;
+    file.open(output_file, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    file.write(out.data.data(), out.data.size());
+    file.close();
+    return !file.fail();
+}
+
+bool
+Snapshot::read(std::string input_file, Model* model)
+{
+    // the file is mapped in memory, the meshes are copied straight from the mapping
+    namespace bip = boost::interprocess;
+    bip::file_mapping mapping;
+    bip::mapped_region region;
+    try {
+        mapping = bip::file_mapping(input_file.c_str(), bip::read_only);
+        region  = bip::mapped_region(mapping, bip::read_only);
+    } catch (const bip::interprocess_exception &) {
+        boost::nowide::cerr << "Cannot open file: " << input_file << std::endl;
+        return false;
+    }
+
+    SnapshotReader in(static_cast<const char*>(region.get_address()), region.get_size());
+    char magic[sizeof(snapshot_magic)];
+    in.raw(magic, sizeof(magic));
+    if (in.failed() || memcmp(magic, snapshot_magic, sizeof(magic)) != 0
+        || in.pod<uint32_t>() != snapshot_version
+        || in.pod<uint32_t>() != snapshot_bom
+        || in.pod<uint32_t>() != sizeof(stl_stats)
+        || in.pod<uint32_t>() != sizeof(stl_facet)
+        || in.pod<uint32_t>() != sizeof(stl_neighbors)) {
+        // Written by a different version or on a platform with a different layout.
+        return false;
+    }
+
+    const uint32_t metadata_count = in.pod<uint32_t>();
+    for (uint32_t i = 0; i < metadata_count && !in.failed(); ++i) {
+        const std::string key = in.string();
+        model->metadata[key] = in.string();
+    }
+
+    const uint32_t material_count = in.pod<uint32_t>();
+    for (uint32_t i = 0; i < material_count && !in.failed(); ++i) {
+        ModelMaterial* material = model->add_material(in.string());
+        const uint32_t attribute_count = in.pod<uint32_t>();
+        for (uint32_t j = 0; j < attribute_count && !in.failed(); ++j) {
+            const std::string key = in.string();
+            material->attributes[key] = in.string();
+        }
+        in.config(&material->config);
+    }
+
+    const uint32_t object_count = in.pod<uint32_t>();
+    for (uint32_t i = 0; i < object_count && !in.failed(); ++i) {
+        ModelObject* object = model->add_object();
+        object->name       = in.string();
+        object->input_file = in.string();
+        in.config(&object->config);
+        const uint32_t range_count = in.pod<uint32_t>();
+        for (uint32_t j = 0; j < range_count && !in.failed(); ++j) {
+            const coordf_t min_z  = in.pod<coordf_t>();
+            const coordf_t max_z  = in.pod<coordf_t>();
+            object->layer_height_ranges[t_layer_height_range(min_z, max_z)] = in.pod<coordf_t>();
+        }
+        object->part_number        = in.pod<int32_t>();
+        object->origin_translation = in.pod<Pointf3>();
+        read_schematic(in, object->schematic());
+
+        const uint32_t volume_count = in.pod<uint32_t>();
+        for (uint32_t j = 0; j < volume_count && !in.failed(); ++j) {
+            ModelVolume* volume = object->add_volume(TriangleMesh());
+            volume->name = in.string();
+            const t_model_material_id material_id = in.string();
+            if (!material_id.empty())
+                volume->material_id(material_id);
+            volume->modifier = in.pod<uint8_t>() != 0;
+            in.config(&volume->config);
+            read_mesh(in, &volume->mesh);
+        }
+
+        const uint32_t instance_count = in.pod<uint32_t>();
+        for (uint32_t j = 0; j < instance_count && !in.failed(); ++j) {
+            ModelInstance* instance = object->add_instance();
+            instance->rotation       = in.pod<double>();
+            instance->x_rotation     = in.pod<double>();
+            instance->y_rotation     = in.pod<double>();
+            instance->scaling_factor = in.pod<double>();
+            instance->scaling_vector = in.pod<Pointf3>();
+            instance->offset         = in.pod<Pointf>();
+            instance->z_translation  = in.pod<double>();
+        }
+        object->invalidate_bounding_box();
+    }
+
+    if (in.failed()) {
+        boost::nowide::cerr << "Truncated snapshot file: " << input_file << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} }
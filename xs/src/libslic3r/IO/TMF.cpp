@@ -2,13 +2,18 @@
 
 namespace Slic3r { namespace IO {
 
+bool
+TMFEditor::add_entry(const std::string &entry_path, const std::ostringstream &fout)
+{
+    const std::string data = fout.str();
+    return zip_archive->add_entry_from_buffer(entry_path, data.data(), data.size()) != 0;
+}
+
 bool
 TMFEditor::write_types()
 {
-    // Create a new .[Content_Types].xml file to add to the zip file later.
-    boost::nowide::ofstream fout(".[Content_Types].xml", std::ios::out | std::ios::trunc);
-    if(!fout.is_open())
-        return false;
+    // Write the .[Content_Types].xml contents in memory.
+    std::ostringstream fout;
 
     // Write 3MF Types.
     fout << "<?xml version=\"1.0\" encoding=\"UTF-8\"?> \n";
@@ -16,51 +21,31 @@ TMFEditor::write_types()
     fout << "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>\n";
     fout << "<Default Extension=\"model\" ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>\n";
     fout << "</Types>\n";
-    fout.close();
 
     // Create [Content_Types].xml in the zip archive.
-    if(!zip_archive->add_entry("[Content_Types].xml", ".[Content_Types].xml"))
-        return false;
-
-    // Remove the created .[Content_Types].xml file.
-    if (remove(".[Content_Types].xml") != 0)
-        return false;
-
-    return true;
+    return add_entry("[Content_Types].xml", fout);
 }
 
 bool
 TMFEditor::write_relationships()
 {
-    // Create a new .rels file to add to the zip file later.
-    boost::nowide::ofstream fout(".rels", std::ios::out | std::ios::trunc);
-    if(!fout.is_open())
-        return false;
+    // Write the .rels contents in memory.
+    std::ostringstream fout;
 
     // Write the primary 3dmodel relationship.
     fout << "<?xml version=\"1.0\" encoding=\"UTF-8\"?> \n"
                           << "<Relationships xmlns=\"" << namespaces.at("relationships") <<
                   "\">\n<Relationship Id=\"rel0\" Target=\"/3D/3dmodel.model\" Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\" /></Relationships>\n";
-    fout.close();
 
     // Create .rels in "_rels" folder in the zip archive.
-    if(!zip_archive->add_entry("_rels/.rels", ".rels"))
-        return false;
-
-    // Remove the created .rels file.
-    if (remove(".rels") != 0)
-        return false;
-
-    return true;
+    return add_entry("_rels/.rels", fout);
 }
 
 bool
 TMFEditor::write_model()
 {
-    // Create a new .3dmodel.model file to add to the zip file later.
-    boost::nowide::ofstream fout(".3dmodel.model", std::ios::out | std::ios::trunc);
-    if(!fout.is_open())
-        return false;
+    // Write the 3dmodel.model contents in memory.
+    std::ostringstream fout;
 
     // Add the XML document header.
     fout << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
@@ -89,21 +74,13 @@ TMFEditor::write_model()
 
     // Close the model element.
     fout << "</model>\n";
-    fout.close();
-
-    // Create .3dmodel.model in "3D" folder in the zip archive.
-    if(!zip_archive->add_entry("3D/3dmodel.model", ".3dmodel.model"))
-        return false;
-
-    // Remove the created .rels file.
-    if (remove(".3dmodel.model") != 0)
-        return false;
 
-    return true;
+    // Create 3dmodel.model in "3D" folder in the zip archive.
+    return add_entry("3D/3dmodel.model", fout);
 }
 
 bool
-TMFEditor::write_metadata(boost::nowide::ofstream& fout)
+TMFEditor::write_metadata(std::ostream& fout)
 {
     // Write the model metadata.
     for (const auto metadata : model->metadata){
@@ -117,7 +94,7 @@ TMFEditor::write_metadata(boost::nowide::ofstream& fout)
 }
 
 bool
-TMFEditor::write_object(boost::nowide::ofstream& fout, const ModelObject* object, int index)
+TMFEditor::write_object(std::ostream& fout, const ModelObject* object, int index)
 {
     // Create the new object element.
     fout << "        <object id=\"" << (index + object_id) << "\" type=\"model\"";
@@ -234,7 +211,7 @@ TMFEditor::write_object(boost::nowide::ofstream& fout, const ModelObject* object
 }
 
 bool
-TMFEditor::write_build(boost::nowide::ofstream& fout)
+TMFEditor::write_build(std::ostream& fout)
 {
     // Create build element.
     fout << "    <build> \n";
@@ -284,56 +261,30 @@ TMFEditor::write_build(boost::nowide::ofstream& fout)
 bool
 TMFEditor::read_model()
 {
-    // Extract 3dmodel.model entry.
-    if(!zip_archive->extract_entry("3D/3dmodel.model", "3dmodel.model"))
-        return false;
-
-    // Read 3D/3dmodel.model file.
+    // Read 3D/3dmodel.model entry.
     XML_Parser parser = XML_ParserCreate(NULL);
     if (! parser) {
         std::cout << ("Couldn't allocate memory for parser\n");
         return false;
     }
 
-    boost::nowide::ifstream fin("3dmodel.model", std::ios::in);
-    if (!fin.is_open()) {
-        boost::nowide::cerr << "Cannot open file: " << "3dmodel.model" << std::endl;
-        return false;
-    }
-
     // Create model parser.
     TMFParserContext ctx(parser, model);
     XML_SetUserData(parser, (void*)&ctx);
     XML_SetElementHandler(parser, TMFParserContext::startElement, TMFParserContext::endElement);
     XML_SetCharacterDataHandler(parser, TMFParserContext::characters);
 
-    char buff[8192];
-    bool result = false;
-    while (!fin.eof()) {
-        fin.read(buff, sizeof(buff));
-        if (fin.bad()) {
-            printf("3MF model parser: Read error\n");
-            break;
-        }
-        if (XML_Parse(parser, buff, fin.gcount(), fin.eof()) == XML_STATUS_ERROR) {
-            printf("3MF model parser: Parse error at line %lu:\n%s\n",
-                   XML_GetCurrentLineNumber(parser),
-                   XML_ErrorString(XML_GetErrorCode(parser)));
-            break;
-        }
-        if (fin.eof()) {
-            result = true;
-            break;
-        }
+    // Feed the parser directly with the inflated chunks of the model entry, then finish the document.
+    bool result = zip_archive->extract_entry_to_callback("3D/3dmodel.model", TMFParserContext::parse_chunk, &ctx) != 0;
+    if (result && XML_Parse(parser, nullptr, 0, 1) == XML_STATUS_ERROR) {
+        printf("3MF model parser: Parse error at line %lu:\n%s\n",
+               XML_GetCurrentLineNumber(parser),
+               XML_ErrorString(XML_GetErrorCode(parser)));
+        result = false;
     }
 
-    // Free the parser and close the file.
+    // Free the parser.
     XML_ParserFree(parser);
-    fin.close();
-
-    // Remove the extracted 3dmodel.model file.
-    if (remove("3dmodel.model") != 0)
-        return false;
 
     if (result)
         ctx.endDocument();
@@ -417,6 +368,20 @@ TMFParserContext::TMFParserContext(XML_Parser parser, Model *model):
     m_value[0] = m_value[1] = m_value[2] = "";
 }
 
+size_t
+TMFParserContext::parse_chunk(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n)
+{
+    TMFParserContext *ctx = (TMFParserContext*)pOpaque;
+    if (XML_Parse(ctx->m_parser, (const char*)pBuf, (int)n, 0) == XML_STATUS_ERROR) {
+        printf("3MF model parser: Parse error at line %lu:\n%s\n",
+               XML_GetCurrentLineNumber(ctx->m_parser),
+               XML_ErrorString(XML_GetErrorCode(ctx->m_parser)));
+        // Returning less than n stops the extraction.
+        return 0;
+    }
+    return n;
+}
+
 void XMLCALL
 TMFParserContext::startElement(void *userData, const char *name, const char **atts){
     TMFParserContext *ctx = (TMFParserContext*) userData;
@@ -605,9 +570,9 @@ TMFParserContext::startElement(const char *name, const char **atts)
                 const char* z = get_attribute(atts, "z");
                 if ( !x || !y || !z)
                     this->stop();
-                m_object_vertices.push_back(atof(x));
-                m_object_vertices.push_back(atof(y));
-                m_object_vertices.push_back(atof(z));
+                m_vertices_text.push(x);
+                m_vertices_text.push(y);
+                m_vertices_text.push(z);
                 node_type_new = NODE_TYPE_VERTEX;
             } else if (strcmp(name, "triangle") == 0) {
                 const char* v1 = get_attribute(atts, "v1");
@@ -616,9 +581,9 @@ TMFParserContext::startElement(const char *name, const char **atts)
                 if (!v1 || !v2 || !v3)
                     this->stop();
                 // Add it to the volume facets.
-                m_volume_facets.push_back(atoi(v1));
-                m_volume_facets.push_back(atoi(v2));
-                m_volume_facets.push_back(atoi(v3));
+                m_facets_text.push(v1);
+                m_facets_text.push(v2);
+                m_facets_text.push(v3);
                 node_type_new = NODE_TYPE_TRIANGLE;
             } else if (strcmp(name, "slic3r:volume") == 0) {
                 // Read start offset of the triangles.
@@ -667,6 +632,16 @@ TMFParserContext::endElement()
                 m_value[1].clear();
             }
             break;
+        case NODE_TYPE_VERTICES:
+            // Convert the collected coordinates.
+            m_vertices_text.to_floats(&m_object_vertices);
+            m_vertices_text.clear();
+            break;
+        case NODE_TYPE_TRIANGLES:
+            // Convert the collected vertex indices.
+            m_facets_text.to_ints(&m_volume_facets);
+            m_facets_text.clear();
+            break;
         case NODE_TYPE_MESH:
             // Add the object volume if no there are no added volumes in slic3r:volumes.
             if(m_object->volumes.size() == 0) {
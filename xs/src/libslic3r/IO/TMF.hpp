@@ -3,6 +3,7 @@
 
 #include "../IO.hpp"
 #include "../Zip/ZipArchive.hpp"
+#include "NumberBuffer.hpp"
 #include <cstdio>
 #include <string>
 #include <cstring>
@@ -11,7 +12,7 @@
 #include <algorithm>
 #include <cmath>
 #include <boost/move/move.hpp>
-#include <boost/nowide/fstream.hpp>
+#include <sstream>
 #include <boost/nowide/iostream.hpp>
 #include <expat/expat.h>
 
@@ -57,18 +58,21 @@ private:
     /// Write the Model in a zip file. This function is called by produceTMF() function.
     bool write_model();
 
+    /// Add the contents of an output stream as a new entry of the zip archive.
+    bool add_entry(const std::string &entry_path, const std::ostringstream &fout);
+
     /// Write the metadata of the model. This function is called by writeModel() function.
-    bool write_metadata(boost::nowide::ofstream& fout);
+    bool write_metadata(std::ostream& fout);
 
     /// Write object of the current model. This function is called by writeModel() function.
-    /// \param fout boost::nowide::ofstream& fout output stream.
+    /// \param fout std::ostream& fout output stream.
     /// \param object ModelObject* a pointer to the object to be written.
     /// \param index int the index of the object to be read
     /// \return bool 1: write operation is successful , otherwise not.
-    bool write_object(boost::nowide::ofstream& fout, const ModelObject* object, int index);
+    bool write_object(std::ostream& fout, const ModelObject* object, int index);
 
     /// Write the build element.
-    bool write_build(boost::nowide::ofstream& fout);
+    bool write_build(std::ostream& fout);
 
     /// Read the Model.
     bool read_model();
@@ -122,12 +126,18 @@ struct TMFParserContext{
     std::vector<float> m_object_vertices;
     ///< Vertices parsed for the current m_object.
 
+    NumberBuffer m_vertices_text;
+    ///< Coordinates of the <vertex> elements of the current mesh, converted at the end of <vertices>.
+
     ModelVolume *m_volume;
     ///< Volume allocated for an model/object/mesh.
 
     std::vector<int> m_volume_facets;
     ///< Faces collected for all volumes of the current object.
 
+    NumberBuffer m_facets_text;
+    ///< Vertex indices of the <triangle> elements of the current mesh, converted at the end of <triangles>.
+
     std::string m_value[3];
     ///< Generic string buffer for metadata, etc.
 
@@ -143,6 +153,10 @@ struct TMFParserContext{
     void characters(const XML_Char *s, int len);
     void stop();
 
+    /// Feed a chunk of the 3MF model document to the parser.
+    /// Used as the miniz callback receiving the inflated model entry.
+    static size_t parse_chunk(void *pOpaque, mz_uint64 file_ofs, const void *pBuf, size_t n);
+
     /// Get scale, rotation and scale transformation from affine matrix.
     /// \param matrix string the 3D matrix where elements are separated by space.
     /// \return vector<double> a vector contains [translation, scale factor, xRotation, yRotation, zRotation].
@@ -174,7 +174,7 @@ template bool Layer::any_bottom_region_slice_contains<Polyline>(const Polyline &
 /// The perimeter paths and the thin fills (ExtrusionEntityCollection) are assigned to the first compatible layer region.
 /// The resulting fill surface is split back among the originating regions.
 void
-Layer::make_perimeters()
+Layer::make_perimeters(PerimeterIslandQueue* island_queue)
 {
     #ifdef SLIC3R_DEBUG
     printf("Making perimeters for layer %zu\n", this->id());
@@ -211,7 +211,7 @@ Layer::make_perimeters()
         
         if (layerms.size() == 1) {  // optimization
             (*layerm)->fill_surfaces.surfaces.clear();
-            (*layerm)->make_perimeters((*layerm)->slices, &(*layerm)->fill_surfaces);
+            (*layerm)->make_perimeters((*layerm)->slices, &(*layerm)->fill_surfaces, island_queue);
         } else {
             // group slices (surfaces) according to number of extra perimeters
             std::map<unsigned short,Surfaces> slices;  // extra_perimeters => [ surface, surface... ]
@@ -234,7 +234,7 @@ Layer::make_perimeters()
             
             // make perimeters
             SurfaceCollection fill_surfaces;
-            (*layerm)->make_perimeters(new_slices, &fill_surfaces);
+            (*layerm)->make_perimeters(new_slices, &fill_surfaces, island_queue);
             
             // assign fill_surfaces to each layer
             if (!fill_surfaces.surfaces.empty()) {
@@ -285,7 +285,8 @@ Layer::make_fills()
 /// S_TYPE_INTERNAL - Part of a region, which is supported by the same region type.
 /// If a part of a region is of S_TYPE_BOTTOM and S_TYPE_TOP, the S_TYPE_BOTTOM wins.
 void
-Layer::detect_surfaces_type()
+Layer::detect_surfaces_type(const LayerSlicesSnapshot* lower, const LayerSlicesSnapshot &snapshot,
+    const LayerSlicesSnapshot* upper)
 {
     PrintObject &object = *this->object();
     
@@ -295,37 +296,28 @@ Layer::detect_surfaces_type()
         // comparison happens against the *full* slices (considering all regions)
         // unless internal shells are requested
     
-        // We call layer->slices or layerm->slices on these neighbor layers
-        // and we convert them into Polygons so we only care about their total
-        // coverage. We only write to layerm->slices so we can read layer->slices safely.
-        Layer* const &upper_layer = this->upper_layer;
-        Layer* const &lower_layer = this->lower_layer;
+        // We read layer->slices or layerm->slices of the neighbor layers from their
+        // snapshots taken before any layer was typed, as Clipper paths since we only care
+        // about their total coverage. Each layer only writes to its own layerm->slices.
     
         // collapse very narrow parts (using the safety offset in the diff is not enough)
         // TODO: this offset2 makes this method not idempotent (see #3764), so we should
         // move it to where we generate fill_surfaces instead and leave slices unaltered
         const float offs = layerm.flow(frExternalPerimeter).scaled_width() / 10.f;
 
-        const Polygons layerm_slices_surfaces = layerm.slices;
+        // the whole chain of each classification is evaluated in Clipper space
+        const ClipperExpr &layerm_slices_surfaces = snapshot.regions[region_id];
 
         // find top surfaces (difference between current surfaces
         // of current layer and upper one)
         SurfaceCollection top;
-        if (upper_layer != NULL) {
-            Polygons upper_slices;
-            if (object.config.interface_shells.value) {
-                const LayerRegion* upper_layerm = upper_layer->get_region(region_id);
-                boost::lock_guard<boost::mutex> l(upper_layerm->_slices_mutex);
-                upper_slices = upper_layerm->slices;
-            } else {
-                upper_slices = upper_layer->slices;
-            }
+        if (upper != NULL) {
+            const ClipperExpr &upper_slices = object.config.interface_shells.value
+                ? upper->regions[region_id]
+                : upper->slices;
         
             top.append(
-                offset2_ex(
-                    diff(layerm_slices_surfaces, upper_slices, true),
-                    -offs, offs
-                ),
+                layerm_slices_surfaces.diff(upper_slices, true).offset2(-offs, offs).expolygons(),
                 stTop
             );
         } else {
@@ -338,7 +330,7 @@ Layer::detect_surfaces_type()
         // find bottom surfaces (difference between current surfaces
         // of current layer and lower one)
         SurfaceCollection bottom;
-        if (lower_layer != NULL) {
+        if (lower != NULL) {
             // If we have soluble support material, don't bridge. The overhang will be squished against a soluble layer separating
             // the support from the print.
             const SurfaceType surface_type_bottom =
@@ -347,11 +339,9 @@ Layer::detect_surfaces_type()
                 : stBottomBridge;
         
             // Any surface lying on the void is a true bottom bridge (an overhang)
+            const ClipperExpr &lower_slices = lower->slices;
             bottom.append(
-                offset2_ex(
-                    diff(layerm_slices_surfaces, lower_layer->slices, true),
-                    -offs, offs
-                ),
+                layerm_slices_surfaces.diff(lower_slices, true).offset2(-offs, offs).expolygons(),
                 surface_type_bottom
             );
         
@@ -360,17 +350,12 @@ Layer::detect_surfaces_type()
             if (object.config.interface_shells) {
                 // non-bridging bottom surfaces: any part of this layer lying
                 // on something else, excluding those lying on our own region
-                const LayerRegion* lower_layerm = lower_layer->get_region(region_id);
-                boost::lock_guard<boost::mutex> l(lower_layerm->_slices_mutex);
                 bottom.append(
-                    offset2_ex(
-                        diff(
-                            intersection(layerm_slices_surfaces, lower_layer->slices), // supported
-                            lower_layerm->slices,
-                            true
-                        ),
-                        -offs, offs
-                    ),
+                    layerm_slices_surfaces
+                        .intersection(lower_slices) // supported
+                        .diff(lower->regions[region_id], true)
+                        .offset2(-offs, offs)
+                        .expolygons(),
                     stBottom
                 );
             }
@@ -392,36 +377,31 @@ Layer::detect_surfaces_type()
         // and top surfaces; let's do an intersection to discover them and consider them
         // as bottom surfaces (to allow for bridge detection)
         if (!top.empty() && !bottom.empty()) {
-            const Polygons top_polygons = to_polygons(STDMOVE(top));
+            const ClipperExpr top_surfaces(top.surfaces);
             top.clear();
             top.append(
                 // TODO: maybe we don't need offset2?
-                offset2_ex(diff(top_polygons, bottom, true), -offs, offs),
+                top_surfaces.diff(ClipperExpr(bottom.surfaces), true).offset2(-offs, offs).expolygons(),
                 stTop
             );
         }
     
         // save surfaces to layer
-        {
-            boost::lock_guard<boost::mutex> l(layerm._slices_mutex);
-            layerm.slices.clear();
-            layerm.slices.append(STDMOVE(top));
-            layerm.slices.append(STDMOVE(bottom));
-    
-            // find internal surfaces (difference between top/bottom surfaces and others)
-            {
-                Polygons topbottom = top; append_to(topbottom, (Polygons)bottom);
+        layerm.slices.clear();
+        layerm.slices.append(STDMOVE(top));
+        layerm.slices.append(STDMOVE(bottom));
     
-                layerm.slices.append(
-                    // TODO: maybe we don't need offset2?
-                    offset2_ex(
-                        diff(layerm_slices_surfaces, topbottom, true),
-                        -offs, offs
-                    ),
-                    stInternal
-                );
-            }
-        }
+        // find internal surfaces (difference between top/bottom surfaces and others);
+        // both differences go to a single Clipper run
+        layerm.slices.append(
+            // TODO: maybe we don't need offset2?
+            layerm_slices_surfaces
+                .diff(ClipperExpr(top.surfaces), true)
+                .diff(ClipperExpr(bottom.surfaces), true)
+                .offset2(-offs, offs)
+                .expolygons(),
+            stInternal
+        );
     
         #ifdef SLIC3R_DEBUG
         printf("  layer %zu has %zu bottom, %zu top and %zu internal surfaces\n",
@@ -2,6 +2,7 @@
 #define slic3r_Layer_hpp_
 
 #include "libslic3r.h"
+#include "ClipperUtils.hpp"
 #include "Flow.hpp"
 #include "SurfaceCollection.hpp"
 #include "ExtrusionEntityCollection.hpp"
@@ -19,6 +20,7 @@ typedef std::map<t_layer_height_range,coordf_t> t_layer_height_ranges;
 class Layer;
 class PrintRegion;
 class PrintObject;
+class PerimeterIslandQueue;
 
 
 // TODO: make stuff private
@@ -67,8 +69,9 @@ class LayerRegion
     void modify_slices(Polygons &polygons, bool use_original_slices);
     /// Preprocesses fill surfaces
     void prepare_fill_surfaces();
-    /// Generates and stores the perimeters and thin fills
-    void make_perimeters(const SurfaceCollection &slices, SurfaceCollection* fill_surfaces);
+    /// Generates and stores the perimeters and thin fills,
+    /// the islands are shared with other threads through island_queue if given
+    void make_perimeters(const SurfaceCollection &slices, SurfaceCollection* fill_surfaces, PerimeterIslandQueue* island_queue = NULL);
     /// Generate infills for a LayerRegion.
     void make_fill();
     /// Processes external surfaces for bridges and top/bottom surfaces
@@ -81,8 +84,6 @@ class LayerRegion
     Layer *_layer;
     /// Pointer to associated PrintRegion
     PrintRegion *_region;
-    /// Mutex object for slices.
-    mutable boost::mutex _slices_mutex;
 
     ///Constructor
     LayerRegion(Layer *layer, PrintRegion *region)
@@ -94,6 +95,14 @@ class LayerRegion
 /// A std::vector of LayerRegion Pointers
 typedef std::vector<LayerRegion*> LayerRegionPtrs;
 
+/// Slices of a layer converted to Clipper paths before its surfaces get typed.
+/// They are immutable, so the neighbour layers read them without locking.
+struct LayerSlicesSnapshot
+{
+    ClipperExpr slices;                 ///< Layer->slices
+    std::vector<ClipperExpr> regions;   ///< LayerRegion->slices of each region
+};
+
 class Layer {
     friend class PrintObject;
 
@@ -153,11 +162,14 @@ class Layer {
     /// Template which iterates over all of the LayerRegion for containing on the bottom the argument
     template <class T> bool any_bottom_region_slice_contains(const T &item) const;
     /// Creates the perimeters cummulatively for all layer regions sharing the same parameters influencing the perimeters.
-    void make_perimeters();
+    /// The islands are shared with other threads through island_queue if given.
+    void make_perimeters(PerimeterIslandQueue* island_queue = NULL);
     /// Makes fills for all the LayerRegion
     void make_fills();
-    /// Determines the type of surface (top/bottombridge/bottom/internal) each region is
-    void detect_surfaces_type();
+    /// Determines the type of surface (top/bottombridge/bottom/internal) each region is,
+    /// from the snapshots of the slices of this layer and of its neighbours (NULL if none)
+    void detect_surfaces_type(const LayerSlicesSnapshot* lower, const LayerSlicesSnapshot &snapshot,
+        const LayerSlicesSnapshot* upper);
     /// Processes the external surfaces
     void process_external_surfaces();
     
@@ -87,7 +87,7 @@ LayerRegion::modify_slices(Polygons &polygons, bool use_original_slices)
 /// Creates a new PerimeterGenerator object
 /// Which will return the perimeters by its construction
 void
-LayerRegion::make_perimeters(const SurfaceCollection &slices, SurfaceCollection* fill_surfaces)
+LayerRegion::make_perimeters(const SurfaceCollection &slices, SurfaceCollection* fill_surfaces, PerimeterIslandQueue* island_queue)
 {
     this->perimeters.clear();
     this->thin_fills.clear();
@@ -115,6 +115,7 @@ LayerRegion::make_perimeters(const SurfaceCollection &slices, SurfaceCollection*
     g.ext_perimeter_flow    = this->flow(frExternalPerimeter);
     g.overhang_flow         = this->region()->flow(frPerimeter, -1, true, false, -1, *this->layer()->object());
     g.solid_infill_flow     = this->flow(frSolidInfill);
+    g.island_queue          = island_queue;
     
     g.process();
 }
@@ -200,15 +201,19 @@ LayerRegion::process_external_surfaces()
     }
     
     SurfaceCollection top;
-    for (const Surface &surface : surfaces) {
-        if (surface.surface_type != stTop) continue;
-        
-        // give priority to bottom surfaces
-        ExPolygons grown = diff_ex(
-            offset(surface.expolygon, +SCALED_EXTERNAL_INFILL_MARGIN),
-            (Polygons)bottom
-        );
-        top.append(grown, surface);
+    {
+        // bottom surfaces are converted once for all the top surfaces
+        const ClipperExpr bottom_surfaces(bottom.surfaces);
+        for (const Surface &surface : surfaces) {
+            if (surface.surface_type != stTop) continue;
+            
+            // give priority to bottom surfaces
+            ExPolygons grown = ClipperExpr(surface.expolygon)
+                .offset(+SCALED_EXTERNAL_INFILL_MARGIN)
+                .diff(bottom_surfaces)
+                .expolygons();
+            top.append(grown, surface);
+        }
     }
     
     /*  if we're slicing with no infill, we can't extend external surfaces
@@ -233,16 +238,16 @@ LayerRegion::process_external_surfaces()
         std::vector<SurfacesConstPtr> groups;
         tb.group(&groups);
         
+        const ClipperExpr fill_boundaries_paths(fill_boundaries.surfaces);
         for (const SurfacesConstPtr &g : groups) {
             Polygons subject;
             for (const Surface* s : g)
                 append_to(subject, (Polygons)*s);
             
-            ExPolygons expp = intersection_ex(
-                subject,
-                (Polygons)fill_boundaries,
+            ExPolygons expp = ClipperExpr(subject).intersection(
+                fill_boundaries_paths,
                 true // to ensure adjacent expolygons are unified
-            );
+            ).expolygons();
             
             new_surfaces.append(expp, *g.front());
         }
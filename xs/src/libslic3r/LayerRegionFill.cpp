@@ -5,6 +5,10 @@
 #include "Print.hpp"
 #include "PrintConfig.hpp"
 #include "Surface.hpp"
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <boost/thread/tss.hpp>
 
 namespace Slic3r {
 
@@ -21,6 +25,28 @@ struct SurfaceGroupAttrib
     int     pattern;    ///< pattern is of type InfillPattern, -1 for an unset pattern.
 };
 
+/// Hash of the attributes of a surface group, for finding the compatible groups
+struct SurfaceGroupAttribHash
+{
+    size_t operator()(const SurfaceGroupAttrib &attrib) const
+        { return std::hash<float>()(attrib.fw) * 31 + std::hash<int>()(attrib.pattern) * 2 + attrib.is_solid; }
+};
+
+/// Fill generators reused by all the layers processed by a thread, one per pattern,
+/// so that they are allocated once and their caches are kept from one surface to the next.
+static boost::thread_specific_ptr<std::map<InfillPattern, std::unique_ptr<Fill> > > thread_fillers_ptr;
+
+static Fill*
+thread_filler(InfillPattern pattern)
+{
+    if (thread_fillers_ptr.get() == NULL)
+        thread_fillers_ptr.reset(new std::map<InfillPattern, std::unique_ptr<Fill> >());
+    std::unique_ptr<Fill> &filler = (*thread_fillers_ptr)[pattern];
+    if (!filler)
+        filler.reset(Fill::new_from_type(pattern));
+    return filler.get();
+}
+
 /// The LayerRegion at this point of time may contain
 /// surfaces of various types (internal/bridge/top/bottom/solid).
 /// The infills are generated on the groups of surfaces with a compatible type.
@@ -72,24 +98,30 @@ LayerRegion::make_fill()
                     : surface.is_bottom() ? this->region()->config.bottom_infill_pattern.value
                     : ipRectilinear;
             }
-            // Loop through solid groups, find compatible groups and append them to this one.
+            // Loop through solid groups and append each of them to the first compatible group,
+            // compacting the list of groups in place.
+            std::unordered_map<SurfaceGroupAttrib, size_t, SurfaceGroupAttribHash> first_compatible;
+            size_t n = 0;
             for (size_t i = 0; i < groups.size(); ++i) {
-                if (!group_attrib[i].is_solid)
-                    continue;
-                for (size_t j = i + 1; j < groups.size();) {
-                    if (group_attrib[i] == group_attrib[j]) {
+                if (group_attrib[i].is_solid) {
+                    auto it = first_compatible.find(group_attrib[i]);
+                    if (it != first_compatible.end()) {
                         // groups are compatible, merge them
-                        append_to(groups[i], groups[j]);
-                        groups.erase(groups.begin() + j);
-                        group_attrib.erase(group_attrib.begin() + j);
-                    } else {
-                        ++j;
+                        append_to(groups[it->second], groups[i]);
+                        continue;
                     }
+                    first_compatible[group_attrib[i]] = n;
                 }
+                if (n != i)
+                    groups[n] = std::move(groups[i]);
+                ++n;
             }
+            groups.resize(n);
         }
         
         // Give priority to oriented bridges. Process the bridges in the first round, the rest of the surfaces in the 2nd round.
+        // The polygons of the surfaces already processed are accumulated in the same order as surfaces.
+        Polygons processed;
         for (size_t round = 0; round < 2; ++ round) {
             for (std::vector<SurfacesConstPtr>::const_iterator it_group = groups.begin(); it_group != groups.end(); ++ it_group) {
                 const SurfacesConstPtr &group = *it_group;
@@ -106,8 +138,10 @@ LayerRegion::make_fill()
                 
                 // subtract any other surface already processed
                 //FIXME Vojtech: Because the bridge surfaces came first, they are subtracted twice!
+                const ExPolygons expp = diff_ex(union_p, processed, true);
+                append_to(processed, to_polygons(expp));
                 surfaces.append(
-                    diff_ex(union_p, to_polygons(surfaces), true),
+                    expp,
                     *group.front()  // template
                 );
             }
@@ -158,6 +192,7 @@ LayerRegion::make_fill()
 //        );
     }
 
+    const BoundingBox object_bb = this->layer()->object()->bounding_box();
     for (Surfaces::const_iterator surface_it = surfaces.surfaces.begin();
         surface_it != surfaces.surfaces.end(); ++surface_it) {
         
@@ -181,21 +216,13 @@ LayerRegion::make_fill()
             continue;
         
         // get filler object
-        #if SLIC3R_CPPVER >= 11
-            std::unique_ptr<Fill> f = std::unique_ptr<Fill>(Fill::new_from_type(fill_pattern));
-        #else
-            std::auto_ptr<Fill> f = std::auto_ptr<Fill>(Fill::new_from_type(fill_pattern));
-        #endif
+        Fill* f = thread_filler(fill_pattern);
         
         // switch to rectilinear if this pattern doesn't support solid infill
         if (density > 99 && !f->can_solid())
-            #if SLIC3R_CPPVER >= 11
-                f = std::unique_ptr<Fill>(Fill::new_from_type(ipRectilinear));
-            #else
-                f = std::auto_ptr<Fill>(Fill::new_from_type(ipRectilinear));
-            #endif
+            f = thread_filler(ipRectilinear);
         
-        f->bounding_box = this->layer()->object()->bounding_box();
+        f->bounding_box = object_bb;
         
         // calculate the actual flow we'll be using for this infill
         coordf_t h = (surface.thickness == -1) ? this->layer()->height : surface.thickness;
@@ -59,6 +59,8 @@ Model::read_from_file(std::string input_file)
         IO::AMF::read(input_file, &model);
     } else if (boost::algorithm::iends_with(input_file, ".3mf")) {
         IO::TMF::read(input_file, &model);
+    } else if (boost::algorithm::iends_with(input_file, ".snapshot")) {
+        IO::Snapshot::read(input_file, &model);
     } else {
         throw std::runtime_error("Unknown file format");
     }
@@ -1048,6 +1050,20 @@ ModelInstance::transform_mesh(TriangleMesh* mesh, bool dont_translate) const
 
 }
 
+TransformationMatrix
+ModelInstance::transformation() const
+{
+    TransformationMatrix trafo;
+    trafo.rotate(this->x_rotation, X);
+    trafo.rotate(this->y_rotation, Y);
+    trafo.rotate(this->rotation, Z);                // rotate around mesh origin
+
+    Pointf3 scale_versor = this->scaling_vector;
+    scale_versor.scale(this->scaling_factor);
+    trafo.scale(scale_versor);                      // scale around mesh origin
+    return trafo;
+}
+
 BoundingBoxf3 ModelInstance::transform_mesh_bounding_box(const TriangleMesh* mesh, bool dont_translate) const
 {
     // rotate around mesh origin
@@ -539,6 +539,11 @@ class ModelInstance
     /// \param dont_translate bool whether to translate the mesh or not
     void transform_mesh(TriangleMesh* mesh, bool dont_translate = false) const;
 
+    /// Rotation and scaling applied by transform_mesh(mesh, true), to transform a mesh
+    /// without copying it (see TriangleMeshSlicer).
+    /// \return TransformationMatrix the transformation, without any translation
+    TransformationMatrix transformation() const;
+
     /// Calculate a bounding box of a transformed mesh. To be called on an external mesh.
     /// \param mesh TriangleMesh* pointer to the the mesh
     /// \param dont_translate bool whether to translate the bounding box or not
@@ -33,8 +33,14 @@ MultiPoint::translate(const Point &vector)
 void
 MultiPoint::rotate(double angle)
 {
-    double s = sin(angle);
-    double c = cos(angle);
+    this->rotate(cos(angle), sin(angle));
+}
+
+void
+MultiPoint::rotate(double cos_angle, double sin_angle)
+{
+    const double s = sin_angle;
+    const double c = cos_angle;
     for (Points::iterator it = points.begin(); it != points.end(); ++it) {
         double cur_x = (double)it->x;
         double cur_y = (double)it->y;
@@ -21,6 +21,8 @@ class MultiPoint
     void translate(double x, double y);
     void translate(const Point &vector);
     void rotate(double angle);
+    /// Rotates by the angle whose cosine and sine are given, to share them between rotations.
+    void rotate(double cos_angle, double sin_angle);
     void rotate(double angle, const Point &center);
     void reverse();
     Point first_point() const;
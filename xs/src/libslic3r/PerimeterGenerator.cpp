@@ -6,23 +6,121 @@
 
 namespace Slic3r {
 
+void
+PerimeterIslandQueue::process(size_t count, const boost::function<void(size_t)> &func)
+{
+    Job job = { count, 0, 0, &func };
+    boost::unique_lock<boost::mutex> l(this->mutex);
+    this->jobs.push_back(&job);
+    this->cond.notify_all();
+    
+    while (job.next < job.count) {
+        const size_t i = job.next++;
+        l.unlock();
+        func(i);
+        l.lock();
+        ++job.done;
+    }
+    
+    // the helpers only reach the job through the list, wait for the islands they claimed
+    this->jobs.remove(&job);
+    while (job.done < job.count)
+        this->cond.wait(l);
+}
+
+void
+PerimeterIslandQueue::help()
+{
+    boost::unique_lock<boost::mutex> l(this->mutex);
+    while (!this->finished) {
+        Job* job = NULL;
+        for (Job* j : this->jobs) {
+            if (j->next < j->count) {
+                job = j;
+                break;
+            }
+        }
+        if (job == NULL) {
+            this->cond.wait(l);
+            continue;
+        }
+        const size_t i = job->next++;
+        l.unlock();
+        (*job->func)(i);
+        l.lock();
+        ++job->done;
+        this->cond.notify_all();
+    }
+}
+
+void
+PerimeterIslandQueue::finish()
+{
+    boost::lock_guard<boost::mutex> l(this->mutex);
+    this->finished = true;
+    this->cond.notify_all();
+}
+
 void
 PerimeterGenerator::process()
 {
     // other perimeters
     this->_mm3_per_mm           = this->perimeter_flow.mm3_per_mm();
+    
+    // external perimeters
+    this->_ext_mm3_per_mm       = this->ext_perimeter_flow.mm3_per_mm();
+    
+    // overhang perimeters
+    this->_mm3_per_mm_overhang  = this->overhang_flow.mm3_per_mm();
+    
+    // prepare grown lower layer slices for overhang detection
+    if (this->lower_slices != NULL && this->config->overhangs) {
+        // We consider overhang any part where the entire nozzle diameter is not supported by the
+        // lower layer, so we take lower slices and offset them by half the nozzle diameter used 
+        // in the current layer
+        double nozzle_diameter = this->print_config->nozzle_diameter.get_at(this->config->perimeter_extruder-1);
+        
+        this->_lower_slices_p = offset(*this->lower_slices, scale_(+nozzle_diameter/2));
+    }
+    
+    // we need to process each island separately because we might have different
+    // extra perimeters for each one; the islands are independent, so they are processed
+    // in parallel and their results are appended in order
+    std::vector<PerimeterGeneratorIsland> islands(this->slices->surfaces.size());
+    if (this->island_queue != NULL && islands.size() > 1) {
+        this->island_queue->process(
+            islands.size(),
+            [this, &islands](size_t i) { this->_process_island(i, &islands); }
+        );
+    } else {
+        for (size_t i = 0; i < islands.size(); ++i)
+            this->_process_island(i, &islands);
+    }
+    
+    for (std::vector<PerimeterGeneratorIsland>::const_iterator island = islands.begin(); island != islands.end(); ++island) {
+        // append perimeters for this slice as a collection
+        if (!island->loops.empty())
+            this->loops->append(island->loops);
+        this->gap_fill->append(island->gap_fill.entities);
+        this->fill_surfaces->append(island->fill_surfaces, stInternal);  // use a bogus surface type
+    }
+}
+
+void
+PerimeterGenerator::_process_island(size_t i, std::vector<PerimeterGeneratorIsland>* islands) const
+{
+    const Surface* surface = &this->slices->surfaces[i];
+    PerimeterGeneratorIsland &island = (*islands)[i];
+    
+    // other perimeters
     coord_t pwidth              = this->perimeter_flow.scaled_width();
     coord_t pspacing            = this->perimeter_flow.scaled_spacing();
     
     // external perimeters
-    this->_ext_mm3_per_mm       = this->ext_perimeter_flow.mm3_per_mm();
     coord_t ext_pwidth          = this->ext_perimeter_flow.scaled_width();
     coord_t ext_pspacing        = this->ext_perimeter_flow.scaled_spacing();
     coord_t ext_pspacing2       = this->ext_perimeter_flow.scaled_spacing(this->perimeter_flow);
     
-    // overhang perimeters
-    this->_mm3_per_mm_overhang  = this->overhang_flow.mm3_per_mm();
-    
     // solid infill
     coord_t ispacing            = this->solid_infill_flow.scaled_spacing();
     
@@ -39,285 +137,279 @@ PerimeterGenerator::process()
     coord_t min_spacing         = pspacing      * (1 - INSET_OVERLAP_TOLERANCE);
     coord_t ext_min_spacing     = ext_pspacing  * (1 - INSET_OVERLAP_TOLERANCE);
     
-    // prepare grown lower layer slices for overhang detection
-    if (this->lower_slices != NULL && this->config->overhangs) {
-        // We consider overhang any part where the entire nozzle diameter is not supported by the
-        // lower layer, so we take lower slices and offset them by half the nozzle diameter used 
-        // in the current layer
-        double nozzle_diameter = this->print_config->nozzle_diameter.get_at(this->config->perimeter_extruder-1);
-        
-        this->_lower_slices_p = offset(*this->lower_slices, scale_(+nozzle_diameter/2));
-    }
+    // detect how many perimeters must be generated for this island
+    const int loop_number = this->config->perimeters + surface->extra_perimeters -1;  // 0-indexed loops
     
-    // we need to process each island separately because we might have different
-    // extra perimeters for each one
-    for (Surfaces::const_iterator surface = this->slices->surfaces.begin();
-        surface != this->slices->surfaces.end(); ++surface) {
-        // detect how many perimeters must be generated for this island
-        const int loop_number = this->config->perimeters + surface->extra_perimeters -1;  // 0-indexed loops
+    // The geometry is kept as Clipper paths across all the loop depths and the gap detection,
+    // it is only converted to Slic3r polygons for the loops themselves.
+    // The offsets work directly in Slic3r units (1 unit = 1nm), so the chained paths are not
+    // scaled and truncated by CLIPPER_OFFSET_SCALE by each operation.
+    const double clipper_scale = 1;
+    ClipperLib::Paths gaps;
+    
+    ClipperLib::Paths last = Slic3rMultiPoints_to_ClipperPaths(surface->expolygon.simplify_p(SCALED_RESOLUTION));
+    if (loop_number >= 0) {  // no loops = -1
         
-        Polygons gaps;
+        std::vector<PerimeterGeneratorLoops> contours(loop_number+1);    // depth => loops
+        std::vector<PerimeterGeneratorLoops> holes(loop_number+1);       // depth => loops
+        ThickPolylines thin_walls;
         
-        Polygons last = surface->expolygon.simplify_p(SCALED_RESOLUTION);
-        if (loop_number >= 0) {  // no loops = -1
-            
-            std::vector<PerimeterGeneratorLoops> contours(loop_number+1);    // depth => loops
-            std::vector<PerimeterGeneratorLoops> holes(loop_number+1);       // depth => loops
-            ThickPolylines thin_walls;
-            
-            // we loop one time more than needed in order to find gaps after the last perimeter was applied
-            for (int i = 0; i <= loop_number+1; ++i) {  // outer loop is 0
-                Polygons offsets;
-                if (i == 0) {
-                    // the minimum thickness of a single loop is:
-                    // ext_width/2 + ext_spacing/2 + spacing/2 + width/2
-                    if (this->config->thin_walls) {
-                        offsets = offset2(
-                            last,
-                            -(ext_pwidth/2 + ext_min_spacing/2 - 1),
-                            +(ext_min_spacing/2 - 1)
-                        );
-                    } else {
-                        offsets = offset(last, -ext_pwidth/2);
-                    }
-                    
-                    // look for thin walls
-                    if (this->config->thin_walls) {
-                        Polygons diffpp = diff(
-                            last,
-                            offset(offsets, +ext_pwidth/2),
-                            true  // medial axis requires non-overlapping geometry
-                        );
-                        
-                        // the following offset2 ensures almost nothing in @thin_walls is narrower than $min_width
-                        // (actually, something larger than that still may exist due to mitering or other causes)
-                        coord_t min_width = scale_(this->ext_perimeter_flow.nozzle_diameter / 3);
-                        ExPolygons expp = offset2_ex(diffpp, -min_width/2, +min_width/2);
-                        
-                        // the maximum thickness of our thin wall area is equal to the minimum thickness of a single loop
-                        for (ExPolygons::const_iterator ex = expp.begin(); ex != expp.end(); ++ex)
-                            ex->medial_axis(ext_pwidth + ext_pspacing2, min_width, &thin_walls);
-                        
-                        #ifdef DEBUG
-                        printf("  %zu thin walls detected\n", thin_walls.size());
-                        #endif
-                        
-                        /*
-                        if (false) {
-                            require "Slic3r/SVG.pm";
-                            Slic3r::SVG::output(
-                                "medial_axis.svg",
-                                no_arrows       => 1,
-                                #expolygons      => \@expp,
-                                polylines       => \@thin_walls,
-                            );
-                        }
-                        */
-                    }
+        // we loop one time more than needed in order to find gaps after the last perimeter was applied
+        for (int i = 0; i <= loop_number+1; ++i) {  // outer loop is 0
+            ClipperLib::Paths offsets;
+            if (i == 0) {
+                // the minimum thickness of a single loop is:
+                // ext_width/2 + ext_spacing/2 + spacing/2 + width/2
+                if (this->config->thin_walls) {
+                    offsets = _offset2(
+                        last,
+                        -(ext_pwidth/2 + ext_min_spacing/2 - 1),
+                        +(ext_min_spacing/2 - 1),
+                        clipper_scale
+                    );
                 } else {
-                    //FIXME Is this offset correct if the line width of the inner perimeters differs
-                    // from the line width of the infill?
-                    coord_t distance = (i == 1) ? ext_pspacing2 : pspacing;
+                    offsets = _offset(last, ClipperLib::etClosedPolygon, -ext_pwidth/2, clipper_scale);
+                }
+                
+                // look for thin walls
+                if (this->config->thin_walls) {
+                    ClipperLib::Paths diffpp = _clipper(
+                        ClipperLib::ctDifference,
+                        last,
+                        _offset(offsets, ClipperLib::etClosedPolygon, +ext_pwidth/2, clipper_scale),
+                        true  // medial axis requires non-overlapping geometry
+                    );
                     
-                    if (this->config->thin_walls) {
-                        // This path will ensure, that the perimeters do not overfill, as in 
-                        // prusa3d/Slic3r GH #32, but with the cost of rounding the perimeters
-                        // excessively, creating gaps, which then need to be filled in by the not very 
-                        // reliable gap fill algorithm.
-                        // Also the offset2(perimeter, -x, x) may sometimes lead to a perimeter, which is larger than
-                        // the original.
-                        offsets = offset2(
-                            last,
-                            -(distance + min_spacing/2 - 1),
-                            +(min_spacing/2 - 1)
-                        );
-                    } else {
-                        // If "detect thin walls" is not enabled, this paths will be entered, which 
-                        // leads to overflows, as in prusa3d/Slic3r GH #32
-                        offsets = offset(
-                            last,
-                            -distance
-                        );
-                    }
+                    // the following offset2 ensures almost nothing in @thin_walls is narrower than $min_width
+                    // (actually, something larger than that still may exist due to mitering or other causes)
+                    coord_t min_width = scale_(this->ext_perimeter_flow.nozzle_diameter / 3);
+                    ExPolygons expp = ClipperPaths_to_Slic3rExPolygons(
+                        _offset2(diffpp, -min_width/2, +min_width/2, clipper_scale)
+                    );
+                    
+                    // the maximum thickness of our thin wall area is equal to the minimum thickness of a single loop
+                    for (ExPolygons::const_iterator ex = expp.begin(); ex != expp.end(); ++ex)
+                        ex->medial_axis(ext_pwidth + ext_pspacing2, min_width, &thin_walls);
                     
-                    // look for gaps
-                    if (this->config->fill_gaps && this->config->fill_density.value > 0) {
-                        // not using safety offset here would "detect" very narrow gaps
-                        // (but still long enough to escape the area threshold) that gap fill
-                        // won't be able to fill but we'd still remove from infill area
-                        Polygons diff_pp = diff(
-                            offset(last, -0.5*distance),
-                            offset(offsets, +0.5*distance + 10)  // safety offset
+                    #ifdef DEBUG
+                    printf("  %zu thin walls detected\n", thin_walls.size());
+                    #endif
+                    
+                    /*
+                    if (false) {
+                        require "Slic3r/SVG.pm";
+                        Slic3r::SVG::output(
+                            "medial_axis.svg",
+                            no_arrows       => 1,
+                            #expolygons      => \@expp,
+                            polylines       => \@thin_walls,
                         );
-                        gaps.insert(gaps.end(), diff_pp.begin(), diff_pp.end());
                     }
+                    */
                 }
+            } else {
+                //FIXME Is this offset correct if the line width of the inner perimeters differs
+                // from the line width of the infill?
+                coord_t distance = (i == 1) ? ext_pspacing2 : pspacing;
                 
-                if (offsets.empty()) break;
-                if (i > loop_number) break; // we were only looking for gaps this time
+                if (this->config->thin_walls) {
+                    // This path will ensure, that the perimeters do not overfill, as in 
+                    // prusa3d/Slic3r GH #32, but with the cost of rounding the perimeters
+                    // excessively, creating gaps, which then need to be filled in by the not very 
+                    // reliable gap fill algorithm.
+                    // Also the offset2(perimeter, -x, x) may sometimes lead to a perimeter, which is larger than
+                    // the original.
+                    offsets = _offset2(
+                        last,
+                        -(distance + min_spacing/2 - 1),
+                        +(min_spacing/2 - 1),
+                        clipper_scale
+                    );
+                } else {
+                    // If "detect thin walls" is not enabled, this paths will be entered, which 
+                    // leads to overflows, as in prusa3d/Slic3r GH #32
+                    offsets = _offset(
+                        last,
+                        ClipperLib::etClosedPolygon,
+                        -distance,
+                        clipper_scale
+                    );
+                }
                 
-                last = offsets;
-                for (Polygons::const_iterator polygon = offsets.begin(); polygon != offsets.end(); ++polygon) {
-                    PerimeterGeneratorLoop loop(*polygon, i);
-                    loop.is_contour = polygon->is_counter_clockwise();
-                    if (loop.is_contour) {
-                        contours[i].push_back(loop);
-                    } else {
-                        holes[i].push_back(loop);
-                    }
+                // look for gaps
+                if (this->config->fill_gaps && this->config->fill_density.value > 0) {
+                    // not using safety offset here would "detect" very narrow gaps
+                    // (but still long enough to escape the area threshold) that gap fill
+                    // won't be able to fill but we'd still remove from infill area
+                    ClipperLib::Paths diff_pp = _clipper(
+                        ClipperLib::ctDifference,
+                        _offset(last, ClipperLib::etClosedPolygon, -0.5*distance, clipper_scale),
+                        _offset(offsets, ClipperLib::etClosedPolygon, +0.5*distance + 10, clipper_scale)  // safety offset
+                    );
+                    gaps.insert(gaps.end(), diff_pp.begin(), diff_pp.end());
                 }
             }
             
-            // nest loops: holes first
-            for (int d = 0; d <= loop_number; ++d) {
-                PerimeterGeneratorLoops &holes_d = holes[d];
-                
-                // loop through all holes having depth == d
-                for (int i = 0; i < (int)holes_d.size(); ++i) {
-                    const PerimeterGeneratorLoop &loop = holes_d[i];
-                    
-                    // find the hole loop that contains this one, if any
-                    for (int t = d+1; t <= loop_number; ++t) {
-                        for (int j = 0; j < (int)holes[t].size(); ++j) {
-                            PerimeterGeneratorLoop &candidate_parent = holes[t][j];
-                            if (candidate_parent.polygon.contains(loop.polygon.first_point())) {
-                                candidate_parent.children.push_back(loop);
-                                holes_d.erase(holes_d.begin() + i);
-                                --i;
-                                goto NEXT_LOOP;
-                            }
-                        }
-                    }
-                    
-                    // if no hole contains this hole, find the contour loop that contains it
-                    for (int t = loop_number; t >= 0; --t) {
-                        for (int j = 0; j < (int)contours[t].size(); ++j) {
-                            PerimeterGeneratorLoop &candidate_parent = contours[t][j];
-                            if (candidate_parent.polygon.contains(loop.polygon.first_point())) {
-                                candidate_parent.children.push_back(loop);
-                                holes_d.erase(holes_d.begin() + i);
-                                --i;
-                                goto NEXT_LOOP;
-                            }
-                        }
-                    }
-                    NEXT_LOOP: ;
+            if (offsets.empty()) break;
+            if (i > loop_number) break; // we were only looking for gaps this time
+            
+            last = offsets;
+            for (ClipperLib::Paths::const_iterator path = offsets.begin(); path != offsets.end(); ++path) {
+                PerimeterGeneratorLoop loop(ClipperPath_to_Slic3rMultiPoint<Polygon>(*path), i);
+                loop.is_contour = loop.polygon.is_counter_clockwise();
+                if (loop.is_contour) {
+                    contours[i].push_back(loop);
+                } else {
+                    holes[i].push_back(loop);
                 }
             }
+        }
         
-            // nest contour loops
-            for (int d = loop_number; d >= 1; --d) {
-                PerimeterGeneratorLoops &contours_d = contours[d];
+        // nest loops: holes first
+        for (int d = 0; d <= loop_number; ++d) {
+            PerimeterGeneratorLoops &holes_d = holes[d];
+            
+            // loop through all holes having depth == d
+            for (int i = 0; i < (int)holes_d.size(); ++i) {
+                const PerimeterGeneratorLoop &loop = holes_d[i];
                 
-                // loop through all contours having depth == d
-                for (int i = 0; i < (int)contours_d.size(); ++i) {
-                    const PerimeterGeneratorLoop &loop = contours_d[i];
+                // find the hole loop that contains this one, if any
+                for (int t = d+1; t <= loop_number; ++t) {
+                    for (int j = 0; j < (int)holes[t].size(); ++j) {
+                        PerimeterGeneratorLoop &candidate_parent = holes[t][j];
+                        if (candidate_parent.polygon.contains(loop.polygon.first_point())) {
+                            candidate_parent.children.push_back(loop);
+                            holes_d.erase(holes_d.begin() + i);
+                            --i;
+                            goto NEXT_LOOP;
+                        }
+                    }
+                }
                 
-                    // find the contour loop that contains it
-                    for (int t = d-1; t >= 0; --t) {
-                        for (size_t j = 0; j < contours[t].size(); ++j) {
-                            PerimeterGeneratorLoop &candidate_parent = contours[t][j];
-                            if (candidate_parent.polygon.contains(loop.polygon.first_point())) {
-                                candidate_parent.children.push_back(loop);
-                                contours_d.erase(contours_d.begin() + i);
-                                --i;
-                                goto NEXT_CONTOUR;
-                            }
+                // if no hole contains this hole, find the contour loop that contains it
+                for (int t = loop_number; t >= 0; --t) {
+                    for (int j = 0; j < (int)contours[t].size(); ++j) {
+                        PerimeterGeneratorLoop &candidate_parent = contours[t][j];
+                        if (candidate_parent.polygon.contains(loop.polygon.first_point())) {
+                            candidate_parent.children.push_back(loop);
+                            holes_d.erase(holes_d.begin() + i);
+                            --i;
+                            goto NEXT_LOOP;
                         }
                     }
-                    
-                    NEXT_CONTOUR: ;
                 }
+                NEXT_LOOP: ;
             }
-        
-            // at this point, all loops should be in contours[0]
-            
-            ExtrusionEntityCollection entities = this->_traverse_loops(contours.front(), thin_walls);
-            
-            // if brim will be printed, reverse the order of perimeters so that
-            // we continue inwards after having finished the brim
-            // TODO: add test for perimeter order
-            if (this->config->external_perimeters_first
-                || (this->layer_id == 0 && this->print_config->brim_width.value > 0))
-                    entities.reverse();
-            
-            // append perimeters for this slice as a collection
-            if (!entities.empty())
-                this->loops->append(entities);
         }
-        
-        // fill gaps
-        if (!gaps.empty()) {
-            /*
-            SVG svg("gaps.svg");
-            svg.draw(union_ex(gaps));
-            svg.Close();
-            */
-            
-            // collapse 
-            double min = 0.2*pwidth * (1 - INSET_OVERLAP_TOLERANCE);
-            double max = 2*pspacing;
-            ExPolygons gaps_ex = diff_ex(
-                offset2(gaps, -min/2, +min/2),
-                offset2(gaps, -max/2, +max/2),
-                true
-            );
+    
+        // nest contour loops
+        for (int d = loop_number; d >= 1; --d) {
+            PerimeterGeneratorLoops &contours_d = contours[d];
             
-            ThickPolylines polylines;
-            for (ExPolygons::const_iterator ex = gaps_ex.begin(); ex != gaps_ex.end(); ++ex)
-                ex->medial_axis(max, min, &polylines);
+            // loop through all contours having depth == d
+            for (int i = 0; i < (int)contours_d.size(); ++i) {
+                const PerimeterGeneratorLoop &loop = contours_d[i];
             
-            if (!polylines.empty()) {
-                ExtrusionEntityCollection gap_fill = this->_variable_width(polylines, 
-                    erGapFill, this->solid_infill_flow);
+                // find the contour loop that contains it
+                for (int t = d-1; t >= 0; --t) {
+                    for (size_t j = 0; j < contours[t].size(); ++j) {
+                        PerimeterGeneratorLoop &candidate_parent = contours[t][j];
+                        if (candidate_parent.polygon.contains(loop.polygon.first_point())) {
+                            candidate_parent.children.push_back(loop);
+                            contours_d.erase(contours_d.begin() + i);
+                            --i;
+                            goto NEXT_CONTOUR;
+                        }
+                    }
+                }
                 
-                this->gap_fill->append(gap_fill.entities);
-            
-                /*  Make sure we don't infill narrow parts that are already gap-filled
-                    (we only consider this surface's gaps to reduce the diff() complexity).
-                    Growing actual extrusions ensures that gaps not filled by medial axis
-                    are not subtracted from fill surfaces (they might be too short gaps
-                    that medial axis skips but infill might join with other infill regions
-                    and use zigzag).  */
-                //FIXME Vojtech: This grows by a rounded extrusion width, not by line spacing,
-                // therefore it may cover the area, but no the volume.
-                last = diff(last, gap_fill.grow());
+                NEXT_CONTOUR: ;
             }
         }
+    
+        // at this point, all loops should be in contours[0]
         
-        // create one more offset to be used as boundary for fill
-        // we offset by half the perimeter spacing (to get to the actual infill boundary)
-        // and then we offset back and forth by half the infill spacing to only consider the
-        // non-collapsing regions
-        coord_t inset = 0;
-        if (loop_number == 0) {
-            // one loop
-            inset += ext_pspacing2/2;
-        } else if (loop_number > 0) {
-            // two or more loops
-            inset += pspacing/2;
-        }
+        ExtrusionEntityCollection entities = this->_traverse_loops(contours.front(), thin_walls);
         
-        {
-            ExPolygons expp = union_ex(last);
-            
-            // simplify infill contours according to resolution
-            Polygons pp;
-            for (ExPolygons::const_iterator ex = expp.begin(); ex != expp.end(); ++ex)
-                ex->simplify_p(SCALED_RESOLUTION, &pp);
+        // if brim will be printed, reverse the order of perimeters so that
+        // we continue inwards after having finished the brim
+        // TODO: add test for perimeter order
+        if (this->config->external_perimeters_first
+            || (this->layer_id == 0 && this->print_config->brim_width.value > 0))
+                entities.reverse();
+        
+        island.loops.swap(entities);
+    }
+    
+    // fill gaps
+    if (!gaps.empty()) {
+        /*
+        SVG svg("gaps.svg");
+        svg.draw(union_ex(gaps));
+        svg.Close();
+        */
+        
+        // collapse 
+        double min = 0.2*pwidth * (1 - INSET_OVERLAP_TOLERANCE);
+        double max = 2*pspacing;
+        ExPolygons gaps_ex = _clipper_ex(
+            ClipperLib::ctDifference,
+            _offset2(gaps, -min/2, +min/2, clipper_scale),
+            _offset2(gaps, -max/2, +max/2, clipper_scale),
+            true
+        );
+        
+        ThickPolylines polylines;
+        for (ExPolygons::const_iterator ex = gaps_ex.begin(); ex != gaps_ex.end(); ++ex)
+            ex->medial_axis(max, min, &polylines);
+        
+        if (!polylines.empty()) {
+            ExtrusionEntityCollection gap_fill = this->_variable_width(polylines, 
+                erGapFill, this->solid_infill_flow);
             
-            // collapse too narrow infill areas
-            coord_t min_perimeter_infill_spacing = ispacing * (1 - INSET_OVERLAP_TOLERANCE);
-            expp = offset2_ex(
-                pp,
-                -inset -min_perimeter_infill_spacing/2,
-                +min_perimeter_infill_spacing/2
-            );
+            /*  Make sure we don't infill narrow parts that are already gap-filled
+                (we only consider this surface's gaps to reduce the diff() complexity).
+                Growing actual extrusions ensures that gaps not filled by medial axis
+                are not subtracted from fill surfaces (they might be too short gaps
+                that medial axis skips but infill might join with other infill regions
+                and use zigzag).  */
+            //FIXME Vojtech: This grows by a rounded extrusion width, not by line spacing,
+            // therefore it may cover the area, but no the volume.
+            last = _clipper(ClipperLib::ctDifference, last, Slic3rMultiPoints_to_ClipperPaths(gap_fill.grow()));
             
-            // append infill areas to fill_surfaces
-            this->fill_surfaces->append(expp, stInternal);  // use a bogus surface type
+            island.gap_fill.swap(gap_fill);
         }
     }
+    
+    // create one more offset to be used as boundary for fill
+    // we offset by half the perimeter spacing (to get to the actual infill boundary)
+    // and then we offset back and forth by half the infill spacing to only consider the
+    // non-collapsing regions
+    coord_t inset = 0;
+    if (loop_number == 0) {
+        // one loop
+        inset += ext_pspacing2/2;
+    } else if (loop_number > 0) {
+        // two or more loops
+        inset += pspacing/2;
+    }
+    
+    {
+        ExPolygons expp = _clipper_ex(ClipperLib::ctUnion, last, ClipperLib::Paths());
+        
+        // simplify infill contours according to resolution
+        Polygons pp;
+        for (ExPolygons::const_iterator ex = expp.begin(); ex != expp.end(); ++ex)
+            ex->simplify_p(SCALED_RESOLUTION, &pp);
+        
+        // collapse too narrow infill areas
+        coord_t min_perimeter_infill_spacing = ispacing * (1 - INSET_OVERLAP_TOLERANCE);
+        island.fill_surfaces = offset2_ex(
+            pp,
+            -inset -min_perimeter_infill_spacing/2,
+            +min_perimeter_infill_spacing/2
+        );
+    }
 }
 
 ExtrusionEntityCollection
@@ -2,8 +2,12 @@
 #define slic3r_PerimeterGenerator_hpp_
 
 #include "libslic3r.h"
+#include <list>
 #include <vector>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
 #include "ExPolygonCollection.hpp"
+#include "ExtrusionEntityCollection.hpp"
 #include "Flow.hpp"
 #include "Polygon.hpp"
 #include "PrintConfig.hpp"
@@ -35,6 +39,40 @@ public:
 
 typedef std::vector<PerimeterGeneratorLoop> PerimeterGeneratorLoops;
 
+// Islands of the layers whose perimeters are being generated, shared by the threads
+// working on an object: a thread without a layer left helps with the islands of the
+// layers still in progress instead of exiting.
+class PerimeterIslandQueue {
+public:
+    PerimeterIslandQueue() : finished(false) {};
+    // Calls func for the islands 0..count-1, both from this thread and from the helpers.
+    // Returns once all of them are processed.
+    void process(size_t count, const boost::function<void(size_t)> &func);
+    // Processes the islands queued by other threads until finish() is called.
+    void help();
+    // Releases the helpers once no more islands will be queued.
+    void finish();
+    
+private:
+    struct Job {
+        size_t count;
+        size_t next;    // first island not claimed yet
+        size_t done;
+        const boost::function<void(size_t)>* func;
+    };
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    std::list<Job*> jobs;
+    bool finished;
+};
+
+// Output of the perimeter generation of a single island.
+struct PerimeterGeneratorIsland {
+    ExtrusionEntityCollection loops;
+    ExtrusionEntityCollection gap_fill;
+    ExPolygons fill_surfaces;
+};
+
 class PerimeterGenerator {
 public:
     // Inputs:
@@ -49,6 +87,8 @@ public:
     PrintRegionConfig* config;
     PrintObjectConfig* object_config;
     PrintConfig* print_config;
+    // Queue sharing the islands with other threads, NULL to process them in this thread only.
+    PerimeterIslandQueue* island_queue;
     // Outputs:
     ExtrusionEntityCollection* loops;
     ExtrusionEntityCollection* gap_fill;
@@ -72,7 +112,7 @@ public:
         : slices(slices), lower_slices(NULL), layer_height(layer_height),
             layer_id(-1), perimeter_flow(flow), ext_perimeter_flow(flow),
             overhang_flow(flow), solid_infill_flow(flow),
-            config(config), object_config(object_config), print_config(print_config),
+            config(config), object_config(object_config), print_config(print_config), island_queue(NULL),
             loops(loops), gap_fill(gap_fill), fill_surfaces(fill_surfaces),
             _ext_mm3_per_mm(-1), _mm3_per_mm(-1), _mm3_per_mm_overhang(-1)
         {};
@@ -84,6 +124,7 @@ public:
     double _mm3_per_mm_overhang;
     Polygons _lower_slices_p;
     
+    void _process_island(size_t i, std::vector<PerimeterGeneratorIsland>* islands) const;
     ExtrusionEntityCollection _traverse_loops(const PerimeterGeneratorLoops &loops,
         ThickPolylines &thin_walls) const;
     ExtrusionEntityCollection _variable_width
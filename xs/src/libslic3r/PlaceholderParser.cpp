@@ -1,8 +1,12 @@
 #include "PlaceholderParser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
+#include <boost/thread/tss.hpp>
 #ifdef _MSC_VER
     #include <stdlib.h>  // provides **_environ
 #else
@@ -23,6 +27,76 @@
 
 namespace Slic3r {
 
+/// Maximum number of compiled templates kept by each thread.
+#define PLACEHOLDER_TEMPLATE_CACHE_SIZE 256
+
+PlaceholderTemplate::PlaceholderTemplate(const std::string &str)
+{
+    PlaceholderTemplate::parse(str, 0, false, &this->tokens);
+}
+
+// Parse text and placeholders starting at pos, up to the end of the string or, if nested,
+// up to the closing bracket of the enclosing placeholder. Returns the position where parsing stopped.
+size_t
+PlaceholderTemplate::parse(const std::string &str, size_t pos, bool nested, std::vector<Token>* tokens)
+{
+    while (pos < str.size()) {
+        size_t next = str.find_first_of(nested ? "[]" : "[", pos);
+        if (next == std::string::npos) next = str.size();
+        PlaceholderTemplate::append_text(tokens, str.substr(pos, next - pos));
+        pos = next;
+        if (pos == str.size() || str[pos] == ']') break;
+        
+        std::vector<Token> key;
+        size_t end = PlaceholderTemplate::parse(str, pos + 1, true, &key);
+        if (end == str.size()) {
+            // no closing bracket: keep the opening one as text
+            PlaceholderTemplate::append_text(tokens, "[");
+            for (std::vector<Token>::const_iterator it = key.begin(); it != key.end(); ++it) {
+                if (it->type == Token::tText)
+                    PlaceholderTemplate::append_text(tokens, it->text);
+                else
+                    tokens->push_back(*it);
+            }
+        } else if (key.empty()) {
+            PlaceholderTemplate::append_text(tokens, "[]");
+        } else if (key.size() == 1 && key.front().type == Token::tText) {
+            Token token(Token::tVariable, key.front().text);
+            PlaceholderTemplate::split_index(token.text, &token.base, &token.index);
+            tokens->push_back(token);
+        } else {
+            Token token(Token::tNested);
+            token.key.swap(key);
+            tokens->push_back(token);
+        }
+        pos = std::min(end + 1, str.size());
+    }
+    return pos;
+}
+
+void
+PlaceholderTemplate::append_text(std::vector<Token>* tokens, const std::string &text)
+{
+    if (text.empty()) return;
+    if (!tokens->empty() && tokens->back().type == Token::tText) {
+        tokens->back().text += text;
+    } else {
+        tokens->push_back(Token(Token::tText, text));
+    }
+}
+
+void
+PlaceholderTemplate::split_index(const std::string &name, std::string* base, int* index)
+{
+    *index = -1;
+    size_t pos = name.rfind('_');
+    if (pos == std::string::npos || pos + 1 == name.size()) return;
+    for (size_t i = pos + 1; i < name.size(); ++i)
+        if (!isdigit(static_cast<unsigned char>(name[i]))) return;
+    *base = name.substr(0, pos);
+    *index = atoi(name.c_str() + pos + 1);
+}
+
 PlaceholderParser::PlaceholderParser()
 {
     this->set("version", SLIC3R_VERSION);
@@ -155,43 +229,120 @@ PlaceholderParser::set(const std::string &key, std::vector<std::string> values)
 std::string
 PlaceholderParser::process(std::string str) const
 {
-    // replace single options, like [foo]
-    for (t_strstr_map::const_iterator it = this->_single.begin(); it != this->_single.end(); ++it) {
-        std::stringstream ss;
-        ss << '[' << it->first << ']';
-        this->find_and_replace(str, ss.str(), it->second);
+    std::shared_ptr<const PlaceholderTemplate> tmpl = PlaceholderParser::compiled(str);
+    std::string out;
+    out.reserve(str.size());
+    std::vector<std::string> expanding;
+    this->render(tmpl->tokens, tmpl->tokens, &expanding, &out);
+    return out;
+}
+
+typedef std::map<std::string, std::shared_ptr<const PlaceholderTemplate> > t_template_cache;
+static boost::thread_specific_ptr<t_template_cache> thread_templates_ptr;
+
+std::shared_ptr<const PlaceholderTemplate>
+PlaceholderParser::compiled(const std::string &str)
+{
+    if (thread_templates_ptr.get() == NULL)
+        thread_templates_ptr.reset(new t_template_cache());
+    t_template_cache &templates = *thread_templates_ptr;
+    t_template_cache::const_iterator it = templates.find(str);
+    if (it != templates.end()) return it->second;
+    
+    if (templates.size() >= PLACEHOLDER_TEMPLATE_CACHE_SIZE) templates.clear();
+    std::shared_ptr<const PlaceholderTemplate> tmpl(new PlaceholderTemplate(str));
+    templates[str] = tmpl;
+    return tmpl;
+}
+
+// root holds the tokens of the whole template, which are searched for the other
+// indices of out of range [foo_N] placeholders
+void
+PlaceholderParser::render(const std::vector<PlaceholderTemplate::Token> &tokens, const std::vector<PlaceholderTemplate::Token> &root,
+    std::vector<std::string>* expanding, std::string* out) const
+{
+    for (const PlaceholderTemplate::Token &token : tokens) {
+        if (token.type == PlaceholderTemplate::Token::tText) {
+            out->append(token.text);
+        } else if (token.type == PlaceholderTemplate::Token::tVariable) {
+            this->render_variable(token.text, token.base, token.index, root, expanding, out);
+        } else {
+            // render the inner placeholders first to get the name of this one
+            std::string name, base;
+            int index;
+            this->render(token.key, root, expanding, &name);
+            PlaceholderTemplate::split_index(name, &base, &index);
+            this->render_variable(name, base, index, root, expanding, out);
+        }
     }
+}
+
+void
+PlaceholderParser::render_variable(const std::string &name, const std::string &base, int index,
+    const std::vector<PlaceholderTemplate::Token> &root, std::vector<std::string>* expanding, std::string* out) const
+{
+    const std::string* value = NULL;
     
-    // replace multiple options like [foo_0] by looping until we have enough values
-    // or until a previous match was found (this handles non-existing indices reasonably
-    // without a regex)
-    for (t_strstrs_map::const_iterator it = this->_multiple.begin(); it != this->_multiple.end(); ++it) {
-        const std::vector<std::string> &values = it->second;
-        bool found = false;
-        for (size_t i = 0; (i < values.size()) || found; ++i) {
-            std::stringstream ss;
-            ss << '[' << it->first << '_' << i << ']';
-            if (i < values.size()) {
-                found = this->find_and_replace(str, ss.str(), values[i]);
+    // single options, like [foo]
+    t_strstr_map::const_iterator it_single = this->_single.find(name);
+    if (it_single != this->_single.end()) {
+        value = &it_single->second;
+    } else if (index >= 0) {
+        // multiple options like [foo_0]
+        t_strstrs_map::const_iterator it_multiple = this->_multiple.find(base);
+        if (it_multiple != this->_multiple.end()) {
+            const std::vector<std::string> &values = it_multiple->second;
+            if ((size_t)index < values.size()) {
+                value = &values[index];
             } else {
-                found = this->find_and_replace(str, ss.str(), values.front());
+                // indices past the last value get the first one, as long as the template
+                // also references all the indices between the last value and this one
+                value = &values.front();
+                for (size_t i = values.size() - 1; i < (size_t)index; ++i) {
+                    std::ostringstream ss;
+                    ss << base << '_' << i;
+                    if (!this->references(root, ss.str())) {
+                        value = NULL;
+                        break;
+                    }
+                }
             }
         }
     }
     
-    return str;
+    if (value == NULL || std::find(expanding->begin(), expanding->end(), name) != expanding->end()) {
+        // leave unknown placeholders untouched, as well as the ones referencing
+        // a variable from its own value
+        out->push_back('[');
+        out->append(name);
+        out->push_back(']');
+    } else if (value->find('[') != std::string::npos) {
+        // expand the placeholders in the value
+        std::shared_ptr<const PlaceholderTemplate> tmpl = PlaceholderParser::compiled(*value);
+        expanding->push_back(name);
+        this->render(tmpl->tokens, tmpl->tokens, expanding, out);
+        expanding->pop_back();
+    } else {
+        out->append(*value);
+    }
 }
 
+// whether the template references the variable name, directly or through a nested placeholder
 bool
-PlaceholderParser::find_and_replace(std::string &source, std::string const &find, std::string const &replace) const
+PlaceholderParser::references(const std::vector<PlaceholderTemplate::Token> &tokens, const std::string &name) const
 {
-    bool found = false;
-    for (std::string::size_type i = 0; (i = source.find(find, i)) != std::string::npos; ) {
-        source.replace(i, find.length(), replace);
-        i += replace.length();
-        found = true;
+    for (const PlaceholderTemplate::Token &token : tokens) {
+        if (token.type == PlaceholderTemplate::Token::tVariable) {
+            if (token.text == name) return true;
+        } else if (token.type == PlaceholderTemplate::Token::tNested) {
+            if (this->references(token.key, name)) return true;
+            std::string key;
+            std::vector<std::string> expanding;
+            this->render(token.key, tokens, &expanding, &key);
+            if (key == name) return true;
+        }
     }
-    return found;
+    return false;
 }
 
 }
@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "PrintConfig.hpp"
@@ -13,6 +14,37 @@ namespace Slic3r {
 typedef std::map<std::string, std::string> t_strstr_map;
 typedef std::map<std::string, std::vector<std::string> > t_strstrs_map;
 
+/// A G-code template parsed once into literal text and placeholder tokens,
+/// so that it can be rendered in a single pass for every new set of values.
+/// Placeholders may be nested ([temperature_[current_extruder]]): the inner ones
+/// are rendered first and their result names the outer placeholder.
+class PlaceholderTemplate
+{
+    public:
+    struct Token {
+        enum Type { tText, tVariable, tNested };
+        Type type;
+        /// Literal text for tText, variable name for tVariable.
+        std::string text;
+        /// For variables of the form [name_N]: the name and index, index is -1 otherwise.
+        std::string base;
+        int index;
+        /// For tNested: tokens rendering the variable name.
+        std::vector<Token> key;
+        
+        Token(Type _type, const std::string &_text = std::string()) : type(_type), text(_text), index(-1) {};
+    };
+    std::vector<Token> tokens;
+    
+    explicit PlaceholderTemplate(const std::string &str);
+    /// Split [name_N] into its name and index.
+    static void split_index(const std::string &name, std::string* base, int* index);
+    
+    private:
+    static size_t parse(const std::string &str, size_t pos, bool nested, std::vector<Token>* tokens);
+    static void append_text(std::vector<Token>* tokens, const std::string &text);
+};
+
 class PlaceholderParser
 {
     public:
@@ -30,7 +62,14 @@ class PlaceholderParser
     std::string process(std::string str) const;
     
     private:
-    bool find_and_replace(std::string &source, std::string const &find, std::string const &replace) const;
+    /// Compiled template of str, from a per-thread cache shared by all the parsers,
+    /// so that the parsers cloned for the per-layer and toolchange G-code reuse them.
+    static std::shared_ptr<const PlaceholderTemplate> compiled(const std::string &str);
+    void render(const std::vector<PlaceholderTemplate::Token> &tokens, const std::vector<PlaceholderTemplate::Token> &root,
+        std::vector<std::string>* expanding, std::string* out) const;
+    void render_variable(const std::string &name, const std::string &base, int index,
+        const std::vector<PlaceholderTemplate::Token> &root, std::vector<std::string>* expanding, std::string* out) const;
+    bool references(const std::vector<PlaceholderTemplate::Token> &tokens, const std::string &name) const;
 };
 
 }
@@ -137,6 +137,7 @@ class Pointf
     void translate(const Vectorf &vector);
     void rotate(double angle);
     void rotate(double angle, const Pointf &center);
+    bool operator==(const Pointf &rhs) const { return this->coincides_with(rhs); }
     bool coincides_with(const Pointf &point) const { return this->x == point.x && this->y == point.y; }
     bool coincides_with_epsilon(const Pointf &point) const;
     Pointf negative() const;
@@ -161,6 +162,7 @@ class Pointf3 : public Pointf
     void translate(double x, double y, double z);
     void rotate_z(double angle);
     void rotate_z(double angle, const Pointf3 &center);
+    bool operator==(const Pointf3 &rhs) const { return this->coincides_with(rhs); }
     bool coincides_with(const Pointf3 &point) const { return this->x == point.x && this->y == point.y && this->z == point.z; }
     bool coincides_with_epsilon(const Pointf3 &point) const;
     double distance_to(const Pointf3 &point) const;
@@ -457,9 +457,11 @@ Print::add_model_object(ModelObject* model_object, int idx)
         PrintRegionConfig config = this->_region_config_from_model_volume(*volume);
         
         // find an existing print region with the same config
+        // (the hashes reject most of the non-matching regions without comparing all options)
         int region_id = -1;
+        const size_t config_hash = config.hash();
         for (PrintRegionPtrs::const_iterator region = this->regions.begin(); region != this->regions.end(); ++region) {
-            if (config.equals((*region)->config)) {
+            if (config_hash == (*region)->config.hash() && config.equals((*region)->config)) {
                 region_id = region - this->regions.begin();
                 break;
             }
@@ -154,6 +154,9 @@ class PrintObject
     std::vector<coordf_t> generate_object_layers(coordf_t first_layer_height);
     void _slice();
     std::vector<ExPolygons> _slice_region(size_t region_id, std::vector<float> z, bool modifier);
+    void _slice_regions(const std::vector<float> &z, std::vector< std::vector<ExPolygons> >* slices,
+        std::vector< std::vector<ExPolygons> >* modifier_slices);
+    TransformationMatrix _slicing_transformation();
     void _make_perimeters();
     void _infill();
     
@@ -163,10 +166,32 @@ class PrintObject
     Schematic* _schematic;  // pointer to electronic parts and routing object in the model_object class
     Points _copies;      // Slic3r::Point objects in scaled G-code coordinates
 
+    // result of a surface processing step on a layer region, with the inputs it was computed
+    // from flattened into a key (geometry, surface attributes and flow parameters)
+    struct SurfacesMemo {
+        bool valid;
+        std::vector<coordf_t> key;
+        SurfaceCollection fill_surfaces;
+        Polygons bridged;
+        Polylines unsupported_bridge_edges;
+        SurfacesMemo() : valid(false) {};
+    };
+    // results of process_external_surfaces() and bridge_over_infill() indexed by layer and region;
+    // they survive the invalidation of the infill preparation, so reprocessing unchanged surfaces
+    // after a config change is skipped, and are released when the object is resliced
+    std::vector< std::vector<SurfacesMemo> > _external_surfaces_memo;
+    std::vector< std::vector<SurfacesMemo> > _bridge_over_infill_memo;
+
     // TODO: call model_object->get_bounding_box() instead of accepting
         // parameter
     PrintObject(Print* print, ModelObject* model_object, const BoundingBoxf3 &modobj_bbox);
     ~PrintObject();
+
+    void _make_wire_extrusions(Layer* layer, const ConfigOptionFloatOrPercent &extrusion_width, float nozzle_diameter);
+    void _resize_memo(std::vector< std::vector<SurfacesMemo> >* memo) const;
+    void _bridge_over_infill(size_t region_id, size_t layer_idx, const std::vector<ClipperExpr> &internal,
+        const std::vector< std::vector<coordf_t> > &fill_surfaces_keys);
+    void _make_dirty_slices();
 };
 
 typedef std::vector<PrintObject*> PrintObjectPtrs;
@@ -1208,6 +1208,48 @@ PrintConfigDef::PrintConfigDef()
     def->min = 0;
     def->default_value = new ConfigOptionFloat(4);
 
+    def = this->add("raster_antialiasing", coInt);
+    def->label = "Anti-aliasing";
+    def->category = "Raster";
+    def->tooltip = "Number of sub-scanlines sampled for each row of pixels when rasterizing SLA layers. Set to 1 to disable anti-aliasing.";
+    def->cli = "raster-antialiasing=i";
+    def->min = 1;
+    def->max = 16;
+    def->default_value = new ConfigOptionInt(4);
+
+    def = this->add("raster_dpi", coFloat);
+    def->label = "Resolution";
+    def->category = "Raster";
+    def->tooltip = "Resolution of the images generated for SLA layers.";
+    def->sidetext = "dpi";
+    def->cli = "raster-dpi=f";
+    def->min = 1;
+    def->default_value = new ConfigOptionFloat(254);
+
+    def = this->add("raster_mirror_x", coBool);
+    def->label = "Mirror horizontally";
+    def->category = "Raster";
+    def->tooltip = "Mirror the images generated for SLA layers horizontally.";
+    def->cli = "raster-mirror-x!";
+    def->default_value = new ConfigOptionBool(false);
+
+    def = this->add("raster_mirror_y", coBool);
+    def->label = "Mirror vertically";
+    def->category = "Raster";
+    def->tooltip = "Mirror the images generated for SLA layers vertically.";
+    def->cli = "raster-mirror-y!";
+    def->default_value = new ConfigOptionBool(false);
+
+    def = this->add("raster_rotation", coInt);
+    def->label = "Rotation";
+    def->category = "Raster";
+    def->tooltip = "Counter-clockwise rotation applied to the images generated for SLA layers. Only multiples of 90 degrees are supported.";
+    def->sidetext = "°";
+    def->cli = "raster-rotation=i";
+    def->min = 0;
+    def->max = 270;
+    def->default_value = new ConfigOptionInt(0);
+
     def = this->add("resolution", coFloat);
     def->label = "Resolution (deprecated)";
     def->tooltip = "Minimum detail resolution, used to simplify the input file for speeding up the slicing job and reducing memory usage. High-resolution models often carry more detail than printers can render. Set to zero to disable any simplification and use full resolution from input.";
@@ -2042,12 +2084,24 @@ CLIConfigDef::CLIConfigDef()
     def->cli = "export-svg";
     def->default_value = new ConfigOptionBool(false);
 
+    def = this->add("export_png", coBool);
+    def->label = "Export PNG";
+    def->tooltip = "Slice the model and export slices as a zip archive of PNG images.";
+    def->cli = "export-png";
+    def->default_value = new ConfigOptionBool(false);
+
     def = this->add("export_3mf", coBool);
     def->label = "Export 3MF";
     def->tooltip = "Slice the model and export slices as 3MF.";
     def->cli = "export-3mf";
     def->default_value = new ConfigOptionBool(false);
     
+    def = this->add("export_snapshot", coBool);
+    def->label = "Export snapshot";
+    def->tooltip = "Export the model as a binary snapshot, which is reloaded without parsing and repairing the meshes again. Snapshots are only readable by builds with the same mesh layout.";
+    def->cli = "export-snapshot";
+    def->default_value = new ConfigOptionBool(false);
+    
     def = this->add("info", coBool);
     def->label = "Output Model Info";
     def->tooltip = "Write information about the model to the console.";
@@ -205,7 +205,7 @@ class PrintObjectConfig : public virtual StaticPrintConfig
             this->set_defaults();
     }
     
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         OPT_PTR(adaptive_slicing);
         OPT_PTR(adaptive_slicing_quality);
         OPT_PTR(conductive_cavity_offset);
@@ -254,6 +254,8 @@ class PrintObjectConfig : public virtual StaticPrintConfig
         
         return NULL;
     };
+    
+    STATIC_CONFIG_INDEX(PrintObjectConfig)
 };
 
 // This object is mapped to Perl as Slic3r::Config::PrintRegion.
@@ -302,7 +304,7 @@ class PrintRegionConfig : public virtual StaticPrintConfig
             this->set_defaults();
     }
     
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         OPT_PTR(bottom_infill_pattern);
         OPT_PTR(bottom_solid_layers);
         OPT_PTR(bridge_flow_ratio);
@@ -342,6 +344,8 @@ class PrintRegionConfig : public virtual StaticPrintConfig
         
         return NULL;
     };
+    
+    STATIC_CONFIG_INDEX(PrintRegionConfig)
 };
 
 // This object is mapped to Perl as Slic3r::Config::GCode.
@@ -391,7 +395,7 @@ class GCodeConfig : public virtual StaticPrintConfig
             this->set_defaults();
     }
     
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         OPT_PTR(before_layer_gcode);
         OPT_PTR(between_objects_gcode);
         OPT_PTR(end_gcode);
@@ -433,6 +437,8 @@ class GCodeConfig : public virtual StaticPrintConfig
         return NULL;
     };
     
+    STATIC_CONFIG_INDEX(GCodeConfig)
+    
     std::string get_extrusion_axis() const
     {
         if ((this->gcode_flavor.value == gcfMach3) || (this->gcode_flavor.value == gcfMachinekit)) {
@@ -510,7 +516,7 @@ class PrintConfig : public GCodeConfig
             this->set_defaults();
     }
     
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         OPT_PTR(avoid_crossing_perimeters);
         OPT_PTR(bed_shape);
         OPT_PTR(has_heatbed);
@@ -569,10 +575,12 @@ class PrintConfig : public GCodeConfig
         
         // look in parent class
         ConfigOption* opt;
-        if ((opt = GCodeConfig::optptr(opt_key, create)) != NULL) return opt;
+        if ((opt = GCodeConfig::_optptr(opt_key)) != NULL) return opt;
         
         return NULL;
     };
+    
+    STATIC_CONFIG_INDEX(PrintConfig)
 };
 
 class HostConfig : public virtual StaticPrintConfig
@@ -589,7 +597,7 @@ class HostConfig : public virtual StaticPrintConfig
             this->set_defaults();
     }
     
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         OPT_PTR(host_type);
         OPT_PTR(print_host);
         OPT_PTR(octoprint_apikey);
@@ -598,6 +606,8 @@ class HostConfig : public virtual StaticPrintConfig
         
         return NULL;
     };
+    
+    STATIC_CONFIG_INDEX(HostConfig)
 };
 
 // This object is mapped to Perl as Slic3r::Config::Full.
@@ -615,14 +625,16 @@ class FullPrintConfig
             this->set_defaults();
     }
 
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         ConfigOption* opt;
-        if ((opt = PrintObjectConfig::optptr(opt_key, create)) != NULL) return opt;
-        if ((opt = PrintRegionConfig::optptr(opt_key, create)) != NULL) return opt;
-        if ((opt = PrintConfig::optptr(opt_key, create)) != NULL) return opt;
-        if ((opt = HostConfig::optptr(opt_key, create)) != NULL) return opt;
+        if ((opt = PrintObjectConfig::_optptr(opt_key)) != NULL) return opt;
+        if ((opt = PrintRegionConfig::_optptr(opt_key)) != NULL) return opt;
+        if ((opt = PrintConfig::_optptr(opt_key)) != NULL) return opt;
+        if ((opt = HostConfig::_optptr(opt_key)) != NULL) return opt;
         return NULL;
     };
+    
+    STATIC_CONFIG_INDEX(FullPrintConfig)
 };
 
 class SLAPrintConfig
@@ -638,12 +650,17 @@ class SLAPrintConfig
     ConfigOptionFloatOrPercent      perimeter_extrusion_width;
     ConfigOptionInt                 raft_layers;
     ConfigOptionFloat               raft_offset;
+    ConfigOptionInt                 raster_antialiasing;
+    ConfigOptionFloat               raster_dpi;
+    ConfigOptionBool                raster_mirror_x;
+    ConfigOptionBool                raster_mirror_y;
+    ConfigOptionInt                 raster_rotation;
     ConfigOptionBool                support_material;
     ConfigOptionFloatOrPercent      support_material_extrusion_width;
     ConfigOptionFloat               support_material_spacing;
     ConfigOptionInt                 threads;
     
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         OPT_PTR(fill_angle);
         OPT_PTR(fill_density);
         OPT_PTR(fill_pattern);
@@ -653,6 +670,11 @@ class SLAPrintConfig
         OPT_PTR(perimeter_extrusion_width);
         OPT_PTR(raft_layers);
         OPT_PTR(raft_offset);
+        OPT_PTR(raster_antialiasing);
+        OPT_PTR(raster_dpi);
+        OPT_PTR(raster_mirror_x);
+        OPT_PTR(raster_mirror_y);
+        OPT_PTR(raster_rotation);
         OPT_PTR(support_material);
         OPT_PTR(support_material_extrusion_width);
         OPT_PTR(support_material_spacing);
@@ -660,6 +682,8 @@ class SLAPrintConfig
         
         return NULL;
     };
+    
+    STATIC_CONFIG_INDEX(SLAPrintConfig)
 };
 
 class CLIConfigDef : public ConfigDef
@@ -681,7 +705,9 @@ class CLIConfig
     ConfigOptionBool                export_obj;
     ConfigOptionBool                export_pov;
     ConfigOptionBool                export_svg;
+    ConfigOptionBool                export_png;
     ConfigOptionBool                export_3mf;
+    ConfigOptionBool                export_snapshot;
     ConfigOptionBool                info;
     ConfigOptionStrings             load;
     ConfigOptionString              output;
@@ -698,7 +724,7 @@ class CLIConfig
         this->set_defaults();
     };
     
-    virtual ConfigOption* optptr(const t_config_option_key &opt_key, bool create = false) {
+    ConfigOption* _optptr(const t_config_option_key &opt_key) {
         OPT_PTR(cut);
         OPT_PTR(cut_grid);
         OPT_PTR(cut_x);
@@ -706,7 +732,9 @@ class CLIConfig
         OPT_PTR(export_obj);
         OPT_PTR(export_pov);
         OPT_PTR(export_svg);
+        OPT_PTR(export_png);
         OPT_PTR(export_3mf);
+        OPT_PTR(export_snapshot);
         OPT_PTR(info);
         OPT_PTR(load);
         OPT_PTR(output);
@@ -720,6 +748,8 @@ class CLIConfig
         
         return NULL;
     };
+    
+    STATIC_CONFIG_INDEX(CLIConfig)
 };
 
 }
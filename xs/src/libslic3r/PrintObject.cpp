@@ -2,11 +2,54 @@
 #include "BoundingBox.hpp"
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
+#include "PerimeterGenerator.hpp"
+#include "Fill/FillPatternCache.hpp"
 #include <algorithm>
+#include <atomic>
 #include <vector>
 
 namespace Slic3r {
 
+// appends the geometry of the polygons to a memo key, each polygon is preceded by its size
+static void
+append_polygons_key(const Polygons &polygons, std::vector<coordf_t>* key)
+{
+    for (const Polygon &polygon : polygons) {
+        key->push_back(polygon.points.size());
+        for (const Point &point : polygon.points) {
+            key->push_back(point.x);
+            key->push_back(point.y);
+        }
+    }
+}
+
+// appends the geometry and the attributes of the surfaces to a memo key
+static void
+append_surfaces_key(const Surfaces &surfaces, std::vector<coordf_t>* key)
+{
+    key->push_back(surfaces.size());
+    for (const Surface &surface : surfaces) {
+        key->push_back(surface.surface_type);
+        key->push_back(surface.thickness);
+        key->push_back(surface.thickness_layers);
+        key->push_back(surface.bridge_angle);
+        key->push_back(surface.extra_perimeters);
+        key->push_back(surface.expolygon.holes.size());
+        append_polygons_key(surface.expolygon, key);
+    }
+}
+
+// appends the geometry of the expolygons to a memo key
+static void
+append_expolygons_key(const ExPolygons &expolygons, std::vector<coordf_t>* key)
+{
+    key->push_back(expolygons.size());
+    for (const ExPolygon &expolygon : expolygons) {
+        key->push_back(expolygon.holes.size());
+        append_polygons_key(expolygon, key);
+    }
+}
+
 PrintObject::PrintObject(Print* print, ModelObject* model_object, const BoundingBoxf3 &modobj_bbox)
 :   typed_slices(false),
     _print(print),
@@ -303,6 +346,9 @@ PrintObject::invalidate_step(PrintObjectStep step)
         this->invalidate_step(posPerimeters);
         this->invalidate_step(posDetectSurfaces);
         this->invalidate_step(posSupportMaterial);
+        // the surfaces memos are keyed on the layers being dropped
+        this->_external_surfaces_memo.clear();
+        this->_bridge_over_infill_memo.clear();
     }else if (step == posLayers) {
         this->invalidate_step(posSlice);
     } else if (step == posSupportMaterial) {
@@ -391,12 +437,7 @@ PrintObject::embed_electronic_parts()
             }
         }
         // make slices by merging all slices from layer regions
-        for(auto &layer : this->layers) {
-            if(layer->isDirty()) {
-                layer->make_slices();
-                layer->setDirty(false);
-            }
-        }
+        this->_make_dirty_slices();
     }
 }
 
@@ -444,17 +485,17 @@ void PrintObject::make_electronic_wires()
             additional_layer->add_region(this->print()->get_region(i));
         }
 
-        // collect unrouted wires (could be parallelized, access to schematic is const
+        // collect unrouted wires for all layers in one sweep over the schematic
+        std::vector<std::pair<double, double> > layer_ranges;
         FOREACH_LAYER(this, layer) {
-            double z_top, z_bottom;
-
-            z_top = (*layer)->print_z;
-            z_bottom = z_top - (*layer)->height;
-            (*layer)->unrouted_wires = this->_schematic->getChannels(z_bottom, z_top, layer_overlap);
+            layer_ranges.push_back(std::make_pair((*layer)->print_z - (*layer)->height, (*layer)->print_z));
+        }
+        std::vector<Polylines> channels = this->_schematic->getChannels(layer_ranges, layer_overlap);
+        for(size_t i = 0; i < this->layers.size(); i++) {
+            this->layers[i]->unrouted_wires = std::move(channels[i]);
 
             // translate to objects origin
-            for(auto &pl : (*layer)->unrouted_wires) {
-            //for (Polylines::iterator pl = channels.begin(); pl != channels.end(); ++pl) {
+            for(auto &pl : this->layers[i]->unrouted_wires) {
                 pl.translate(this->size.x/2, this->size.y/2);
             }
         }
@@ -467,7 +508,8 @@ void PrintObject::make_electronic_wires()
                 conductive_wire_routing_hole_factor,
                 conductive_wire_routing_interlayer_factor,
                 grid_step_size,
-                this->layer_count() + 1);
+                this->layer_count() + 1,
+                this->_print->config.threads.value);
         FOREACH_LAYER(this, layer) {
             ElectronicWireGenerator ewg(
                     (*layer),
@@ -494,84 +536,12 @@ void PrintObject::make_electronic_wires()
         // generate actual wires
         ewr.generate_wires();
 
-        // make beds and channels
-        FOREACH_LAYER(this, layer) {
-/*            // if upper_layer is defined, get channels to create a "bed" by offsetting only a small amount
-            Layer* upper_layer = (*layer)->upper_layer;
-            Polygons bed_polygons;
-            Polygons channel_polygons;
-
-            // generate a bed by offsetting a small amount to trigger perimeter generation
-            if (upper_layer != nullptr) {
-                if(upper_layer->wires.size() > 0) {
-                    bed_polygons = offset(upper_layer->wires, scale_(0.01));
-                    (*layer)->setDirty(true);
-                }
-            }
-
-            // double offsetting for channels. 1 step generates a polygon from the polyline,
-            // 2. step extends the polygon to avoid cropped angles.
-            if((*layer)->wires.size() > 0) {
-                channel_polygons = offset((*layer)->wires, scale_(0.01));
-                //SVG svg2("polygon_low_offset.svg");
-                //svg2.draw(channel_polygons, "red");
-                //svg2.Close();
-                //std::cout << "nr of polygons after polyline offset: " << channel_polygons.size() << std::endl;
-                channel_polygons = offset(channel_polygons, scale_(extrusion_width/2 + conductive_wire_channel_width/2 - 0.01));
-                //SVG svg("polygon.svg");
-                //svg.draw(channel_polygons, "red");
-                //svg.draw(channels, "green");
-                //svg.Close();
-                (*layer)->setDirty(true);
-            }
-
-            // remove beds and channels from layer
-            FOREACH_LAYERREGION((*layer), layerm) {
-                (*layerm)->modify_slices(bed_polygons, false);
-                (*layerm)->modify_slices(channel_polygons, false);
-            }
-*/
-            // create extrusion objects for this layer
-            Flow flow = Flow::new_from_config_width(frConductiveWire, extrusion_width, nozzle_diameter, (*layer)->height, 0);
-            // Currently not using the standard flow object, because the conductive ink can't be modelled as rectangle with semicircles at the end.
-            // Instead, simple use the volume of the rect.
-
-            // clear old wires
-            (*layer)->wire_extrusions.clear();
-
-            // generate extrusion objects for each wire
-            for(auto &channel_pl : (*layer)->wires) {
-                if(channel_pl.points.size() > 1) {
-                    ExtrusionPath path(erConductiveWire);
-                    path.polyline = channel_pl;
-                    path.mm3_per_mm = flow.mm3_per_mm();
-                    //path.mm3_per_mm = extrusion_width * layer->height;
-                    path.width = extrusion_width;
-                    path.height = (*layer)->height;
-                    (*layer)->wire_extrusions.append(path);
-                }
-            }
-
-            // generate contact points for SMD pins
-            for(const auto &part : *partlist) {
-                double print_z = (*layer)->print_z;
-                // use a very high print_z value for last layer to catch all remaining parts
-                if((*layer)->id() == this->layer_count()-1) {
-                    print_z = 999999;
-                }
-
-                Point3s connection_points = part->getConnectionPointsLayer(print_z);
-                for(auto &point : connection_points) {
-                    point.translate(this->size.x/2, this->size.y/2, 0); // translate to objects origin
-                    ExtrusionPoint epoint(erConductiveWire);
-                    epoint.point = point;
-                    //epoint.mm3_per_mm is generated automatically by the ExtrusionPoint object
-                    epoint.width = extrusion_width;
-                    epoint.height = part->getFootprintHeight(); //layer->height;
-                    (*layer)->wire_extrusions.append(epoint);
-                }
-            }
-        }
+        // create extrusion objects for each layer
+        parallelize<Layer*>(
+            std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
+            boost::bind(&Slic3r::PrintObject::_make_wire_extrusions, this, _1, extrusion_width, nozzle_diameter),
+            this->_print->config.threads.value
+        );
 
         // remove top layer if empty
         top_layer = this->layers.back();
@@ -587,23 +557,77 @@ void PrintObject::make_electronic_wires()
         }
 
         // make slices by merging all slices from layer regions
-        for(auto &layer : this->layers) {
-            if(layer->isDirty()) {
-                layer->make_slices();
-                layer->setDirty(false);
-            }
+        this->_make_dirty_slices();
+    }
+}
+
+// create extrusion objects for the wires and SMD contact points of this layer
+void
+PrintObject::_make_wire_extrusions(Layer* layer, const ConfigOptionFloatOrPercent &extrusion_width, float nozzle_diameter)
+{
+    ElectronicParts* partlist = this->_schematic->getPartlist();
+
+    Flow flow = Flow::new_from_config_width(frConductiveWire, extrusion_width, nozzle_diameter, layer->height, 0);
+    // Currently not using the standard flow object, because the conductive ink can't be modelled as rectangle with semicircles at the end.
+    // Instead, simple use the volume of the rect.
+
+    // clear old wires
+    layer->wire_extrusions.clear();
+
+    // generate extrusion objects for each wire
+    for(auto &channel_pl : layer->wires) {
+        if(channel_pl.points.size() > 1) {
+            ExtrusionPath path(erConductiveWire);
+            path.polyline = channel_pl;
+            path.mm3_per_mm = flow.mm3_per_mm();
+            //path.mm3_per_mm = extrusion_width * layer->height;
+            path.width = extrusion_width;
+            path.height = layer->height;
+            layer->wire_extrusions.append(path);
         }
+    }
 
-        // make slices by merging all slices from layer regions
-        for(auto &layer : this->layers) {
-            if(layer->isDirty()) {
-                layer->make_slices();
-                layer->setDirty(false);
-            }
+    // generate contact points for SMD pins
+    for(const auto &part : *partlist) {
+        double print_z = layer->print_z;
+        // use a very high print_z value for last layer to catch all remaining parts
+        if(layer->id() == this->layer_count()-1) {
+            print_z = 999999;
+        }
+
+        Point3s connection_points = part->getConnectionPointsLayer(print_z);
+        for(auto &point : connection_points) {
+            point.translate(this->size.x/2, this->size.y/2, 0); // translate to objects origin
+            ExtrusionPoint epoint(erConductiveWire);
+            epoint.point = point;
+            //epoint.mm3_per_mm is generated automatically by the ExtrusionPoint object
+            epoint.width = extrusion_width;
+            epoint.height = part->getFootprintHeight(); //layer->height;
+            layer->wire_extrusions.append(epoint);
         }
     }
 }
 
+// make slices of all layers marked dirty by merging all slices from layer regions
+void
+PrintObject::_make_dirty_slices()
+{
+    std::queue<Layer*> queue;
+    for(auto &layer : this->layers) {
+        if(layer->isDirty()) {
+            queue.push(layer);
+        }
+    }
+    parallelize<Layer*>(
+        queue,
+        boost::bind(&Slic3r::Layer::make_slices, _1),
+        this->_print->config.threads.value
+    );
+    for(auto &layer : this->layers) {
+        layer->setDirty(false);
+    }
+}
+
 
 bool
 PrintObject::has_support_material() const
@@ -622,11 +646,37 @@ PrintObject::detect_surfaces_type()
     if (this->state.is_done(posDetectSurfaces)) return;
     this->state.set_started(posDetectSurfaces);
     
-    parallelize<Layer*>(
-        std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
-        boost::bind(&Slic3r::Layer::detect_surfaces_type, _1),
-        this->_print->config.threads.value
-    );
+    if (!this->layers.empty()) {
+        // Convert the untyped slices of every layer once. Each layer then reads the snapshots
+        // of its neighbours while it rewrites its own slices, so no locking is needed and the
+        // result does not depend on the order the layers are processed in.
+        std::vector<LayerSlicesSnapshot> snapshots(this->layers.size());
+        parallelize<size_t>(
+            0,
+            this->layers.size()-1,
+            [this, &snapshots](size_t i) {
+                const Layer &layer = *this->layers[i];
+                snapshots[i].slices = ClipperExpr(layer.slices.expolygons);
+                for (const LayerRegion* layerm : layer.regions)
+                    snapshots[i].regions.push_back(ClipperExpr(layerm->slices.surfaces));
+            },
+            this->_print->config.threads.value
+        );
+        
+        parallelize<size_t>(
+            0,
+            this->layers.size()-1,
+            [this, &snapshots](size_t i) {
+                Layer &layer = *this->layers[i];
+                layer.detect_surfaces_type(
+                    layer.lower_layer != NULL ? &snapshots[i-1] : NULL,
+                    snapshots[i],
+                    layer.upper_layer != NULL ? &snapshots[i+1] : NULL
+                );
+            },
+            this->_print->config.threads.value
+        );
+    }
     
     this->typed_slices = true;
     this->state.set_done(posDetectSurfaces);
@@ -635,192 +685,294 @@ PrintObject::detect_surfaces_type()
 void
 PrintObject::process_external_surfaces()
 {
-    parallelize<Layer*>(
-        std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
-        boost::bind(&Slic3r::Layer::process_external_surfaces, _1),
+    if (this->layers.empty()) return;
+    this->_resize_memo(&this->_external_surfaces_memo);
+    
+    // each layer region reads the slices of its layer and of the lower one,
+    // and only writes its own surfaces
+    parallelize<size_t>(
+        0,
+        this->layers.size()-1,
+        [this](size_t i) {
+            const Layer* layer = this->layers[i];
+            std::vector<coordf_t> slices_key;
+            append_expolygons_key(layer->slices.expolygons, &slices_key);
+            slices_key.push_back(layer->lower_layer != NULL);
+            if (layer->lower_layer != NULL)
+                append_expolygons_key(layer->lower_layer->slices.expolygons, &slices_key);
+            
+            for (size_t region_id = 0; region_id < layer->regions.size(); ++region_id) {
+                LayerRegion* layerm = layer->regions[region_id];
+                
+                // the result only depends on the surfaces, the slices and the bridge flow
+                std::vector<coordf_t> key;
+                key.push_back(layerm->flow(frInfill, true).scaled_width());
+                key.push_back(this->config.support_material.value);
+                key.push_back(layerm->region()->config.fill_density.value > 0);
+                append_surfaces_key(layerm->fill_surfaces.surfaces, &key);
+                key.insert(key.end(), slices_key.begin(), slices_key.end());
+                
+                SurfacesMemo &memo = this->_external_surfaces_memo[i][region_id];
+                if (memo.valid && memo.key == key) {
+                    layerm->fill_surfaces = memo.fill_surfaces;
+                    append_to(layerm->bridged, memo.bridged);
+                    layerm->unsupported_bridge_edges.append(memo.unsupported_bridge_edges);
+                    continue;
+                }
+                
+                const size_t bridged     = layerm->bridged.size();
+                const size_t unsupported = layerm->unsupported_bridge_edges.polylines.size();
+                layerm->process_external_surfaces();
+                
+                memo.valid         = true;
+                memo.key.swap(key);
+                memo.fill_surfaces = layerm->fill_surfaces;
+                memo.bridged.assign(layerm->bridged.begin() + bridged, layerm->bridged.end());
+                memo.unsupported_bridge_edges.assign(
+                    layerm->unsupported_bridge_edges.polylines.begin() + unsupported,
+                    layerm->unsupported_bridge_edges.polylines.end());
+            }
+        },
         this->_print->config.threads.value
     );
 }
 
+void
+PrintObject::_resize_memo(std::vector< std::vector<SurfacesMemo> >* memo) const
+{
+    memo->resize(this->layers.size());
+    for (std::vector<SurfacesMemo> &layer_memo : *memo)
+        layer_memo.resize(this->_print->regions.size());
+}
+
 /* This method applies bridge flow to the first internal solid layer above
    sparse infill */
 void
 PrintObject::bridge_over_infill()
 {
-    FOREACH_REGION(this->_print, region) {
-        const size_t region_id = region - this->_print->regions.begin();
-        
+    if (this->layers.size() < 2) return;
+    
+    // Bridging turns the internal solid surfaces of a layer into bridges and leaves
+    // its internal surfaces unchanged, so the internal surfaces of the lower layers are
+    // read-only here and all the layers can be processed in parallel. They are
+    // converted once, and the fill surfaces of each layer are keyed once for the memo.
+    std::vector<ClipperExpr> internal(this->layers.size());
+    std::vector< std::vector<coordf_t> > fill_surfaces_keys(this->layers.size());
+    parallelize<size_t>(
+        0,
+        this->layers.size()-1,
+        [this, &internal, &fill_surfaces_keys](size_t i) {
+            Polygons layer_internal;
+            FOREACH_LAYERREGION(this->layers[i], layerm_it) {
+                (*layerm_it)->fill_surfaces.filter_by_type(stInternal, &layer_internal);
+                append_surfaces_key((*layerm_it)->fill_surfaces.surfaces, &fill_surfaces_keys[i]);
+            }
+            internal[i] = ClipperExpr(layer_internal);
+        },
+        this->_print->config.threads.value
+    );
+    this->_resize_memo(&this->_bridge_over_infill_memo);
+    
+    for (size_t region_id = 0; region_id < this->_print->regions.size(); ++region_id) {
         // skip bridging in case there are no voids
-        if ((*region)->config.fill_density.value == 100) continue;
+        if (this->_print->regions[region_id]->config.fill_density.value == 100) continue;
+        
+        // skip first layer
+        parallelize<size_t>(
+            1,
+            this->layers.size()-1,
+            [this, region_id, &internal, &fill_surfaces_keys](size_t i) {
+                this->_bridge_over_infill(region_id, i, internal, fill_surfaces_keys);
+            },
+            this->_print->config.threads.value
+        );
+    }
+}
+
+void
+PrintObject::_bridge_over_infill(size_t region_id, size_t layer_idx, const std::vector<ClipperExpr> &internal,
+    const std::vector< std::vector<coordf_t> > &fill_surfaces_keys)
+{
+    const PrintRegion &region = *this->_print->regions[region_id];
+    Layer* layer        = this->layers[layer_idx];
+    LayerRegion* layerm = layer->get_region(region_id);
+    
+    // get bridge flow
+    const Flow bridge_flow = region.flow(
+        frSolidInfill,
+        -1,     // layer height, not relevant for bridge flow
+        true,   // bridge
+        false,  // first layer
+        -1,     // custom width, not relevant for bridge flow
+        *this
+    );
+    
+    // get the average extrusion volume per surface unit
+    const double mm3_per_mm  = bridge_flow.mm3_per_mm();
+    const double mm3_per_mm2 = mm3_per_mm / bridge_flow.width;
+    
+    // extract the stInternalSolid surfaces that might be transformed into bridges
+    Polygons internal_solid;
+    layerm->fill_surfaces.filter_by_type(stInternalSolid, &internal_solid);
+    if (internal_solid.empty()) return;
+    
+    // check whether we should bridge or not according to density
+    {
+        // get the normal solid infill flow we would use if not bridging
+        const Flow normal_flow = layerm->flow(frSolidInfill, false);
         
-        // get bridge flow
-        const Flow bridge_flow = (*region)->flow(
-            frSolidInfill,
-            -1,     // layer height, not relevant for bridge flow
-            true,   // bridge
-            false,  // first layer
-            -1,     // custom width, not relevant for bridge flow
-            *this
+        // Bridging over sparse infill has two purposes:
+        // 1) cover better the gaps of internal sparse infill, especially when
+        //    printing at very low densities;
+        // 2) provide a greater flow when printing very thin layers where normal
+        //    solid flow would be very poor.
+        // So we calculate density threshold as interpolation according to normal flow.
+        // If normal flow would be equal or greater than the bridge flow, we can keep
+        // a low threshold like 25% in order to bridge only when printing at very low
+        // densities, when sparse infill has significant gaps.
+        // If normal flow would be equal or smaller than half the bridge flow, we
+        // use a higher threshold like 50% in order to bridge in more cases.
+        // We still never bridge whenever fill density is greater than 50% because
+        // we would overstuff.
+        const float min_threshold = 25.0;
+        const float max_threshold = 50.0;
+        const float density_threshold = std::max(
+            std::min<float>(
+                min_threshold
+                    + (max_threshold - min_threshold)
+                    * (normal_flow.mm3_per_mm() - mm3_per_mm)
+                    / (mm3_per_mm/2 - mm3_per_mm),
+                max_threshold
+            ),
+            min_threshold
         );
         
-        // get the average extrusion volume per surface unit
-        const double mm3_per_mm  = bridge_flow.mm3_per_mm();
-        const double mm3_per_mm2 = mm3_per_mm / bridge_flow.width;
+        if (region.config.fill_density.value > density_threshold) return;
+    }
+    
+    // check whether the lower area is deep enough for absorbing the extra flow
+    // (for obvious physical reasons but also for preventing the bridge extrudates
+    // from overflowing in 3D preview)
+    
+    // Only bridge where internal infill exists below the solid shell matching
+    // these two conditions:
+    // 1) its depth is at least equal to our bridge extrusion diameter;
+    // 2) its free volume (thus considering infill density) is at least equal
+    //    to the volume needed by our bridge flow.
+    double excess_mm3_per_mm2 = mm3_per_mm2;
+    
+    // iterate through lower layers spanned by bridge_flow, down to lower_idx
+    const double bottom_z = layer->print_z - bridge_flow.height;
+    int lower_idx = layer_idx;
+    for (int i = int(layer_idx) - 1; i >= 0; --i) {
+        const Layer* lower_layer = this->layers[i];
         
-        FOREACH_LAYER(this, layer_it) {
-            // skip first layer
-            if (layer_it == this->layers.begin()) continue;
-            
-            Layer* layer        = *layer_it;
-            LayerRegion* layerm = layer->get_region(region_id);
-            
-            // extract the stInternalSolid surfaces that might be transformed into bridges
-            Polygons internal_solid;
-            layerm->fill_surfaces.filter_by_type(stInternalSolid, &internal_solid);
-            if (internal_solid.empty()) continue;
-            
-            // check whether we should bridge or not according to density
-            {
-                // get the normal solid infill flow we would use if not bridging
-                const Flow normal_flow = layerm->flow(frSolidInfill, false);
-                
-                // Bridging over sparse infill has two purposes:
-                // 1) cover better the gaps of internal sparse infill, especially when
-                //    printing at very low densities;
-                // 2) provide a greater flow when printing very thin layers where normal
-                //    solid flow would be very poor.
-                // So we calculate density threshold as interpolation according to normal flow.
-                // If normal flow would be equal or greater than the bridge flow, we can keep
-                // a low threshold like 25% in order to bridge only when printing at very low
-                // densities, when sparse infill has significant gaps.
-                // If normal flow would be equal or smaller than half the bridge flow, we
-                // use a higher threshold like 50% in order to bridge in more cases.
-                // We still never bridge whenever fill density is greater than 50% because
-                // we would overstuff.
-                const float min_threshold = 25.0;
-                const float max_threshold = 50.0;
-                const float density_threshold = std::max(
-                    std::min<float>(
-                        min_threshold
-                            + (max_threshold - min_threshold)
-                            * (normal_flow.mm3_per_mm() - mm3_per_mm)
-                            / (mm3_per_mm/2 - mm3_per_mm),
-                        max_threshold
-                    ),
-                    min_threshold
-                );
-                
-                if ((*region)->config.fill_density.value > density_threshold) continue;
-            }
-            
-            // check whether the lower area is deep enough for absorbing the extra flow
-            // (for obvious physical reasons but also for preventing the bridge extrudates
-            // from overflowing in 3D preview)
-            ExPolygons to_bridge;
-            {
-                Polygons to_bridge_pp = internal_solid;
-                
-                // Only bridge where internal infill exists below the solid shell matching
-                // these two conditions:
-                // 1) its depth is at least equal to our bridge extrusion diameter;
-                // 2) its free volume (thus considering infill density) is at least equal
-                //    to the volume needed by our bridge flow.
-                double excess_mm3_per_mm2 = mm3_per_mm2;
-                
-                // iterate through lower layers spanned by bridge_flow
-                const double bottom_z = layer->print_z - bridge_flow.height;
-                for (int i = (layer_it - this->layers.begin()) - 1; i >= 0; --i) {
-                    const Layer* lower_layer = this->layers[i];
-                    
-                    // subtract the void volume of this layer
-                    excess_mm3_per_mm2 -= lower_layer->height * (100 - (*region)->config.fill_density.value)/100;
-                    
-                    // stop iterating if both conditions are matched
-                    if (lower_layer->print_z < bottom_z && excess_mm3_per_mm2 <= 0) break;
-                    
-                    // iterate through regions and collect internal surfaces
-                    Polygons lower_internal;
-                    FOREACH_LAYERREGION(lower_layer, lower_layerm_it)
-                        (*lower_layerm_it)->fill_surfaces.filter_by_type(stInternal, &lower_internal);
-                    
-                    // intersect such lower internal surfaces with the candidate solid surfaces
-                    to_bridge_pp = intersection(to_bridge_pp, lower_internal);
-                }
-                
-                // don't bridge if the volume condition isn't matched
-                if (excess_mm3_per_mm2 > 0) continue;
-                
-                // there's no point in bridging too thin/short regions
-                {
-                    const double min_width = bridge_flow.scaled_width() * 3;
-                    to_bridge_pp = offset2(to_bridge_pp, -min_width, +min_width);
-                }
-                
-                if (to_bridge_pp.empty()) continue;
-                
-                // convert into ExPolygons
-                to_bridge = union_ex(to_bridge_pp);
+        // subtract the void volume of this layer
+        excess_mm3_per_mm2 -= lower_layer->height * (100 - region.config.fill_density.value)/100;
+        
+        // stop iterating if both conditions are matched
+        if (lower_layer->print_z < bottom_z && excess_mm3_per_mm2 <= 0) break;
+        lower_idx = i;
+    }
+    
+    // don't bridge if the volume condition isn't matched
+    if (excess_mm3_per_mm2 > 0) return;
+    
+    // there's no point in bridging too thin/short regions
+    const double min_width = bridge_flow.scaled_width() * 3;
+    
+    // the result only depends on the surfaces of this layer and of the lower layers
+    // spanned by bridge_flow, and on the flows
+    std::vector<coordf_t> key;
+    key.push_back(region.config.fill_density.value);
+    key.push_back(mm3_per_mm);
+    key.push_back(bridge_flow.height);
+    key.push_back(min_width);
+    key.push_back(layer_idx - lower_idx);
+    append_surfaces_key(layerm->fill_surfaces.surfaces, &key);
+    for (int i = int(layer_idx) - 1; i >= lower_idx; --i)
+        key.insert(key.end(), fill_surfaces_keys[i].begin(), fill_surfaces_keys[i].end());
+    SurfacesMemo &memo = this->_bridge_over_infill_memo[layer_idx][region_id];
+    if (memo.valid && memo.key == key) {
+        layerm->fill_surfaces = memo.fill_surfaces;
+        return;
+    }
+    memo.valid = false;
+    
+    ExPolygons to_bridge;
+    {
+        // intersect the lower internal surfaces with the candidate solid surfaces
+        ClipperExpr to_bridge_pp(internal_solid);
+        for (int i = int(layer_idx) - 1; i >= lower_idx; --i)
+            to_bridge_pp = to_bridge_pp.intersection(internal[i]);
+        
+        // convert into ExPolygons
+        to_bridge = to_bridge_pp.offset2(-min_width, +min_width).expolygons();
+    }
+    
+    if (!to_bridge.empty()) {
+        #ifdef SLIC3R_DEBUG
+        printf("Bridging %zu internal areas at layer %zu\n", to_bridge.size(), layer->id());
+        #endif
+        
+        // compute the remaning internal solid surfaces as difference
+        const ExPolygons not_to_bridge = ClipperExpr(internal_solid).diff(to_bridge, true).expolygons();
+        
+        // build the new collection of fill_surfaces
+        {
+            Surfaces new_surfaces;
+            for (Surfaces::const_iterator surface = layerm->fill_surfaces.surfaces.begin(); surface != layerm->fill_surfaces.surfaces.end(); ++surface) {
+                if (surface->surface_type != stInternalSolid)
+                    new_surfaces.push_back(*surface);
             }
             
-            #ifdef SLIC3R_DEBUG
-            printf("Bridging %zu internal areas at layer %zu\n", to_bridge.size(), layer->id());
-            #endif
+            for (ExPolygons::const_iterator ex = to_bridge.begin(); ex != to_bridge.end(); ++ex)
+                new_surfaces.push_back(Surface(stInternalBridge, *ex));
             
-            // compute the remaning internal solid surfaces as difference
-            const ExPolygons not_to_bridge = diff_ex(internal_solid, to_polygons(to_bridge), true);
+            for (ExPolygons::const_iterator ex = not_to_bridge.begin(); ex != not_to_bridge.end(); ++ex)
+                new_surfaces.push_back(Surface(stInternalSolid, *ex));
             
-            // build the new collection of fill_surfaces
-            {
-                Surfaces new_surfaces;
-                for (Surfaces::const_iterator surface = layerm->fill_surfaces.surfaces.begin(); surface != layerm->fill_surfaces.surfaces.end(); ++surface) {
-                    if (surface->surface_type != stInternalSolid)
-                        new_surfaces.push_back(*surface);
+            layerm->fill_surfaces.surfaces = new_surfaces;
+        }
+    }
+    
+    memo.valid         = true;
+    memo.key.swap(key);
+    memo.fill_surfaces = layerm->fill_surfaces;
+    
+    /*
+    # exclude infill from the layers below if needed
+    # see discussion at https://github.com/alexrj/Slic3r/issues/240
+    # Update: do not exclude any infill. Sparse infill is able to absorb the excess material.
+    if (0) {
+        my $excess = $layerm->extruders->{infill}->bridge_flow->width - $layerm->height;
+        for (my $i = $layer_id-1; $excess >= $self->get_layer($i)->height; $i--) {
+            Slic3r::debugf "  skipping infill below those areas at layer %d\n", $i;
+            foreach my $lower_layerm (@{$self->get_layer($i)->regions}) {
+                my @new_surfaces = ();
+                # subtract the area from all types of surfaces
+                foreach my $group (@{$lower_layerm->fill_surfaces->group}) {
+                    push @new_surfaces, map $group->[0]->clone(expolygon => $_),
+                        @{diff_ex(
+                            [ map $_->p, @$group ],
+                            [ map @$_, @$to_bridge ],
+                        )};
+                    push @new_surfaces, map Slic3r::Surface->new(
+                        expolygon       => $_,
+                        surface_type    => S_TYPE_INTERNALVOID,
+                    ), @{intersection_ex(
+                        [ map $_->p, @$group ],
+                        [ map @$_, @$to_bridge ],
+                    )};
                 }
-                
-                for (ExPolygons::const_iterator ex = to_bridge.begin(); ex != to_bridge.end(); ++ex)
-                    new_surfaces.push_back(Surface(stInternalBridge, *ex));
-                
-                for (ExPolygons::const_iterator ex = not_to_bridge.begin(); ex != not_to_bridge.end(); ++ex)
-                    new_surfaces.push_back(Surface(stInternalSolid, *ex));
-                
-                layerm->fill_surfaces.surfaces = new_surfaces;
+                $lower_layerm->fill_surfaces->clear;
+                $lower_layerm->fill_surfaces->append($_) for @new_surfaces;
             }
             
-            /*
-            # exclude infill from the layers below if needed
-            # see discussion at https://github.com/alexrj/Slic3r/issues/240
-            # Update: do not exclude any infill. Sparse infill is able to absorb the excess material.
-            if (0) {
-                my $excess = $layerm->extruders->{infill}->bridge_flow->width - $layerm->height;
-                for (my $i = $layer_id-1; $excess >= $self->get_layer($i)->height; $i--) {
-                    Slic3r::debugf "  skipping infill below those areas at layer %d\n", $i;
-                    foreach my $lower_layerm (@{$self->get_layer($i)->regions}) {
-                        my @new_surfaces = ();
-                        # subtract the area from all types of surfaces
-                        foreach my $group (@{$lower_layerm->fill_surfaces->group}) {
-                            push @new_surfaces, map $group->[0]->clone(expolygon => $_),
-                                @{diff_ex(
-                                    [ map $_->p, @$group ],
-                                    [ map @$_, @$to_bridge ],
-                                )};
-                            push @new_surfaces, map Slic3r::Surface->new(
-                                expolygon       => $_,
-                                surface_type    => S_TYPE_INTERNALVOID,
-                            ), @{intersection_ex(
-                                [ map $_->p, @$group ],
-                                [ map @$_, @$to_bridge ],
-                            )};
-                        }
-                        $lower_layerm->fill_surfaces->clear;
-                        $lower_layerm->fill_surfaces->append($_) for @new_surfaces;
-                    }
-                    
-                    $excess -= $self->get_layer($i)->height;
-                }
-            }
-            */
+            $excess -= $self->get_layer($i)->height;
         }
     }
+    */
 }
 
 // adjust the layer height to the next multiple of the z full-step resolution
@@ -1070,34 +1222,50 @@ void PrintObject::_slice()
         for (size_t layer_id = 0; layer_id < expolygons_by_layer.size(); ++ layer_id)
             this->layers[layer_id]->regions.front()->slices.append(std::move(expolygons_by_layer[layer_id]), stInternal);
     } else {
-        // Slice all non-modifier volumes.
-        for (size_t region_id = 0; region_id < this->print()->regions.size(); ++ region_id) {
-            std::vector<ExPolygons> expolygons_by_layer = this->_slice_region(region_id, slice_zs, false);
-            for (size_t layer_id = 0; layer_id < expolygons_by_layer.size(); ++ layer_id)
-                this->layers[layer_id]->regions[region_id]->slices.append(std::move(expolygons_by_layer[layer_id]), stInternal);
-        }
-        // Slice all modifier volumes.
-        for (size_t region_id = 0; region_id < this->print()->regions.size(); ++ region_id) {
-            std::vector<ExPolygons> expolygons_by_layer = this->_slice_region(region_id, slice_zs, true);
-            // loop through the other regions and 'steal' the slices belonging to this one
-            for (size_t other_region_id = 0; other_region_id < this->print()->regions.size(); ++ other_region_id) {
-                if (region_id == other_region_id)
-                    continue;
-                for (size_t layer_id = 0; layer_id < expolygons_by_layer.size(); ++ layer_id) {
-                    Layer       *layer = layers[layer_id];
-                    LayerRegion *layerm = layer->regions[region_id];
-                    LayerRegion *other_layerm = layer->regions[other_region_id];
-                    if (layerm == nullptr || other_layerm == nullptr)
-                        continue;
-                    Polygons other_slices = to_polygons(other_layerm->slices);
-                    ExPolygons my_parts = intersection_ex(other_slices, to_polygons(expolygons_by_layer[layer_id]));
-                    if (my_parts.empty())
-                        continue;
-                    // Remove such parts from original region.
-                    other_layerm->slices.set(diff_ex(other_slices, to_polygons(my_parts)), stInternal);
-                    // Append new parts to our region.
-                    layerm->slices.append(std::move(my_parts), stInternal);
+        // Slice the regular and the modifier volumes of all the regions in a single pass.
+        std::vector< std::vector<ExPolygons> > slices, modifier_slices;
+        this->_slice_regions(slice_zs, &slices, &modifier_slices);
+        
+        bool has_modifiers = false;
+        for (const std::vector<ExPolygons> &region_slices : modifier_slices)
+            if (!region_slices.empty()) has_modifiers = true;
+        
+        for (size_t layer_id = 0; layer_id < slice_zs.size(); ++ layer_id) {
+            Layer *layer = this->layers[layer_id];
+            if (!has_modifiers) {
+                for (size_t region_id = 0; region_id < slices.size(); ++ region_id)
+                    if (!slices[region_id].empty())
+                        layer->regions[region_id]->slices.append(std::move(slices[region_id][layer_id]), stInternal);
+                continue;
+            }
+            
+            // Resolve the region owning each part of the layer in a single boolean pass:
+            // a part covered by modifiers goes to the region of the last modifier covering it,
+            // the rest stays with the regions of the regular volumes.
+            std::vector<ClipperExpr> regular(slices.size()), modifiers(slices.size());
+            ClipperExpr object_slices, modified;
+            for (size_t region_id = 0; region_id < slices.size(); ++ region_id) {
+                if (!slices[region_id].empty()) {
+                    regular[region_id] = ClipperExpr(slices[region_id][layer_id]);
+                    object_slices = object_slices.union_(regular[region_id]);
+                }
+                if (!modifier_slices[region_id].empty()) {
+                    modifiers[region_id] = ClipperExpr(modifier_slices[region_id][layer_id]);
+                    modified = modified.union_(modifiers[region_id]);
+                }
+            }
+            object_slices = object_slices.evaluate();
+            modified      = modified.evaluate();
+            
+            ClipperExpr claimed;
+            for (size_t region_id = slices.size(); region_id-- > 0; ) {
+                ClipperExpr region_slices = regular[region_id].diff(modified);
+                if (!modifier_slices[region_id].empty()) {
+                    region_slices = region_slices.union_(
+                        object_slices.intersection(modifiers[region_id]).diff(claimed));
+                    claimed = claimed.union_(modifiers[region_id]).evaluate();
                 }
+                layer->regions[region_id]->slices.append(region_slices.expolygons(), stInternal);
             }
         }
     }
@@ -1194,33 +1362,99 @@ PrintObject::_slice_region(size_t region_id, std::vector<float> z, bool modifier
     
     ModelObject &object = *this->model_object();
     
-    // compose mesh
-    TriangleMesh mesh;
+    // collect the meshes, they're sliced in place
+    TriangleMeshPtrs meshes;
     for (std::vector<int>::const_iterator it = region_volumes.begin();
         it != region_volumes.end(); ++it) {
         
-        const ModelVolume &volume = *object.volumes[*it];
+        ModelVolume &volume = *object.volumes[*it];
         if (volume.modifier != modifier) continue;
+        if (volume.mesh.facets_count() == 0) continue;
         
-        mesh.merge(volume.mesh);
+        meshes.push_back(&volume.mesh);
     }
-    if (mesh.facets_count() == 0) return layers;
+    if (meshes.empty()) return layers;
+    
+    // perform actual slicing
+    TriangleMeshSlicer<Z>(meshes, this->_slicing_transformation()).slice(z, &layers);
+    return layers;
+}
 
-    // transform mesh
+// Transformation from the frame of the volume meshes to the one of the slices.
+TransformationMatrix
+PrintObject::_slicing_transformation()
+{
+    ModelObject &object = *this->model_object();
+    
     // we ignore the per-instance transformations currently and only 
     // consider the first one
-    object.instances[0]->transform_mesh(&mesh, true);
-
+    TransformationMatrix trafo = object.instances[0]->transformation();
+    
     // align mesh to Z = 0 (it should be already aligned actually) and apply XY shift
-    mesh.translate(
+    trafo.translate(
         -unscale(this->_copies_shift.x),
         -unscale(this->_copies_shift.y),
         -object.bounding_box().min.z
     );
+    return trafo;
+}
+
+// Slices the volumes of all the regions at once: (*slices)[region_id][layer_id] gets the
+// slices of the regular volumes of each region and (*modifier_slices)[region_id][layer_id]
+// the ones of its modifier volumes. The vectors of a region without such volumes stay empty.
+void
+PrintObject::_slice_regions(const std::vector<float> &z, std::vector< std::vector<ExPolygons> >* slices,
+    std::vector< std::vector<ExPolygons> >* modifier_slices)
+{
+    const size_t regions = this->print()->regions.size();
+    slices->assign(regions, std::vector<ExPolygons>());
+    modifier_slices->assign(regions, std::vector<ExPolygons>());
     
-    // perform actual slicing
-    TriangleMeshSlicer<Z>(&mesh).slice(z, &layers);
-    return layers;
+    ModelObject &object = *this->model_object();
+    
+    // collect the meshes of all the volumes, they're sliced in place
+    TriangleMeshPtrs meshes;
+    std::vector<const ModelVolume*> volumes;
+    std::vector<size_t> volumes_region;
+    for (size_t region_id = 0; region_id < regions; ++region_id) {
+        const std::vector<int> &region_volumes = this->region_volumes[region_id];
+        for (std::vector<int>::const_iterator it = region_volumes.begin(); it != region_volumes.end(); ++it) {
+            ModelVolume* volume = object.volumes[*it];
+            if (volume->mesh.facets_count() == 0) continue;
+            
+            meshes.push_back(&volume->mesh);
+            volumes.push_back(volume);
+            volumes_region.push_back(region_id);
+        }
+    }
+    if (volumes.empty()) return;
+    
+    // slice all the volumes in a single pass over their facets
+    TriangleMeshSlicer<Z> slicer(meshes, this->_slicing_transformation());
+    std::vector< std::vector<Polygons> > loops;
+    slicer.slice(z, &loops);
+    
+    // merge the loops of the volumes of each region, regular and modifier ones apart
+    for (size_t region_id = 0; region_id < regions; ++region_id) {
+        for (int modifier = 0; modifier <= 1; ++modifier) {
+            std::vector<ExPolygons> &layers = modifier ? (*modifier_slices)[region_id] : (*slices)[region_id];
+            std::vector<Polygons> region_loops;
+            for (size_t i = 0; i < volumes.size(); ++i) {
+                if (volumes_region[i] != region_id || volumes[i]->modifier != (modifier != 0)) continue;
+                if (region_loops.empty()) {
+                    region_loops = std::move(loops[i]);
+                } else {
+                    for (size_t layer_id = 0; layer_id < z.size(); ++layer_id)
+                        append_to(region_loops[layer_id], loops[i][layer_id]);
+                }
+            }
+            if (region_loops.empty()) continue;
+            
+            layers.resize(z.size());
+            for (size_t layer_id = 0; layer_id < z.size(); ++layer_id)
+                slicer.make_expolygons(region_loops[layer_id], &layers[layer_id]);
+        }
+    }
 }
 
 void
@@ -1340,10 +1574,27 @@ PrintObject::_make_perimeters()
         }
     }
     
+    // The layers are processed in parallel. The NULL entries queued after the layers are
+    // picked by the threads left without a layer: they help with the islands of the layers
+    // still being processed until the last layer is done.
+    const int threads = this->_print->config.threads.value;
+    PerimeterIslandQueue island_queue;
+    std::queue<Layer*> queue(std::deque<Layer*>(this->layers.begin(), this->layers.end()));  // cast LayerPtrs to std::queue<Layer*>
+    if (!this->layers.empty())
+        for (int i = 1; i < threads; ++i) queue.push(NULL);
+    std::atomic<int> layers_left(int(this->layers.size()));
     parallelize<Layer*>(
-        std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
-        boost::bind(&Slic3r::Layer::make_perimeters, _1),
-        this->_print->config.threads.value
+        queue,
+        [threads, &island_queue, &layers_left](Layer* layer) {
+            if (layer == NULL) {
+                island_queue.help();
+                return;
+            }
+            layer->make_perimeters(threads > 1 ? &island_queue : NULL);
+            if (--layers_left == 0)
+                island_queue.finish();
+        },
+        threads
     );
     
     /*
@@ -1362,12 +1613,34 @@ PrintObject::_infill()
     if (this->state.is_done(posInfill)) return;
     this->state.set_started(posInfill);
     
+    // The shared fill patterns cover the object, so the caches are sized to hold two of them
+    // (typically the sparse and the solid ones) at the finest solid infill spacing.
+    {
+        coord_t spacing = 0;
+        for (size_t region_id = 0; region_id < this->region_volumes.size(); ++region_id) {
+            if (this->region_volumes[region_id].empty()) continue;
+            const coord_t s = this->_print->regions[region_id]->flow(
+                frSolidInfill, this->config.layer_height.value, false, false, -1, *this
+            ).scaled_spacing();
+            if (s > 0 && (spacing == 0 || s < spacing)) spacing = s;
+        }
+        if (spacing > 0) {
+            const size_t points = 2 * size_t(this->size.x / spacing + 1) * size_t(this->size.y / spacing + 1);
+            FillPatternCache<Polylines>::set_capacity(points);
+            FillPatternCache<Polygons>::set_capacity(points);
+        }
+    }
+    
     parallelize<Layer*>(
         std::queue<Layer*>(std::deque<Layer*>(this->layers.begin(), this->layers.end())),  // cast LayerPtrs to std::queue<Layer*>
         boost::bind(&Slic3r::Layer::make_fills, _1),
         this->_print->config.threads.value
     );
     
+    // the patterns are only shared by the layers of this object
+    FillPatternCache<Polylines>::clear();
+    FillPatternCache<Polygons>::clear();
+    
     /*  we could free memory now, but this would make this step not idempotent
     ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
     */
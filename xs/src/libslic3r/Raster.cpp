@@ -0,0 +1,186 @@
+#include "Raster.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#define MINIZ_HEADER_FILE_ONLY
+#include "../miniz/miniz.h"
+
+namespace Slic3r {
+
+Raster::Raster(const BoundingBoxf &area, const Options &options)
+    : options(options), origin(area.min.x, area.max.y)
+{
+    this->options.samples  = std::max(1, this->options.samples);
+    this->options.rotation = ((this->options.rotation / 90) % 4 + 4) % 4 * 90;
+    this->scale  = this->options.dpi / 25.4;
+    this->size_x = (area.max.x - area.min.x) * this->scale;
+    this->size_y = (area.max.y - area.min.y) * this->scale;
+
+    const bool swap_axes = this->options.rotation == 90 || this->options.rotation == 270;
+    this->_width  = std::max(1, int(ceil(swap_axes ? this->size_y : this->size_x)));
+    this->_height = std::max(1, int(ceil(swap_axes ? this->size_x : this->size_y)));
+    this->_pixels.assign(this->_width * this->_height, 0);
+    this->coverage.assign(this->_width + 1, 0.f);
+    this->runs.assign(this->_width + 1, 0.f);
+}
+
+Pointf
+Raster::to_pixel(const Point &point) const
+{
+    // image rows go downwards
+    double u = (unscale(point.x) - this->origin.x) * this->scale;
+    double v = (this->origin.y - unscale(point.y)) * this->scale;
+    if (this->options.mirror_x) u = this->size_x - u;
+    if (this->options.mirror_y) v = this->size_y - v;
+    switch (this->options.rotation) {
+        case 90:  return Pointf(v, this->size_x - u);
+        case 180: return Pointf(this->size_x - u, this->size_y - v);
+        case 270: return Pointf(this->size_y - v, u);
+        default:  return Pointf(u, v);
+    }
+}
+
+void
+Raster::add_edges(const Polygon &polygon)
+{
+    if (polygon.points.size() < 3) return;
+    Pointf prev = this->to_pixel(polygon.points.back());
+    for (Points::const_iterator it = polygon.points.begin(); it != polygon.points.end(); ++it) {
+        const Pointf p = this->to_pixel(*it);
+        if (p.y != prev.y) {
+            const Pointf &top    = (p.y < prev.y) ? p : prev;
+            const Pointf &bottom = (p.y < prev.y) ? prev : p;
+            Edge edge;
+            edge.y_top    = top.y;
+            edge.y_bottom = bottom.y;
+            edge.x_top    = top.x;
+            edge.slope    = (bottom.x - top.x) / (bottom.y - top.y);
+            this->edges.push_back(edge);
+        }
+        prev = p;
+    }
+}
+
+void
+Raster::fill_edges()
+{
+    if (this->edges.empty()) return;
+    std::sort(this->edges.begin(), this->edges.end());
+
+    double y_max = 0;
+    for (std::vector<Edge>::const_iterator e = this->edges.begin(); e != this->edges.end(); ++e)
+        y_max = std::max(y_max, e->y_bottom);
+    const int row_first = std::max(0, int(floor(this->edges.front().y_top)));
+    const int row_last  = std::min(int(this->_height) - 1, int(ceil(y_max)) - 1);
+
+    const int    samples = this->options.samples;
+    const double width   = double(this->_width);
+    std::vector<size_t> active;
+    size_t next = 0;
+    for (int row = row_first; row <= row_last; ++row) {
+        size_t col_min = this->_width, col_max = 0;
+        for (int s = 0; s < samples; ++s) {
+            const double y = row + (s + 0.5) / samples;
+            while (next < this->edges.size() && this->edges[next].y_top <= y)
+                active.push_back(next++);
+
+            // Intersect the sub-scanline with the active edges, dropping the edges ending above it.
+            this->crossings.clear();
+            for (size_t i = 0; i < active.size(); ) {
+                const Edge &edge = this->edges[active[i]];
+                if (edge.y_bottom <= y) {
+                    active[i] = active.back();
+                    active.pop_back();
+                } else {
+                    this->crossings.push_back(edge.x_top + (y - edge.y_top) * edge.slope);
+                    ++i;
+                }
+            }
+            std::sort(this->crossings.begin(), this->crossings.end());
+
+            // Accumulate the inner spans: the partially covered pixels at the span ends
+            // go to the coverage buffer, the fully covered ones to the runs buffer as a difference array.
+            for (size_t i = 0; i + 1 < this->crossings.size(); i += 2) {
+                const double a = std::min(std::max(this->crossings[i],   0.), width);
+                const double b = std::min(std::max(this->crossings[i+1], 0.), width);
+                if (b <= a) continue;
+                const size_t ia = size_t(a), ib = size_t(b);
+                if (ia == ib) {
+                    this->coverage[ia] += float(b - a);
+                } else {
+                    this->coverage[ia] += float(ia + 1 - a);
+                    this->runs[ia + 1] += 1.f;
+                    this->runs[ib]     -= 1.f;
+                    this->coverage[ib] += float(b - ib);
+                }
+                col_min = std::min(col_min, ia);
+                col_max = std::max(col_max, ib);
+            }
+        }
+
+        // Merge the coverage of this row into the image and reset the accumulators.
+        unsigned char* pixels = &this->_pixels[row * this->_width];
+        float run = 0.f;
+        for (size_t col = col_min; col <= col_max && col_min <= col_max; ++col) {
+            run += this->runs[col];
+            if (col < this->_width) {
+                const int value = std::min(255, int((this->coverage[col] + run) * 255.f / samples + 0.5f));
+                if (value > pixels[col]) pixels[col] = (unsigned char)value;
+            }
+            this->coverage[col] = 0.f;
+            this->runs[col]     = 0.f;
+        }
+    }
+    this->edges.clear();
+}
+
+void
+Raster::draw(const Polygons &polygons)
+{
+    for (Polygons::const_iterator it = polygons.begin(); it != polygons.end(); ++it)
+        this->add_edges(*it);
+    this->fill_edges();
+}
+
+void
+Raster::draw(const ExPolygons &expolygons)
+{
+    for (ExPolygons::const_iterator it = expolygons.begin(); it != expolygons.end(); ++it) {
+        this->add_edges(it->contour);
+        for (Polygons::const_iterator h = it->holes.begin(); h != it->holes.end(); ++h)
+            this->add_edges(*h);
+    }
+    this->fill_edges();
+}
+
+void
+Raster::draw_circle(const Point &center, coord_t radius)
+{
+    // about one segment per pixel of circumference
+    const double radius_px = unscale(radius) * this->scale;
+    const int segments = std::min(512, std::max(8, int(ceil(2 * PI * radius_px))));
+    Polygon circle;
+    circle.points.reserve(segments);
+    for (int i = 0; i < segments; ++i) {
+        const double angle = 2 * PI * i / segments;
+        circle.points.push_back(Point(center.x + radius * cos(angle), center.y + radius * sin(angle)));
+    }
+    this->add_edges(circle);
+    this->fill_edges();
+}
+
+std::string
+Raster::png(int level) const
+{
+    size_t size = 0;
+    void* data = tdefl_write_image_to_png_file_in_memory_ex(
+        this->_pixels.data(), int(this->_width), int(this->_height), 1, &size, mz_uint(level), MZ_FALSE);
+    if (data == NULL)
+        throw std::runtime_error("Failed to encode PNG image");
+    std::string png((const char*)data, size);
+    mz_free(data);
+    return png;
+}
+
+}
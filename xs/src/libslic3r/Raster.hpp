@@ -0,0 +1,77 @@
+#ifndef slic3r_Raster_hpp_
+#define slic3r_Raster_hpp_
+
+#include "libslic3r.h"
+#include "BoundingBox.hpp"
+#include "ExPolygon.hpp"
+#include "Point.hpp"
+#include "Polygon.hpp"
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+/// 8 bit grayscale image of an area of the print bed, filled with an anti-aliased scanline rasterizer.
+/// Every draw() call fills its polygons with the even-odd rule and merges the result
+/// with the previously drawn shapes.
+class Raster
+{
+    public:
+    /// Resolution and orientation of the pixel grid.
+    struct Options {
+        double dpi;         ///< Pixels per inch.
+        bool mirror_x;      ///< Mirror the image horizontally.
+        bool mirror_y;      ///< Mirror the image vertically.
+        int rotation;       ///< Counter-clockwise rotation of the image, in degrees (multiple of 90).
+        int samples;        ///< Sub-scanlines per pixel row used for anti-aliasing, 1 disables it.
+        Options() : dpi(254), mirror_x(false), mirror_y(false), rotation(0), samples(4) {};
+    };
+
+    /// Create a black image covering an area of the print bed.
+    /// \param area BoundingBoxf the covered area, in unscaled coordinates
+    /// \param options Options the resolution and orientation of the image
+    Raster(const BoundingBoxf &area, const Options &options);
+
+    size_t width() const { return this->_width; };
+    size_t height() const { return this->_height; };
+    /// Pixels of the image, row by row from the top.
+    const std::vector<unsigned char>& pixels() const { return this->_pixels; };
+
+    /// Fill the area enclosed by the polygons using the even-odd rule.
+    void draw(const Polygons &polygons);
+    /// Fill non overlapping expolygons in a single pass.
+    void draw(const ExPolygons &expolygons);
+    void draw(const ExPolygon &expolygon) { this->draw((Polygons)expolygon); };
+    /// Fill a disc.
+    void draw_circle(const Point &center, coord_t radius);
+
+    /// Encode the image as PNG.
+    /// \param level int the zlib compression level
+    std::string png(int level = 1) const;
+
+    private:
+    struct Edge {
+        double y_top, y_bottom; ///< Rows covered by the edge, y_top < y_bottom.
+        double x_top;           ///< X coordinate at y_top.
+        double slope;           ///< dx/dy
+        bool operator<(const Edge &other) const { return this->y_top < other.y_top; };
+    };
+
+    Options options;
+    size_t _width, _height;
+    Pointf origin;          ///< Bed coordinates of the top left corner before mirroring and rotation.
+    double scale;           ///< Pixels per scaled unit.
+    double size_x, size_y;  ///< Size of the image before rotation, in pixels.
+    std::vector<unsigned char> _pixels;
+    std::vector<float> coverage, runs;  ///< Scanline accumulators, width + 1 entries.
+    std::vector<Edge> edges;
+    std::vector<double> crossings;
+
+    Pointf to_pixel(const Point &point) const;
+    void add_edges(const Polygon &polygon);
+    void fill_edges();
+};
+
+}
+
+#endif
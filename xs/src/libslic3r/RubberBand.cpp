@@ -110,6 +110,11 @@ const Pointf3* RubberBand::selectNearest(const Pointf3& p)
     return result;
 }
 
+// does this rubberband intersect the layer interval [z_bottom, z_top)?
+bool RubberBand::intersectsLayer(const double z_bottom, const double z_top) const
+{
+    return this->getZMin() < z_top && this->getZMax() >= z_bottom;
+}
 
 /* Computes the segment of this rubberband crossing the given layer interval.
  * Endpoints are extended by extension_length if they lie outside of the layer
@@ -123,7 +128,7 @@ bool RubberBand::getLayerSegments(const double z_bottom, const double z_top, con
     bool result = false;
 
     // does this rubberband intersect the given layer?
-    if((this->a.z >= z_bottom && this->b.z < z_top) || (this->a.z < z_top && this->b.z >= z_bottom)) {
+    if(this->intersectsLayer(z_bottom, z_top)) {
         result = true;
         bool extend_a = true;
         bool extend_b = true;
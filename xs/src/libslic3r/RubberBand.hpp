@@ -4,6 +4,7 @@
 #include "libslic3r.h"
 #include "ElectronicPart.hpp"
 #include "NetPoint.hpp"
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <list>
@@ -46,6 +47,9 @@ class RubberBand : public Linef3
     const Pointf3* selectNearest(const Pointf3& p);
     const bool pointASelected() const {return this->netPointASelected;};
     const bool pointBSelected() const {return this->netPointBSelected;};
+    const double getZMin() const {return std::min(this->a.z, this->b.z);};
+    const double getZMax() const {return std::max(this->a.z, this->b.z);};
+    bool intersectsLayer(const double z_bottom, const double z_top) const;
     bool getLayerSegments(const double z_bottom, const double z_top, coord_t const layer_overlap, Lines* segments, bool* overlap_a, bool* overlap_b) const;
     /// returns rubberband inlcuding potential pin contact extensions
     Line3s getExtendedSegmets(bool* extend_a, bool* extend_b) const;
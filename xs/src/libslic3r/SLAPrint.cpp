@@ -4,6 +4,7 @@
 #include "Fill/Fill.hpp"
 #include "Geometry.hpp"
 #include "Surface.hpp"
+#include "Zip/ZipArchive.hpp"
 #include <iostream>
 #include <complex>
 #include <cstdio>
@@ -76,61 +77,57 @@ SLAPrint::slice()
     this->sm_pillars.clear();
     ExPolygons overhangs;
     if (this->config.support_material) {
-        // flatten and merge all the overhangs
-        {
+        const int threads = this->config.threads.value;
+        
+        // detect the overhangs of each layer, then flatten and merge them
+        if (this->layers.size() > 1) {
+            std::vector<Polygons> layer_overhangs(this->layers.size());
+            parallelize<size_t>(
+                1,
+                this->layers.size()-1,
+                boost::bind(&SLAPrint::_layer_overhangs, this, _1, &layer_overhangs),
+                threads
+            );
             Polygons pp;
-            for (std::vector<Layer>::const_iterator it = this->layers.begin()+1; it != this->layers.end(); ++it)
-                pp += diff(it->slices, (it - 1)->slices);
+            for (std::vector<Polygons>::const_iterator it = layer_overhangs.begin(); it != layer_overhangs.end(); ++it)
+                pp += *it;
             overhangs = union_ex(pp);
         }
         
         // generate points following the shape of each island
         Points pillars_pos;
-        const coordf_t spacing = scale_(this->config.support_material_spacing);
-        const coordf_t radius  = scale_(this->sm_pillars_radius());
-        for (ExPolygons::const_iterator it = overhangs.begin(); it != overhangs.end(); ++it) {
-            // leave a radius/2 gap between pillars and contour to prevent lateral adhesion
-            for (float inset = radius * 1.5;; inset += spacing) {
-                // inset according to the configured spacing
-                Polygons curr = offset(*it, -inset);
-                if (curr.empty()) break;
-                
-                // generate points along the contours
-                for (Polygons::const_iterator pg = curr.begin(); pg != curr.end(); ++pg) {
-                    Points pp = pg->equally_spaced_points(spacing);
-                    for (Points::const_iterator p = pp.begin(); p != pp.end(); ++p)
-                        pillars_pos.push_back(*p);
-                }
-            }
+        {
+            std::vector<Points> positions(overhangs.size());
+            if (!overhangs.empty())
+                parallelize<size_t>(
+                    0,
+                    overhangs.size()-1,
+                    boost::bind(&SLAPrint::_island_pillars, this, _1, &overhangs, &positions),
+                    threads
+                );
+            for (std::vector<Points>::const_iterator it = positions.begin(); it != positions.end(); ++it)
+                pillars_pos.insert(pillars_pos.end(), it->begin(), it->end());
         }
         
         // for each pillar, check which layers it applies to
-        for (Points::const_iterator p = pillars_pos.begin(); p != pillars_pos.end(); ++p) {
-            SupportPillar pillar(*p);
-            bool object_hit = false;
-            
-            // check layers top-down
-            for (int i = this->layers.size()-1; i >= 0; --i) {
-                // check whether point is void in this layer
-                if (!this->layers[i].slices.contains(*p)) {
-                    // no slice contains the point, so it's in the void
-                    if (pillar.top_layer > 0) {
-                        // we have a pillar, so extend it
-                        pillar.bottom_layer = i + this->config.raft_layers;
-                    } else if (object_hit) {
-                        // we don't have a pillar and we're below the object, so create one
-                        pillar.top_layer = i + this->config.raft_layers;
-                    }
-                } else {
-                    if (pillar.top_layer > 0) {
-                        // we have a pillar which is not needed anymore, so store it and initialize a new potential pillar
-                        this->sm_pillars.push_back(pillar);
-                        pillar = SupportPillar(*p);
-                    }
-                    object_hit = true;
-                }
-            }
-            if (pillar.top_layer > 0) this->sm_pillars.push_back(pillar);
+        if (!pillars_pos.empty()) {
+            // bounding boxes of the islands of each layer, to only test the islands around a pillar
+            std::vector< std::vector<BoundingBox> > bboxes(this->layers.size());
+            parallelize<size_t>(
+                0,
+                this->layers.size()-1,
+                boost::bind(&SLAPrint::_layer_islands_bboxes, this, _1, &bboxes),
+                threads
+            );
+            std::vector< std::vector<SupportPillar> > pillars(pillars_pos.size());
+            parallelize<size_t>(
+                0,
+                pillars_pos.size()-1,
+                boost::bind(&SLAPrint::_scan_pillar, this, _1, &pillars_pos, &bboxes, &pillars),
+                threads
+            );
+            for (std::vector< std::vector<SupportPillar> >::const_iterator it = pillars.begin(); it != pillars.end(); ++it)
+                this->sm_pillars.insert(this->sm_pillars.end(), it->begin(), it->end());
         }
     }
     
@@ -150,6 +147,81 @@ SLAPrint::slice()
     }
 }
 
+void
+SLAPrint::_layer_overhangs(size_t i, std::vector<Polygons>* overhangs) const
+{
+    (*overhangs)[i] = diff(this->layers[i].slices, this->layers[i-1].slices);
+}
+
+void
+SLAPrint::_island_pillars(size_t i, const ExPolygons* islands, std::vector<Points>* positions) const
+{
+    const coordf_t spacing = scale_(this->config.support_material_spacing);
+    const coordf_t radius  = scale_(this->sm_pillars_radius());
+    Points &pillars_pos = (*positions)[i];
+    
+    // leave a radius/2 gap between pillars and contour to prevent lateral adhesion
+    for (float inset = radius * 1.5;; inset += spacing) {
+        // inset according to the configured spacing
+        Polygons curr = offset((*islands)[i], -inset);
+        if (curr.empty()) break;
+        
+        // generate points along the contours
+        for (Polygons::const_iterator pg = curr.begin(); pg != curr.end(); ++pg) {
+            Points pp = pg->equally_spaced_points(spacing);
+            for (Points::const_iterator p = pp.begin(); p != pp.end(); ++p)
+                pillars_pos.push_back(*p);
+        }
+    }
+}
+
+void
+SLAPrint::_layer_islands_bboxes(size_t i, std::vector< std::vector<BoundingBox> >* bboxes) const
+{
+    const ExPolygons &islands = this->layers[i].slices.expolygons;
+    (*bboxes)[i].reserve(islands.size());
+    for (ExPolygons::const_iterator it = islands.begin(); it != islands.end(); ++it)
+        (*bboxes)[i].push_back(it->contour.bounding_box());
+}
+
+void
+SLAPrint::_scan_pillar(size_t i, const Points* positions, const std::vector< std::vector<BoundingBox> >* bboxes,
+    std::vector< std::vector<SupportPillar> >* pillars) const
+{
+    const Point &p = (*positions)[i];
+    SupportPillar pillar(p);
+    bool object_hit = false;
+    
+    // check layers top-down
+    for (int l = this->layers.size()-1; l >= 0; --l) {
+        // check whether point is void in this layer
+        bool void_point = true;
+        const ExPolygons &islands = this->layers[l].slices.expolygons;
+        for (size_t j = 0; j < islands.size() && void_point; ++j)
+            if ((*bboxes)[l][j].contains(p) && islands[j].contains(p))
+                void_point = false;
+        
+        if (void_point) {
+            // no slice contains the point, so it's in the void
+            if (pillar.top_layer > 0) {
+                // we have a pillar, so extend it
+                pillar.bottom_layer = l + this->config.raft_layers;
+            } else if (object_hit) {
+                // we don't have a pillar and we're below the object, so create one
+                pillar.top_layer = l + this->config.raft_layers;
+            }
+        } else {
+            if (pillar.top_layer > 0) {
+                // we have a pillar which is not needed anymore, so store it and initialize a new potential pillar
+                (*pillars)[i].push_back(pillar);
+                pillar = SupportPillar(p);
+            }
+            object_hit = true;
+        }
+    }
+    if (pillar.top_layer > 0) (*pillars)[i].push_back(pillar);
+}
+
 void
 SLAPrint::_infill_layer(size_t i, const Fill* _fill)
 {
@@ -298,6 +370,84 @@ SLAPrint::write_svg(const std::string &outputfile) const
     fprintf(f,"</svg>\n");
 }
 
+Raster
+SLAPrint::rasterize_layer(size_t i) const
+{
+    Raster::Options options;
+    options.dpi      = this->config.raster_dpi.value;
+    options.mirror_x = this->config.raster_mirror_x.value;
+    options.mirror_y = this->config.raster_mirror_y.value;
+    options.rotation = this->config.raster_rotation.value;
+    options.samples  = this->config.raster_antialiasing.value;
+    Raster raster(BoundingBoxf(Pointf(this->bb.min.x, this->bb.min.y), Pointf(this->bb.max.x, this->bb.max.y)), options);
+    
+    const Layer &layer = this->layers[i];
+    
+    if (layer.solid) {
+        raster.draw(layer.slices.expolygons);
+    } else {
+        raster.draw(layer.perimeters.expolygons);
+        raster.draw(layer.solid_infill.expolygons);
+        for (ExtrusionEntitiesPtr::const_iterator it = layer.infill.entities.begin();
+            it != layer.infill.entities.end(); ++it)
+            raster.draw(union_ex((*it)->grow()));
+    }
+    
+    // don't print support material in raft layers
+    if (i >= (size_t)this->config.raft_layers) {
+        const double support_material_radius = sm_pillars_radius();
+        for (std::vector<SupportPillar>::const_iterator it = this->sm_pillars.begin(); it != this->sm_pillars.end(); ++it) {
+            if (!(it->top_layer >= i && it->bottom_layer <= i)) continue;
+            
+            // generate a conic tip
+            const float radius = fminf(
+                support_material_radius,
+                (it->top_layer - i + 1) * this->config.layer_height.value
+            );
+            raster.draw_circle(*it, scale_(radius));
+        }
+    }
+    return raster;
+}
+
+void
+SLAPrint::_png_layer(size_t i, std::vector<std::string>* images) const
+{
+    (*images)[i] = this->rasterize_layer(i).png();
+}
+
+void
+SLAPrint::write_png(const std::string &outputfile) const
+{
+    ZipArchive zip(outputfile, 'W');
+    if (!zip.z_stats())
+        throw std::runtime_error("Cannot create " + outputfile);
+    
+    // Render a few layers per thread at a time, so that only a batch of images is kept in memory.
+    const size_t threads = std::max(1, this->config.threads.value);
+    const size_t batch   = threads * 4;
+    std::vector<std::string> images(this->layers.size());
+    for (size_t first = 0; first < this->layers.size(); first += batch) {
+        const size_t last = std::min(first + batch, this->layers.size()) - 1;
+        parallelize<size_t>(
+            first,
+            last,
+            boost::bind(&SLAPrint::_png_layer, this, _1, &images),
+            threads
+        );
+        for (size_t i = first; i <= last; ++i) {
+            char name[32];
+            sprintf(name, "layer%05zu.png", i);
+            // PNG data is already deflated
+            if (!zip.add_entry_from_buffer(name, images[i].data(), images[i].size(), 0))
+                throw std::runtime_error("Failed to write " + outputfile);
+            std::string().swap(images[i]);
+        }
+    }
+    if (!zip.finalize())
+        throw std::runtime_error("Failed to write " + outputfile);
+}
+
 coordf_t
 SLAPrint::sm_pillars_radius() const
 {
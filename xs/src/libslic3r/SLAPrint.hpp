@@ -8,6 +8,7 @@
 #include "Model.hpp"
 #include "Point.hpp"
 #include "PrintConfig.hpp"
+#include "Raster.hpp"
 #include "SVG.hpp"
 
 namespace Slic3r {
@@ -42,11 +43,24 @@ class SLAPrint
     void slice();
     void write_svg(const std::string &outputfile) const;
     
+    /// Rasterize the layers and write them as PNG images into a zip archive.
+    /// The layers are rendered in parallel and written in batches, in layer order.
+    void write_png(const std::string &outputfile) const;
+    
+    /// Render a single layer into an image of the print area.
+    Raster rasterize_layer(size_t i) const;
+    
     private:
     Model* model;
     BoundingBoxf3 bb;
     
     void _infill_layer(size_t i, const Fill* fill);
+    void _layer_overhangs(size_t i, std::vector<Polygons>* overhangs) const;
+    void _island_pillars(size_t i, const ExPolygons* islands, std::vector<Points>* positions) const;
+    void _layer_islands_bboxes(size_t i, std::vector< std::vector<BoundingBox> >* bboxes) const;
+    void _scan_pillar(size_t i, const Points* positions, const std::vector< std::vector<BoundingBox> >* bboxes,
+        std::vector< std::vector<SupportPillar> >* pillars) const;
+    void _png_layer(size_t i, std::vector<std::string>* images) const;
     coordf_t sm_pillars_radius() const;
     std::string _SVG_path_d(const Polygon &polygon) const;
     std::string _SVG_path_d(const ExPolygon &expolygon) const;
@@ -1,4 +1,7 @@
 #include "Schematic.hpp"
+#include <algorithm>
+#include <map>
+#include <sstream>
 
 namespace Slic3r {
 
@@ -276,89 +279,157 @@ bool Schematic::removeNetPoint(const NetPoint* netPoint)
 
 Polylines Schematic::getChannels(const double z_bottom, const double z_top, const coord_t layer_overlap) const
 {
-    Polylines pls;
+    std::vector<std::pair<double, double> > layers;
+    layers.push_back(std::make_pair(z_bottom, z_top));
+    return this->getChannels(layers, layer_overlap).front();
+}
 
-    // collect rubberbands. Must be done by-net to evaluate waypointDegree for pin extensions at smd pads
-    for (ElectronicNets::const_iterator net = this->netlist.begin(); net != this->netlist.end(); ++net) {
-        // collect all rubberbands for this net
-        std::list<Line> lines;
-        for (RubberBandPtrs::const_iterator rb = (*net)->wiredRubberBands.begin(); rb != (*net)->wiredRubberBands.end(); ++rb) {
-            Lines l;
-            bool overlap_a, overlap_b;
-            if((*rb)->getLayerSegments(z_bottom, z_top, layer_overlap, &l, &overlap_a, &overlap_b)) {
-                for (Lines::iterator line = l.begin(); line != l.end(); ++line) {
-                    lines.push_back(*line);
-                }
+/* Computes the channels for all given layer intervals [z_bottom, z_top) in one sweep.
+ * Wired rubberbands are sorted by the lower bound of their z extent and kept in an
+ * active set while the sweep passes their z range, so each layer only touches
+ * the rubberbands actually crossing it instead of the whole netlist.
+ */
+std::vector<Polylines> Schematic::getChannels(const std::vector<std::pair<double, double> > &layers, const coord_t layer_overlap) const
+{
+    struct RubberBandExtent {
+        double z_min;
+        double z_max;
+        size_t net_id;
+        size_t rb_id;
+    };
+
+    std::vector<RubberBandExtent> extents;
+    for (size_t net_id = 0; net_id < this->netlist.size(); ++net_id) {
+        const RubberBandPtrs &rbs = this->netlist[net_id]->wiredRubberBands;
+        for (size_t rb_id = 0; rb_id < rbs.size(); ++rb_id) {
+            RubberBandExtent extent;
+            extent.z_min = rbs[rb_id]->getZMin();
+            extent.z_max = rbs[rb_id]->getZMax();
+            extent.net_id = net_id;
+            extent.rb_id = rb_id;
+            extents.push_back(extent);
+        }
+    }
+    std::sort(extents.begin(), extents.end(),
+        [](const RubberBandExtent &e1, const RubberBandExtent &e2) { return e1.z_min < e2.z_min; });
+
+    // sweep over layers in order of their bottom z
+    std::vector<size_t> order(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+        [&layers](size_t i1, size_t i2) { return layers[i1].first < layers[i2].first; });
+
+    std::vector<Polylines> result(layers.size());
+    std::list<const RubberBandExtent*> active;
+    size_t next_extent = 0;
+    for (size_t layer_id : order) {
+        const double z_bottom = layers[layer_id].first;
+        const double z_top = layers[layer_id].second;
+
+        while (next_extent < extents.size() && extents[next_extent].z_min < z_top) {
+            active.push_back(&extents[next_extent++]);
+        }
+        // rubberbands below this layer are also below all following layers
+        active.remove_if([z_bottom](const RubberBandExtent* e) { return e->z_max < z_bottom; });
+
+        // collect rubberbands by net, in netlist order. Must be done by-net to
+        // evaluate waypointDegree for pin extensions at smd pads
+        std::map<size_t, std::vector<size_t> > net_rbs;
+        for (const RubberBandExtent* e : active) {
+            if (e->z_min < z_top) {
+                net_rbs[e->net_id].push_back(e->rb_id);
             }
         }
 
-        // find connected subsets
-        while(lines.size() > 0) {
-            Polyline pl;
-            std::list<Line>::const_iterator line2;
-            // find an endpoint
-            for (std::list<Line>::iterator line1 = lines.begin(); line1 != lines.end(); ++line1) {
-                int hitsA = 0;
-                int hitsB = 0;
-                for (std::list<Line>::iterator line2 = lines.begin(); line2 != lines.end(); ++line2) {
-                    if(line1 == line2) {
-                        continue;
-                    }
-                    if(line1->a.coincides_with_epsilon(line2->a) || line1->a.coincides_with_epsilon(line2->b)) {
-                        hitsA++;
-                    }
-                    if(line1->b.coincides_with_epsilon(line2->a) || line1->b.coincides_with_epsilon(line2->b)) {
-                        hitsB++;
+        for (auto &net : net_rbs) {
+            // preserve rubberband order within the net
+            std::sort(net.second.begin(), net.second.end());
+            const RubberBandPtrs &rbs = this->netlist[net.first]->wiredRubberBands;
+            // collect all rubberbands for this net
+            std::list<Line> lines;
+            for (size_t rb_id : net.second) {
+                Lines l;
+                bool overlap_a, overlap_b;
+                if(rbs[rb_id]->getLayerSegments(z_bottom, z_top, layer_overlap, &l, &overlap_a, &overlap_b)) {
+                    for (Lines::iterator line = l.begin(); line != l.end(); ++line) {
+                        lines.push_back(*line);
                     }
                 }
-                if(hitsA == 0) {
-                    pl.append(line1->a);
-                    pl.append(line1->b);
-                    lines.erase(line1);
-                    break;
+            }
+            this->_chainLines(lines, &result[layer_id]);
+        }
+    }
+    return result;
+}
+
+// find connected subsets of lines and append them as polylines
+void Schematic::_chainLines(std::list<Line> &lines, Polylines* pls)
+{
+    // find connected subsets
+    while(lines.size() > 0) {
+        Polyline pl;
+        std::list<Line>::const_iterator line2;
+        // find an endpoint
+        for (std::list<Line>::iterator line1 = lines.begin(); line1 != lines.end(); ++line1) {
+            int hitsA = 0;
+            int hitsB = 0;
+            for (std::list<Line>::iterator line2 = lines.begin(); line2 != lines.end(); ++line2) {
+                if(line1 == line2) {
+                    continue;
                 }
-                if(hitsB == 0) {
-                    pl.append(line1->b);
-                    pl.append(line1->a);
-                    lines.erase(line1);
-                    break;
+                if(line1->a.coincides_with_epsilon(line2->a) || line1->a.coincides_with_epsilon(line2->b)) {
+                    hitsA++;
                 }
+                if(line1->b.coincides_with_epsilon(line2->a) || line1->b.coincides_with_epsilon(line2->b)) {
+                    hitsB++;
+                }
+            }
+            if(hitsA == 0) {
+                pl.append(line1->a);
+                pl.append(line1->b);
+                lines.erase(line1);
+                break;
             }
+            if(hitsB == 0) {
+                pl.append(line1->b);
+                pl.append(line1->a);
+                lines.erase(line1);
+                break;
+            }
+        }
 
-            // we now have an endpoint, traverse lines
-            int hits = 1;
-            while(hits == 1) {
-                hits = 0;
-                Point p = pl.last_point();
-                std::list<Line>::iterator stored_line;
-                Point stored_point;
-                for (std::list<Line>::iterator line = lines.begin(); line != lines.end(); ++line) {
-                    if(p.coincides_with_epsilon(line->a)) {
-                        hits++;
-                        if(hits == 1) {
-                            stored_point = line->b;
-                            stored_line = line;
-                            continue;
-                        }
-                    }
-                    if(p.coincides_with_epsilon(line->b)) {
-                        hits++;
-                        if(hits == 1) {
-                            stored_point = line->a;
-                            stored_line = line;
-                            continue;
-                        }
+        // we now have an endpoint, traverse lines
+        int hits = 1;
+        while(hits == 1) {
+            hits = 0;
+            Point p = pl.last_point();
+            std::list<Line>::iterator stored_line;
+            Point stored_point;
+            for (std::list<Line>::iterator line = lines.begin(); line != lines.end(); ++line) {
+                if(p.coincides_with_epsilon(line->a)) {
+                    hits++;
+                    if(hits == 1) {
+                        stored_point = line->b;
+                        stored_line = line;
+                        continue;
                     }
                 }
-                if(hits == 1) {
-                    pl.append(stored_point);
-                    lines.erase(stored_line);
+                if(p.coincides_with_epsilon(line->b)) {
+                    hits++;
+                    if(hits == 1) {
+                        stored_point = line->a;
+                        stored_line = line;
+                        continue;
+                    }
                 }
             }
-            pls.push_back(pl);
+            if(hits == 1) {
+                pl.append(stored_point);
+                lines.erase(stored_line);
+            }
         }
+        pls->push_back(pl);
     }
-    return pls;
 }
 
 
@@ -369,9 +440,26 @@ Polylines Schematic::getChannels(const double z_bottom, const double z_top, cons
  */
 bool Schematic::write3deFile(std::string filename, std::string filebase) {
     pugi::xml_document doc;
-    doc.append_attribute("encoding") = "UTF-8";
+    this->_write3de(&doc, filebase);
+    bool result = doc.save_file(filename.c_str());
+    return result;
+}
 
-    pugi::xml_node root_node = doc.append_child("electronics");
+/* Same as write3deFile, but returns the XML document
+ * as a string instead of writing it to a file.
+ */
+std::string Schematic::write3deString(std::string filebase) {
+    pugi::xml_document doc;
+    this->_write3de(&doc, filebase);
+    std::ostringstream out;
+    doc.save(out);
+    return out.str();
+}
+
+void Schematic::_write3de(pugi::xml_document* doc, std::string filebase) {
+    doc->append_attribute("encoding") = "UTF-8";
+
+    pugi::xml_node root_node = doc->append_child("electronics");
     root_node.append_attribute("version") = "0.1";
 
     pugi::xml_node file_node = root_node.append_child("filename");
@@ -463,9 +551,6 @@ bool Schematic::write3deFile(std::string filename, std::string filebase) {
             }
         }
     }
-
-    bool result = doc.save_file(filename.c_str());
-    return result;
 }
 
 /* Load placing and routing information from 3de file
@@ -473,9 +558,22 @@ bool Schematic::write3deFile(std::string filename, std::string filebase) {
  * will be imported from the corresponding file.
  */
 bool Schematic::load3deFile(std::string filename) {
-    bool result = false;
     pugi::xml_document doc;
     if (!doc.load_file(filename.c_str())) return false;
+    return this->_load3de(doc);
+}
+
+/* Same as load3deFile, but reads the XML document
+ * from a string written by write3deString.
+ */
+bool Schematic::load3deString(const std::string &data) {
+    pugi::xml_document doc;
+    if (!doc.load_buffer(data.data(), data.size())) return false;
+    return this->_load3de(doc);
+}
+
+bool Schematic::_load3de(const pugi::xml_document &doc) {
+    bool result = true;
 
     // import components
     pugi::xml_node parts = doc.child("electronics").child("parts");
@@ -30,6 +30,7 @@ class Schematic
     ElectronicPart* getElectronicPart(std::string partName);
     void addElectronicNet(ElectronicNet* net);
     ElectronicParts* getPartlist();
+    ElectronicNets* getNetlist() {return &this->netlist;};
     RubberBandPtrs* getRubberBands() {return &this->rubberBands;};
     void updateRubberBands();
     NetPointPtrs* getNetPoints();
@@ -43,13 +44,19 @@ class Schematic
     void updatePartNetPoints(ElectronicPart* part);
 
     Polylines getChannels(const double z_bottom, const double z_top, const coord_t layer_overlap) const;
+    std::vector<Polylines> getChannels(const std::vector<std::pair<double, double> > &layers, const coord_t layer_overlap) const;
 
     bool write3deFile(std::string filename, std::string filebase);
     bool load3deFile(std::string filename);
+    std::string write3deString(std::string filebase);
+    bool load3deString(const std::string &data);
 
 
     private:
     bool _checkRubberBandVisibility(const RubberBand* rb, const double z);
+    static void _chainLines(std::list<Line> &lines, Polylines* pls);
+    void _write3de(pugi::xml_document* doc, std::string filebase);
+    bool _load3de(const pugi::xml_document &doc);
 
     ElectronicNets netlist;
     ElectronicParts partlist;
@@ -24,8 +24,12 @@ namespace Slic3r
 void SlicingAdaptive::clear()
 {
     m_meshes.clear();
-    m_faces.clear();
+    m_face_min_z.clear();
+    m_face_max_z.clear();
     m_face_normal_z.clear();
+    m_horizontal_z.clear();
+    m_active_max_z.clear();
+    m_active_normal_z.clear();
 }
 
 std::pair<float, float> face_z_span(const stl_facet *f)
@@ -43,25 +47,38 @@ void SlicingAdaptive::prepare(coordf_t object_size)
     int nfaces_total = 0;
     for (std::vector<const TriangleMesh*>::const_iterator it_mesh = m_meshes.begin(); it_mesh != m_meshes.end(); ++ it_mesh)
         nfaces_total += (*it_mesh)->stl.stats.number_of_facets;
-    m_faces.reserve(nfaces_total);
+    // Their Z span is computed once per face.
+    std::vector<std::pair<std::pair<float, float>, const stl_facet*>> spans;
+    spans.reserve(nfaces_total);
     for (std::vector<const TriangleMesh*>::const_iterator it_mesh = m_meshes.begin(); it_mesh != m_meshes.end(); ++ it_mesh)
         for (int i = 0; i < (*it_mesh)->stl.stats.number_of_facets; ++ i)
-            m_faces.push_back((*it_mesh)->stl.facet_start + i);
+            spans.push_back(std::make_pair(face_z_span((*it_mesh)->stl.facet_start + i), (*it_mesh)->stl.facet_start + i));
 
     // 2) Sort faces lexicographically by their Z span.
-    std::sort(m_faces.begin(), m_faces.end(), [](const stl_facet *f1, const stl_facet *f2) {
-        std::pair<float, float> span1 = face_z_span(f1);
-        std::pair<float, float> span2 = face_z_span(f2);
-        return span1 < span2;
+    std::sort(spans.begin(), spans.end(), [](const std::pair<std::pair<float, float>, const stl_facet*> &s1, const std::pair<std::pair<float, float>, const stl_facet*> &s2) {
+        return s1.first < s2.first;
     });
 
-    // 3) Generate Z components of the facet normals.
-    m_face_normal_z.assign(m_faces.size(), 0.f);
-    for (size_t iface = 0; iface < m_faces.size(); ++ iface)
-        m_face_normal_z[iface] = m_faces[iface]->normal.z;
+    // 3) Split the Z spans and the Z components of the facet normals into separate arrays,
+    // the horizontal faces are collected apart.
+    m_face_min_z.assign(spans.size(), 0.f);
+    m_face_max_z.assign(spans.size(), 0.f);
+    m_face_normal_z.assign(spans.size(), 0.f);
+    m_horizontal_z.clear();
+    for (size_t iface = 0; iface < spans.size(); ++ iface) {
+        m_face_min_z[iface]    = spans[iface].first.first;
+        m_face_max_z[iface]    = spans[iface].first.second;
+        m_face_normal_z[iface] = std::abs(spans[iface].second->normal.z);
+        // min_z == max_z -> horizontal facet
+        if (m_face_min_z[iface] == m_face_max_z[iface])
+            m_horizontal_z.push_back(m_face_min_z[iface]);
+    }
 
-    // 4) Reset current facet pointer
+    // 4) Reset current facet pointer and the active faces
     this->current_facet = 0;
+    m_active_z = 0;
+    m_active_max_z.clear();
+    m_active_normal_z.clear();
 }
 
 float SlicingAdaptive::next_layer_height(coordf_t z, coordf_t quality_factor, coordf_t min_layer_height, coordf_t max_layer_height)
@@ -77,49 +94,61 @@ float SlicingAdaptive::next_layer_height(coordf_t z, coordf_t quality_factor, co
     float delta_max = SURFACE_CONST * max_layer_height + 0.5 * max_layer_height;
     float scaled_quality_factor = quality_factor * (delta_max - delta_min) + delta_min;
 
-    bool first_hit = false;
-
-    // find all facets intersecting the slice-layer
-    int ordered_id = current_facet;
-    for (; ordered_id < int(m_faces.size()); ++ ordered_id) {
-        std::pair<float, float> zspan = face_z_span(m_faces[ordered_id]);
-        // facet's minimum is higher than slice_z -> end loop
-        if (zspan.first >= z)
-            break;
-        // facet's maximum is higher than slice_z -> store the first event for next layer_height call to begin at this point
-        if (zspan.second > z) {
-            // first event?
-            if (! first_hit) {
-                first_hit = true;
-                current_facet = ordered_id;
-            }
-            // skip touching facets which could otherwise cause small height values
-            if (zspan.second <= z + EPSILON)
-                continue;
-            // compute height for this facet and store minimum of all heights
-            height = std::min(height, this->_layer_height_from_facet(ordered_id, scaled_quality_factor));
+    // Update the faces intersecting the slice-layer: the faces ending below it are dropped,
+    // the ones starting below it are added. The layers are usually requested bottom up,
+    // so each face is only visited while the slice-layer crosses it.
+    if (z < m_active_z) {
+        current_facet = 0;
+        m_active_max_z.clear();
+        m_active_normal_z.clear();
+    }
+    m_active_z = z;
+    size_t nactive = 0;
+    for (size_t i = 0; i < m_active_max_z.size(); ++ i) {
+        if (m_active_max_z[i] > z) {
+            m_active_max_z[nactive]    = m_active_max_z[i];
+            m_active_normal_z[nactive] = m_active_normal_z[i];
+            ++ nactive;
         }
     }
+    m_active_max_z.resize(nactive);
+    m_active_normal_z.resize(nactive);
+    // facet's minimum is higher than slice_z -> end loop
+    for (; current_facet < int(m_face_min_z.size()) && m_face_min_z[current_facet] < z; ++ current_facet) {
+        // facet's maximum is higher than slice_z -> the facet intersects the slice-layer
+        if (m_face_max_z[current_facet] > z) {
+            m_active_max_z.push_back(m_face_max_z[current_facet]);
+            m_active_normal_z.push_back(m_face_normal_z[current_facet]);
+        }
+    }
+
+    // The height decreases with the normal, so the steepest facet gives the minimum of all heights.
+    // Skip touching facets which could otherwise cause small height values.
+    const coordf_t z_touching = z + EPSILON;
+    float normal_z = -1.f;
+    for (size_t i = 0; i < m_active_max_z.size(); ++ i)
+        normal_z = std::max(normal_z, (m_active_max_z[i] > z_touching) ? m_active_normal_z[i] : -1.f);
+    if (normal_z >= 0.f)
+        height = std::min(height, this->_layer_height_from_normal(normal_z, scaled_quality_factor));
 
     // lower height limit due to printer capabilities
     height = std::max<float>(height, min_layer_height);
 
     // check for sloped facets inside the determined layer and correct height if necessary
     if (height > min_layer_height) {
-        for (; ordered_id < int(m_faces.size()); ++ ordered_id) {
-            std::pair<float, float> zspan = face_z_span(m_faces[ordered_id]);
+        for (int ordered_id = current_facet; ordered_id < int(m_face_min_z.size()); ++ ordered_id) {
             // facet's minimum is higher than slice_z + height -> end loop
-            if (zspan.first >= z + height)
+            if (m_face_min_z[ordered_id] >= z + height)
                 break;
 
             // skip touching facets which could otherwise cause small cusp values
-            if (zspan.second <= z + EPSILON)
+            if (m_face_max_z[ordered_id] <= z + EPSILON)
                 continue;
 
             // Compute new height for this facet and check against height.
-            float reduced_height = this->_layer_height_from_facet(ordered_id, scaled_quality_factor);
+            float reduced_height = this->_layer_height_from_normal(m_face_normal_z[ordered_id], scaled_quality_factor);
 
-            float z_diff = zspan.first - z;
+            float z_diff = m_face_min_z[ordered_id] - z;
 
             if (reduced_height > z_diff) {
                 if (reduced_height < height) {
@@ -155,15 +184,10 @@ float SlicingAdaptive::next_layer_height(coordf_t z, coordf_t quality_factor, co
 // to consider horizontal object features in slice thickness
 float SlicingAdaptive::horizontal_facet_distance(coordf_t z, coordf_t max_layer_height)
 {
-    for (size_t i = 0; i < m_faces.size(); ++ i) {
-        std::pair<float, float> zspan = face_z_span(m_faces[i]);
-        // facet's minimum is higher than max forward distance -> end loop
-        if (zspan.first > z + max_layer_height)
-            break;
-        // min_z == max_z -> horizontal facet
-        if (zspan.first > z && zspan.first == zspan.second)
-            return zspan.first - z;
-    }
+    // first horizontal facet above z, unless it's higher than max forward distance
+    std::vector<float>::const_iterator it = std::upper_bound(m_horizontal_z.begin(), m_horizontal_z.end(), z);
+    if (it != m_horizontal_z.end() && *it <= z + max_layer_height)
+        return *it - z;
 
     // objects maximum?
     return (z + max_layer_height > this->object_size) ?
@@ -171,10 +195,9 @@ float SlicingAdaptive::horizontal_facet_distance(coordf_t z, coordf_t max_layer_
         max_layer_height;
 }
 
-// for a given facet, compute maximum height within the allowed surface roughness / stairstepping deviation
-float SlicingAdaptive::_layer_height_from_facet(int ordered_id, float scaled_quality_factor)
+// for a given facet normal, compute maximum height within the allowed surface roughness / stairstepping deviation
+float SlicingAdaptive::_layer_height_from_normal(float normal_z, float scaled_quality_factor) const
 {
-    float normal_z = std::abs(m_face_normal_z[ordered_id]);
     float height = scaled_quality_factor/(SURFACE_CONST + normal_z/2);
     return height;
 }
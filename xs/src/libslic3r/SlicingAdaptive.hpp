@@ -20,17 +20,24 @@ public:
     float horizontal_facet_distance(coordf_t z, coordf_t max_layer_height);
 
 private:
-    float _layer_height_from_facet(int ordered_id, float scaled_quality_factor);
+    float _layer_height_from_normal(float normal_z, float scaled_quality_factor) const;
 
 protected:
-    // id of the current facet from last iteration
     coordf_t                            object_size;
+    // id of the first facet not yet added to the active facets
     int                                 current_facet;
     std::vector<const TriangleMesh*>	m_meshes;
-    // Collected faces of all meshes, sorted by raising Z of the bottom most face.
-    std::vector<const stl_facet*>		m_faces;
-    // Z component of face normals, normalized.
+    // Z span and Z component of the normal (absolute, normalized) of the faces of all meshes,
+    // sorted by raising Z of the bottom most vertex.
+    std::vector<float>					m_face_min_z;
+    std::vector<float>					m_face_max_z;
     std::vector<float>					m_face_normal_z;
+    // Z of the horizontal faces, sorted.
+    std::vector<float>					m_horizontal_z;
+    // Faces crossing the Z of the last next_layer_height() call: their top Z and their normal Z.
+    coordf_t                            m_active_z;
+    std::vector<float>					m_active_max_z;
+    std::vector<float>					m_active_normal_z;
 };
 
 }; // namespace Slic3r
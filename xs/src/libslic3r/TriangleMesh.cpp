@@ -7,12 +7,14 @@
 #include <set>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <utility>
 #include <algorithm>
 #include <math.h>
 #include <assert.h>
 #include <stdexcept>
 #include <boost/config.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/nowide/convert.hpp>
 
 #ifdef SLIC3R_DEBUG
@@ -734,6 +736,89 @@ TriangleMesh::make_sphere(double rho, double fa) {
     return mesh;
 }
 
+TransformationMatrix::TransformationMatrix()
+{
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 4; ++j)
+            this->m[i][j] = (i == j) ? 1. : 0.;
+}
+
+void
+TransformationMatrix::apply(const TransformationMatrix &other)
+{
+    TransformationMatrix result;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            double v = (j == 3) ? other.m[i][3] : 0.;
+            for (int k = 0; k < 3; ++k)
+                v += other.m[i][k] * this->m[k][j];
+            result.m[i][j] = v;
+        }
+    }
+    *this = result;
+}
+
+/// Rotates around the given axis like TriangleMesh::rotate(), angle is in radians.
+void
+TransformationMatrix::rotate(double angle, const Axis &axis)
+{
+    if (angle == 0) return;
+    const double c = cos(angle);
+    const double s = sin(angle);
+    
+    // the rotated pair of coordinates, in the order used by admesh
+    int a = 0, b = 1;
+    if (axis == X) {
+        a = 1; b = 2;
+    } else if (axis == Y) {
+        a = 2; b = 0;
+    }
+    TransformationMatrix rotation;
+    rotation.m[a][a] = c;
+    rotation.m[a][b] = -s;
+    rotation.m[b][a] = s;
+    rotation.m[b][b] = c;
+    this->apply(rotation);
+}
+
+void
+TransformationMatrix::scale(const Pointf3 &versor)
+{
+    for (int j = 0; j < 4; ++j) {
+        this->m[0][j] *= versor.x;
+        this->m[1][j] *= versor.y;
+        this->m[2][j] *= versor.z;
+    }
+}
+
+void
+TransformationMatrix::translate(double x, double y, double z)
+{
+    this->m[0][3] += x;
+    this->m[1][3] += y;
+    this->m[2][3] += z;
+}
+
+bool
+TransformationMatrix::is_identity() const
+{
+    const TransformationMatrix identity;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 4; ++j)
+            if (this->m[i][j] != identity.m[i][j]) return false;
+    return true;
+}
+
+Pointf3
+TransformationMatrix::transform(double x, double y, double z) const
+{
+    return Pointf3(
+        this->m[0][0] * x + this->m[0][1] * y + this->m[0][2] * z + this->m[0][3],
+        this->m[1][0] * x + this->m[1][1] * y + this->m[1][2] * z + this->m[1][3],
+        this->m[2][0] * x + this->m[2][1] * y + this->m[2][2] * z + this->m[2][3]
+    );
+}
+
 template <Axis A>
 void
 TriangleMeshSlicer<A>::slice(const std::vector<float> &z, std::vector<Polygons>* layers) const
@@ -770,8 +855,8 @@ TriangleMeshSlicer<A>::slice(const std::vector<float> &z, std::vector<Polygons>*
         boost::mutex lines_mutex;
         parallelize<int>(
             0,
-            this->mesh->stl.stats.number_of_facets-1,
-            boost::bind(&TriangleMeshSlicer<A>::_slice_do, this, _1, &lines, &lines_mutex, z)
+            this->meshes_facets.back()-1,
+            boost::bind(&TriangleMeshSlicer<A>::_slice_do, this, _1, &lines, &lines_mutex, z, false)
         );
     }
     
@@ -779,19 +864,78 @@ TriangleMeshSlicer<A>::slice(const std::vector<float> &z, std::vector<Polygons>*
     
     // build loops
     layers->resize(z.size());
-    parallelize<size_t>(
-        0,
-        lines.size()-1,
-        boost::bind(&TriangleMeshSlicer<A>::_make_loops_do, this, _1, &lines, layers)
-    );
+    if (!lines.empty())
+        parallelize<size_t>(
+            0,
+            lines.size()-1,
+            boost::bind(&TriangleMeshSlicer<A>::_make_loops_do, this, _1, &lines, layers)
+        );
+}
+
+template <Axis A>
+void
+TriangleMeshSlicer<A>::slice(const std::vector<float> &z, std::vector< std::vector<Polygons> >* layers) const
+{
+    /*  The intersection lines of each layer are collected per mesh, so that
+        the loops of a mesh never get connected to the ones of another mesh
+        even where they touch or overlap. Line (layer_idx, mesh_idx) goes to
+        lines[layer_idx * meshes + mesh_idx].  */
+    const size_t volumes = this->meshes.size();
+    std::vector<IntersectionLines> lines(z.size() * volumes);
+    {
+        boost::mutex lines_mutex;
+        parallelize<int>(
+            0,
+            this->meshes_facets.back()-1,
+            boost::bind(&TriangleMeshSlicer<A>::_slice_do, this, _1, &lines, &lines_mutex, z, true)
+        );
+    }
+    
+    // build the loops of all the meshes in a single pass
+    std::vector<Polygons> loops(lines.size());
+    if (!lines.empty())
+        parallelize<size_t>(
+            0,
+            lines.size()-1,
+            boost::bind(&TriangleMeshSlicer<A>::_make_loops_do, this, _1, &lines, &loops)
+        );
+    
+    layers->assign(volumes, std::vector<Polygons>(z.size()));
+    for (size_t layer_idx = 0; layer_idx < z.size(); ++layer_idx)
+        for (size_t volume = 0; volume < volumes; ++volume)
+            (*layers)[volume][layer_idx] = std::move(loops[layer_idx * volumes + volume]);
+}
+
+template <Axis A>
+stl_facet
+TriangleMeshSlicer<A>::_facet(size_t facet_idx) const
+{
+    stl_facet facet;
+    for (int i = 0; i <= 2; ++i)
+        facet.vertex[i] = this->v_shared[ this->facets_vertices[facet_idx*3 + i] ];
+    const double ux = facet.vertex[1].x - facet.vertex[0].x, vx = facet.vertex[2].x - facet.vertex[0].x;
+    const double uy = facet.vertex[1].y - facet.vertex[0].y, vy = facet.vertex[2].y - facet.vertex[0].y;
+    const double uz = facet.vertex[1].z - facet.vertex[0].z, vz = facet.vertex[2].z - facet.vertex[0].z;
+    facet.normal.x = float(uy * vz - uz * vy);
+    facet.normal.y = float(uz * vx - ux * vz);
+    facet.normal.z = float(ux * vy - uy * vx);
+    facet.extra[0] = facet.extra[1] = 0;
+    return facet;
 }
 
 template <Axis A>
 void
 TriangleMeshSlicer<A>::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, 
-    const std::vector<float> &z) const
+    const std::vector<float> &z, bool by_mesh) const
 {
-    const stl_facet &facet = this->mesh->stl.facet_start[facet_idx];
+    // only the sign of the normal matters here
+    const stl_facet facet = this->_facet(facet_idx);
+    
+    // the lines of the meshes are kept apart when slicing them one by one
+    const size_t volumes = by_mesh ? this->meshes.size() : 1;
+    const size_t volume = by_mesh
+        ? std::upper_bound(this->meshes_facets.begin(), this->meshes_facets.end(), int(facet_idx)) - this->meshes_facets.begin() - 1
+        : 0;
     
     // find facet extents
     const float min_z = fminf(_z(facet.vertex[0]), fminf(_z(facet.vertex[1]), _z(facet.vertex[2])));
@@ -815,7 +959,7 @@ TriangleMeshSlicer<A>::_slice_do(size_t facet_idx, std::vector<IntersectionLines
     
     for (std::vector<float>::const_iterator it = min_layer; it != max_layer + 1; ++it) {
         std::vector<float>::size_type layer_idx = it - z.begin();
-        this->slice_facet(*it / SCALING_FACTOR, facet, facet_idx, min_z, max_z, &(*lines)[layer_idx], lines_mutex);
+        this->slice_facet(*it / SCALING_FACTOR, facet, facet_idx, min_z, max_z, &(*lines)[layer_idx * volumes + volume], lines_mutex);
     }
 }
 
@@ -870,22 +1014,22 @@ TriangleMeshSlicer<A>::slice_facet(float slice_z, const stl_facet &facet, const
         i = 2;
     }
     for (int j = i; (j-i) < 3; j++) {  // loop through facet edges
-        int edge_id = this->facets_edges[facet_idx][j % 3];
-        int a_id = this->mesh->stl.v_indices[facet_idx].vertex[j % 3];
-        int b_id = this->mesh->stl.v_indices[facet_idx].vertex[(j+1) % 3];
-        stl_vertex* a = &this->v_scaled_shared[a_id];
-        stl_vertex* b = &this->v_scaled_shared[b_id];
+        int edge_id = this->facets_edges[facet_idx*3 + j % 3];
+        int a_id = this->facets_vertices[facet_idx*3 + j % 3];
+        int b_id = this->facets_vertices[facet_idx*3 + (j+1) % 3];
+        const stl_vertex* a = &this->v_scaled_shared[a_id];
+        const stl_vertex* b = &this->v_scaled_shared[b_id];
         
         if (_z(*a) == _z(*b) && _z(*a) == slice_z) {
             // edge is horizontal and belongs to the current layer
             
-            stl_vertex &v0 = this->v_scaled_shared[ this->mesh->stl.v_indices[facet_idx].vertex[0] ];
-            stl_vertex &v1 = this->v_scaled_shared[ this->mesh->stl.v_indices[facet_idx].vertex[1] ];
-            stl_vertex &v2 = this->v_scaled_shared[ this->mesh->stl.v_indices[facet_idx].vertex[2] ];
+            const stl_vertex &v0 = this->v_scaled_shared[ this->facets_vertices[facet_idx*3 + 0] ];
+            const stl_vertex &v1 = this->v_scaled_shared[ this->facets_vertices[facet_idx*3 + 1] ];
+            const stl_vertex &v2 = this->v_scaled_shared[ this->facets_vertices[facet_idx*3 + 2] ];
             IntersectionLine line;
             if (min_z == max_z) {
                 line.edge_type = feHorizontal;
-                if (_z(this->mesh->stl.facet_start[facet_idx].normal) < 0) {
+                if (_z(facet.normal) < 0) {
                     /*  if normal points downwards this is a bottom horizontal facet so we reverse
                         its point order */
                     std::swap(a, b);
@@ -1025,8 +1169,8 @@ TriangleMeshSlicer<A>::make_loops(std::vector<IntersectionLine> &lines, Polygons
     
     // build a map of lines by edge_a_id and a_id
     std::vector<IntersectionLinePtrs> by_edge_a_id, by_a_id;
-    by_edge_a_id.resize(this->mesh->stl.stats.number_of_facets * 3);
-    by_a_id.resize(this->mesh->stl.stats.shared_vertices);
+    by_edge_a_id.resize(this->facets_edges.size());
+    by_a_id.resize(this->v_scaled_shared.size());
     for (IntersectionLines::iterator line = lines.begin(); line != lines.end(); ++line) {
         if (line->skip) continue;
         if (line->edge_a_id != -1) by_edge_a_id[line->edge_a_id].push_back(&(*line));
@@ -1244,16 +1388,18 @@ TriangleMeshSlicer<A>::cut(float z, TriangleMesh* upper, TriangleMesh* lower) co
     IntersectionLines upper_lines, lower_lines;
     
     const float scaled_z = scale_(z);
-    for (int facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; facet_idx++) {
-        stl_facet* facet = &this->mesh->stl.facet_start[facet_idx];
+    for (int facet_idx = 0; facet_idx < this->meshes_facets.back(); facet_idx++) {
+        // the facets are read from the tables of the slicer, which match its shared vertices
+        stl_facet facet = this->_facet(facet_idx);
+        stl_normalize_vector(&facet.normal.x);
         
         // find facet extents
-        float min_z = fminf(_z(facet->vertex[0]), fminf(_z(facet->vertex[1]), _z(facet->vertex[2])));
-        float max_z = fmaxf(_z(facet->vertex[0]), fmaxf(_z(facet->vertex[1]), _z(facet->vertex[2])));
+        float min_z = fminf(_z(facet.vertex[0]), fminf(_z(facet.vertex[1]), _z(facet.vertex[2])));
+        float max_z = fmaxf(_z(facet.vertex[0]), fmaxf(_z(facet.vertex[1]), _z(facet.vertex[2])));
         
         // intersect facet with cutting plane
         IntersectionLines lines;
-        this->slice_facet(scaled_z, *facet, facet_idx, min_z, max_z, &lines);
+        this->slice_facet(scaled_z, facet, facet_idx, min_z, max_z, &lines);
         
         // save intersection lines for generating correct triangulations
         for (IntersectionLines::const_iterator it = lines.begin(); it != lines.end(); ++it) {
@@ -1269,27 +1415,27 @@ TriangleMeshSlicer<A>::cut(float z, TriangleMesh* upper, TriangleMesh* lower) co
         
         if (min_z > z || (min_z == z && max_z > min_z)) {
             // facet is above the cut plane and does not belong to it
-            if (upper != NULL) stl_add_facet(&upper->stl, facet);
+            if (upper != NULL) stl_add_facet(&upper->stl, &facet);
         } else if (max_z < z || (max_z == z && max_z > min_z)) {
             // facet is below the cut plane and does not belong to it
-            if (lower != NULL) stl_add_facet(&lower->stl, facet);
+            if (lower != NULL) stl_add_facet(&lower->stl, &facet);
         } else if (min_z < z && max_z > z) {
             // facet is cut by the slicing plane
             
             // look for the vertex on whose side of the slicing plane there are no other vertices
             int isolated_vertex;
-            if ( (_z(facet->vertex[0]) > z) == (_z(facet->vertex[1]) > z) ) {
+            if ( (_z(facet.vertex[0]) > z) == (_z(facet.vertex[1]) > z) ) {
                 isolated_vertex = 2;
-            } else if ( (_z(facet->vertex[1]) > z) == (_z(facet->vertex[2]) > z) ) {
+            } else if ( (_z(facet.vertex[1]) > z) == (_z(facet.vertex[2]) > z) ) {
                 isolated_vertex = 0;
             } else {
                 isolated_vertex = 1;
             }
             
             // get vertices starting from the isolated one
-            stl_vertex* v0 = &facet->vertex[isolated_vertex];
-            stl_vertex* v1 = &facet->vertex[(isolated_vertex+1) % 3];
-            stl_vertex* v2 = &facet->vertex[(isolated_vertex+2) % 3];
+            stl_vertex* v0 = &facet.vertex[isolated_vertex];
+            stl_vertex* v1 = &facet.vertex[(isolated_vertex+1) % 3];
+            stl_vertex* v2 = &facet.vertex[(isolated_vertex+2) % 3];
             
             // intersect v0-v1 and v2-v0 with cutting plane and make new vertices
             stl_vertex v0v1, v2v0;
@@ -1302,18 +1448,18 @@ TriangleMeshSlicer<A>::cut(float z, TriangleMesh* upper, TriangleMesh* lower) co
             
             // build the triangular facet
             stl_facet triangle;
-            triangle.normal = facet->normal;
+            triangle.normal = facet.normal;
             triangle.vertex[0] = *v0;
             triangle.vertex[1] = v0v1;
             triangle.vertex[2] = v2v0;
             
             // build the facets forming a quadrilateral on the other side
             stl_facet quadrilateral[2];
-            quadrilateral[0].normal = facet->normal;
+            quadrilateral[0].normal = facet.normal;
             quadrilateral[0].vertex[0] = *v1;
             quadrilateral[0].vertex[1] = *v2;
             quadrilateral[0].vertex[2] = v0v1;
-            quadrilateral[1].normal = facet->normal;
+            quadrilateral[1].normal = facet.normal;
             quadrilateral[1].vertex[0] = *v2;
             quadrilateral[1].vertex[1] = v2v0;
             quadrilateral[1].vertex[2] = v0v1;
@@ -1394,26 +1540,87 @@ TriangleMeshSlicer<A>::cut(float z, TriangleMesh* upper, TriangleMesh* lower) co
 }
 
 template <Axis A>
-TriangleMeshSlicer<A>::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), v_scaled_shared(NULL)
+TriangleMeshSlicer<A>::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh)
+{
+    this->meshes.push_back(_mesh);
+    this->_init(TransformationMatrix());
+}
+
+template <Axis A>
+TriangleMeshSlicer<A>::TriangleMeshSlicer(const TriangleMeshPtrs &meshes, const TransformationMatrix &trafo)
+    : mesh(meshes.empty() ? NULL : meshes.front()), meshes(meshes)
+{
+    this->_init(trafo);
+}
+
+// Identifies the vertices of a mesh by their exact coordinates.
+struct stl_vertex_hash {
+    size_t operator()(const stl_vertex &v) const {
+        size_t seed = 0;
+        boost::hash_combine(seed, v.x);
+        boost::hash_combine(seed, v.y);
+        boost::hash_combine(seed, v.z);
+        return seed;
+    }
+};
+
+struct stl_vertex_equal {
+    bool operator()(const stl_vertex &a, const stl_vertex &b) const {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+};
+
+template <Axis A>
+void
+TriangleMeshSlicer<A>::_init(const TransformationMatrix &trafo)
 {
     // build a table to map a facet_idx to its three edge indices
-    this->mesh->require_shared_vertices();
     typedef std::pair<int,int>              t_edge;
     typedef std::vector<t_edge>             t_edges;  // edge_idx => a_id,b_id
     typedef std::map<t_edge,int>            t_edges_map;  // a_id,b_id => edge_idx
     
-    this->facets_edges.resize(this->mesh->stl.stats.number_of_facets);
-    
-    {
-        t_edges edges;
+    const bool identity = trafo.is_identity();
+    t_edges edges;
+    t_edges_map edges_map;
+    this->meshes_facets.push_back(0);
+    for (const TriangleMesh* mesh : this->meshes) {
+        const stl_file &stl = mesh->stl;
+        
+        // the vertices of this mesh are numbered after the ones of the previous meshes
+        const int vertices_offset = this->v_shared.size();
+        const int number_of_facets = stl.stats.number_of_facets;
+        this->meshes_facets.push_back(this->meshes_facets.back() + number_of_facets);
+        
+        // the meshes belong to the caller and are left untouched: when a mesh has no
+        // shared vertices, its vertices are shared here by their exact coordinates
+        std::vector<int> vertex_ids(number_of_facets * 3);
+        if (stl.v_shared != NULL) {
+            for (int facet_idx = 0; facet_idx < number_of_facets; facet_idx++)
+                for (int i = 0; i <= 2; i++)
+                    vertex_ids[facet_idx * 3 + i] = vertices_offset + stl.v_indices[facet_idx].vertex[i];
+            this->v_shared.insert(this->v_shared.end(), stl.v_shared, stl.v_shared + stl.stats.shared_vertices);
+        } else {
+            std::unordered_map<stl_vertex, int, stl_vertex_hash, stl_vertex_equal> vertices_map;
+            vertices_map.reserve(number_of_facets / 2);  // a closed mesh has about half as many vertices as facets
+            for (int facet_idx = 0; facet_idx < number_of_facets; facet_idx++) {
+                for (int i = 0; i <= 2; i++) {
+                    const stl_vertex &vertex = stl.facet_start[facet_idx].vertex[i];
+                    const auto inserted = vertices_map.insert(std::make_pair(vertex, int(this->v_shared.size())));
+                    if (inserted.second)
+                        this->v_shared.push_back(vertex);
+                    vertex_ids[facet_idx * 3 + i] = inserted.first->second;
+                }
+            }
+        }
+        this->facets_vertices.reserve(this->facets_vertices.size() + number_of_facets * 3);
+        this->facets_edges.reserve(this->facets_edges.size() + number_of_facets * 3);
         // reserve() instad of resize() because otherwise we couldn't read .size() below to assign edge_idx
-        edges.reserve(this->mesh->stl.stats.number_of_facets * 3);  // number of edges = number of facets * 3
-        t_edges_map edges_map;
-        for (int facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; facet_idx++) {
-            this->facets_edges[facet_idx].resize(3);
+        edges.reserve(edges.size() + number_of_facets * 3);  // number of edges = number of facets * 3
+        
+        for (int facet_idx = 0; facet_idx < number_of_facets; facet_idx++) {
             for (int i = 0; i <= 2; i++) {
-                int a_id = this->mesh->stl.v_indices[facet_idx].vertex[i];
-                int b_id = this->mesh->stl.v_indices[facet_idx].vertex[(i+1) % 3];
+                int a_id = vertex_ids[facet_idx * 3 + i];
+                int b_id = vertex_ids[facet_idx * 3 + (i+1) % 3];
                 
                 int edge_idx;
                 t_edges_map::const_iterator my_edge = edges_map.find(std::make_pair(b_id,a_id));
@@ -1434,29 +1641,38 @@ TriangleMeshSlicer<A>::TriangleMeshSlicer(TriangleMesh* _mesh) : mesh(_mesh), v_
                         edges_map[ edges[edge_idx] ] = edge_idx;
                     }
                 }
-                this->facets_edges[facet_idx][i] = edge_idx;
+                this->facets_vertices.push_back(a_id);
+                this->facets_edges.push_back(edge_idx);
                 
                 #ifdef SLIC3R_DEBUG
                 printf("  [facet %d, edge %d] a_id = %d, b_id = %d   --> edge %d\n", facet_idx, i, a_id, b_id, edge_idx);
                 #endif
             }
         }
+        
+        // transform the shared vertices coordinates, then clone and scale them
+        if (!identity) {
+            for (size_t i = vertices_offset; i < this->v_shared.size(); ++i) {
+                stl_vertex &v = this->v_shared[i];
+                const Pointf3 p = trafo.transform(v.x, v.y, v.z);
+                v.x = p.x;
+                v.y = p.y;
+                v.z = p.z;
+            }
+        }
     }
     
-    // clone shared vertices coordinates and scale them
-    this->v_scaled_shared = (stl_vertex*)calloc(this->mesh->stl.stats.shared_vertices, sizeof(stl_vertex));
-    std::copy(this->mesh->stl.v_shared, this->mesh->stl.v_shared + this->mesh->stl.stats.shared_vertices, this->v_scaled_shared);
-    for (int i = 0; i < this->mesh->stl.stats.shared_vertices; i++) {
-        this->v_scaled_shared[i].x /= SCALING_FACTOR;
-        this->v_scaled_shared[i].y /= SCALING_FACTOR;
-        this->v_scaled_shared[i].z /= SCALING_FACTOR;
+    this->v_scaled_shared = this->v_shared;
+    for (stl_vertex &v : this->v_scaled_shared) {
+        v.x /= SCALING_FACTOR;
+        v.y /= SCALING_FACTOR;
+        v.z /= SCALING_FACTOR;
     }
 }
 
 template <Axis A>
 TriangleMeshSlicer<A>::~TriangleMeshSlicer()
 {
-    if (this->v_scaled_shared != NULL) free(this->v_scaled_shared);
 }
 
 template class TriangleMeshSlicer<X>;
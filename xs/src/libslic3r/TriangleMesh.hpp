@@ -17,6 +17,26 @@ class TriangleMesh;
 template <Axis A> class TriangleMeshSlicer;
 typedef std::vector<TriangleMesh*> TriangleMeshPtrs;
 
+/// Affine transformation of the mesh vertices, stored as the 3x4 matrix [R|t]: v' = R * v + t.
+/// The transformations are composed in the order they're applied, like the ones of TriangleMesh.
+class TransformationMatrix
+{
+    public:
+    double m[3][4];
+    
+    /// Identity transformation.
+    TransformationMatrix();
+    void rotate(double angle, const Axis &axis);
+    void scale(const Pointf3 &versor);
+    void translate(double x, double y, double z);
+    bool is_identity() const;
+    Pointf3 transform(double x, double y, double z) const;
+    
+    private:
+    /// Applies other after this transformation.
+    void apply(const TransformationMatrix &other);
+};
+
 class TriangleMesh
 {
     public:
@@ -115,12 +135,27 @@ template <Axis A>
 class TriangleMeshSlicer
 {
     public:
+    /// The first (or only) mesh being sliced.
     TriangleMesh* mesh;
     TriangleMeshSlicer(TriangleMesh* _mesh);
+    
+    /// \brief Slices several meshes at once, each one in its own frame.
+    /// The vertices are transformed while they're scaled, so the meshes don't need to be
+    /// copied nor transformed. They are never modified: the vertices of a mesh without
+    /// shared vertices are numbered by the slicer from their coordinates.
+    /// \param[in] meshes Meshes to slice, their facets are numbered one mesh after the other.
+    /// \param[in] trafo Transformation from the frame of the meshes to the one of the slices.
+    TriangleMeshSlicer(const TriangleMeshPtrs &meshes, const TransformationMatrix &trafo);
     ~TriangleMeshSlicer();
     void slice(const std::vector<float> &z, std::vector<Polygons>* layers) const;
     void slice(const std::vector<float> &z, std::vector<ExPolygons>* layers) const;
     void slice(float z, ExPolygons* slices) const;
+    
+    /// \brief Slices all the meshes in a single pass, keeping their loops apart.
+    /// \param[in] z Unscaled slicing heights.
+    /// \param[out] layers The loops of each mesh at each height, (*layers)[mesh_idx][layer_idx].
+    void slice(const std::vector<float> &z, std::vector< std::vector<Polygons> >* layers) const;
+    void make_expolygons(const Polygons &loops, ExPolygons* slices) const;
     void slice_facet(float slice_z, const stl_facet &facet, const int &facet_idx,
         const float &min_z, const float &max_z, std::vector<IntersectionLine>* lines,
         boost::mutex* lines_mutex = NULL) const;
@@ -132,13 +167,24 @@ class TriangleMeshSlicer
     void cut(float z, TriangleMesh* upper, TriangleMesh* lower) const;
     
     private:
-    typedef std::vector< std::vector<int> > t_facets_edges;
-    t_facets_edges facets_edges;
-    stl_vertex* v_scaled_shared;
-    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, const std::vector<float> &z) const;
+    TriangleMeshPtrs meshes;
+    /// Index of the first facet of each mesh, followed by the total number of facets.
+    std::vector<int> meshes_facets;
+    /// Three edge indices per facet.
+    std::vector<int> facets_edges;
+    /// Three shared vertex indices per facet, numbered across all the meshes.
+    std::vector<int> facets_vertices;
+    /// Transformed shared vertices of all the meshes.
+    std::vector<stl_vertex> v_shared;
+    /// Transformed and scaled shared vertices of all the meshes.
+    std::vector<stl_vertex> v_scaled_shared;
+    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex,
+        const std::vector<float> &z, bool by_mesh) const;
+    void _init(const TransformationMatrix &trafo);
+    /// Facet of the slicer tables, in the frame of the slices, with a non normalized normal.
+    stl_facet _facet(size_t facet_idx) const;
     void _make_loops_do(size_t i, std::vector<IntersectionLines>* lines, std::vector<Polygons>* layers) const;
     void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops) const;
-    void make_expolygons(const Polygons &loops, ExPolygons* slices) const;
     void make_expolygons_simple(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
     void make_expolygons(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
     
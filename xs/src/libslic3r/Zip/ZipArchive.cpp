@@ -34,6 +34,28 @@ ZipArchive::add_entry (std::string entry_path, std::string file_path)
     return stats;
 }
 
+mz_bool
+ZipArchive::add_entry_from_buffer (std::string entry_path, const void* buffer, size_t size, mz_uint level)
+{
+    stats = 0;
+    // Check if it's in the write mode.
+    if(mode != 'W')
+        return stats;
+    stats = mz_zip_writer_add_mem(&archive, entry_path.c_str(), buffer, size, level);
+    return stats;
+}
+
+mz_bool
+ZipArchive::extract_entry_to_callback (std::string entry_path, mz_file_write_func callback, void* opaque)
+{
+    stats = 0;
+    // Check if it's in the read mode.
+    if (mode != 'R')
+        return stats;
+    stats = mz_zip_reader_extract_file_to_callback(&archive, entry_path.c_str(), callback, opaque, 0);
+    return stats;
+}
+
 mz_bool
 ZipArchive::extract_entry (std::string entry_path, std::string file_path)
 {
@@ -45,6 +67,21 @@ ZipArchive::extract_entry (std::string entry_path, std::string file_path)
     return stats;
 }
 
+std::vector<std::string>
+ZipArchive::entries()
+{
+    std::vector<std::string> entries;
+    // Check if it's in the read mode.
+    if (mode != 'R')
+        return entries;
+    char entry_path[1024];
+    for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&archive); ++i) {
+        if (mz_zip_reader_get_filename(&archive, i, entry_path, sizeof(entry_path)) > 0)
+            entries.push_back(entry_path);
+    }
+    return entries;
+}
+
 mz_bool
 ZipArchive::finalize()
 {
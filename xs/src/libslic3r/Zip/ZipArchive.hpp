@@ -6,6 +6,7 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 #include "../../miniz/miniz.h"
 
 namespace Slic3r {
@@ -30,12 +31,32 @@ public:
     /// \return mz_bool 0: failure 1: success.
     mz_bool add_entry (std::string entry_path, std::string file_path);
 
+    /// Add an entry to the current zip archive from a memory buffer.
+    /// \param entry_path string the path of the entry in the zip archive.
+    /// \param buffer const void* the entry contents.
+    /// \param size size_t the size of the entry contents in bytes.
+    /// \param level mz_uint the compression level, 0 stores already compressed contents as is.
+    /// \return mz_bool 0: failure 1: success.
+    mz_bool add_entry_from_buffer (std::string entry_path, const void* buffer, size_t size, mz_uint level = ZIP_DEFLATE_COMPRESSION);
+
     /// Extract a zip entry to a file on the disk.
     /// \param entry_path string the path of the entry in the zip archive.
     /// \param file_path string the path of the file in the disk.
     /// \return mz_bool 0: failure 1: success.
     mz_bool extract_entry (std::string entry_path, std::string file_path);
 
+    /// Extract a zip entry by streaming its inflated contents to a callback, chunk by chunk.
+    /// The callback returns the number of bytes consumed, anything less than the chunk size aborts the extraction.
+    /// \param entry_path string the path of the entry in the zip archive.
+    /// \param callback mz_file_write_func the function receiving the inflated chunks.
+    /// \param opaque void* user data passed to the callback.
+    /// \return mz_bool 0: failure 1: success.
+    mz_bool extract_entry_to_callback (std::string entry_path, mz_file_write_func callback, void* opaque);
+
+    /// List the entries of the zip archive.
+    /// \return vector<string> the paths of the entries, empty if not in the read mode.
+    std::vector<std::string> entries();
+
     /// Finalize the archive and free any allocated memory.
     /// \return mz_bool 0: failure 1: success.
     mz_bool finalize();
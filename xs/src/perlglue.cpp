@@ -46,6 +46,7 @@ REGISTER_CLASS(BoundingBox, "Geometry::BoundingBox");
 REGISTER_CLASS(BoundingBoxf, "Geometry::BoundingBoxf");
 REGISTER_CLASS(BoundingBoxf3, "Geometry::BoundingBoxf3");
 REGISTER_CLASS(BridgeDetector, "BridgeDetector");
+REGISTER_CLASS(ClipperExpr, "Geometry::Clipper::Expr");
 REGISTER_CLASS(Point, "Point");
 REGISTER_CLASS(Point3, "Point3");
 REGISTER_CLASS(Pointf, "Pointf");
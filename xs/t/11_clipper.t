@@ -5,7 +5,7 @@ use warnings;
 
 use List::Util qw(sum);
 use Slic3r::XS;
-use Test::More tests => 23;
+use Test::More tests => 31;
 
 my $square = Slic3r::Polygon->new(  # ccw
     [200, 100],
@@ -206,6 +206,65 @@ if (0) {  # Clipper does not preserve polyline orientation
     is $result->[0]->length, $subject->length, 'intersection_pl - result has same length as subject polyline';
 }
 
+{
+    # chains of Clipper::Expr must match the same operations done one at a time
+    my $rect = sub {
+        my ($x1, $y1, $x2, $y2) = map $_ * 1000000, @_;
+        return Slic3r::Polygon->new([$x1, $y1], [$x2, $y1], [$x2, $y2], [$x1, $y2]);
+    };
+    my $subject = $rect->(0, 0, 40, 40);
+    my @clip = ($rect->(5, 5, 20, 20), $rect->(15, 15, 30, 30), $rect->(10, 25, 35, 38));
+    $clip[2]->reverse;  # clockwise, overlapping $clip[1]
+    my $expr = sub { Slic3r::Geometry::Clipper::Expr->new([ @_ ]) };
+    my $expr_ex = sub { Slic3r::Geometry::Clipper::Expr->new_from_expolygons([ map Slic3r::ExPolygon->new($_), @_ ]) };
+    my $same = sub {
+        my ($result, $expected, $name) = @_;
+        is_deeply [ scalar(@$result), sum(map $_->area, @$result) ],
+            [ scalar(@$expected), sum(map $_->area, @$expected) ], $name;
+    };
+    
+    $same->(
+        $expr->($subject)->diff($expr->($clip[0]))->diff($expr->($clip[1]))->diff($expr->($clip[2]))->expolygons,
+        Slic3r::Geometry::Clipper::diff_ex(Slic3r::Geometry::Clipper::diff(Slic3r::Geometry::Clipper::diff([$subject], [$clip[0]]), [$clip[1]]), [$clip[2]]),
+        'Expr: chained diff with a clockwise clip',
+    );
+    $same->(
+        $expr->($subject)->diff($expr_ex->($clip[0]))->diff($expr_ex->($clip[1]))->expolygons,
+        Slic3r::Geometry::Clipper::diff_ex(Slic3r::Geometry::Clipper::diff([$subject], [$clip[0]]), [$clip[1]]),
+        'Expr: chained diff',
+    );
+    $same->(
+        $expr->($subject)->diff($expr_ex->($clip[0]), 1)->diff($expr_ex->($clip[1]), 1)->expolygons,
+        Slic3r::Geometry::Clipper::diff_ex(Slic3r::Geometry::Clipper::diff([$subject], [$clip[0]], 1), [$clip[1]], 1),
+        'Expr: chained diff with safety offset',
+    );
+    $same->(
+        $expr->($subject)->intersection($expr->($clip[0]))->intersection($expr->($clip[1]))->expolygons,
+        Slic3r::Geometry::Clipper::intersection_ex(Slic3r::Geometry::Clipper::intersection([$subject], [$clip[0]]), [$clip[1]]),
+        'Expr: chained intersection',
+    );
+    $same->(
+        $expr->($clip[0])->union($expr->($clip[1]))->union($expr->($clip[2]))->expolygons,
+        Slic3r::Geometry::Clipper::union_ex([ @{Slic3r::Geometry::Clipper::union([ @clip[0,1] ])}, $clip[2] ]),
+        'Expr: chained union with a clockwise operand',
+    );
+    $same->(
+        $expr_ex->($clip[0])->union($expr_ex->($clip[1]))->expolygons,
+        Slic3r::Geometry::Clipper::union_ex([ @clip[0,1] ]),
+        'Expr: chained union',
+    );
+    $same->(
+        $expr->($subject)->diff($expr->($clip[0]))->offset2(-3000000, +3000000)->expolygons,
+        Slic3r::Geometry::Clipper::offset2_ex(Slic3r::Geometry::Clipper::diff([$subject], [$clip[0]]), -3000000, +3000000),
+        'Expr: offset2 of a diff',
+    );
+    $same->(
+        $expr->($subject)->diff($expr->($clip[0]))->evaluate->diff($expr_ex->($clip[1]))->expolygons,
+        Slic3r::Geometry::Clipper::diff_ex(Slic3r::Geometry::Clipper::diff([$subject], [$clip[0]]), [$clip[1]]),
+        'Expr: diff of an evaluated result',
+    );
+}
+
 if (0) {
     # Disabled until Clipper bug #127 is fixed
     my $subject = [
@@ -4,7 +4,7 @@ use strict;
 use warnings;
 
 use Slic3r::XS;
-use Test::More tests => 159;
+use Test::More tests => 167;
 use Data::Dumper;
 
 foreach my $config (Slic3r::Config->new, Slic3r::Config::Static::new_FullPrintConfig) {
@@ -218,6 +218,36 @@ foreach my $config (Slic3r::Config->new, Slic3r::Config::Static::new_FullPrintCo
         'apply dynamic over dynamic';
 }
 
+{
+    my $config = Slic3r::Config->new;
+    $config->set('layer_height', 0.3);
+    $config->set('extrusion_axis', 'A');
+    $config->set('fill_pattern', 'honeycomb');
+    
+    my $object_config = Slic3r::Config::Static::new_PrintObjectConfig;
+    $object_config->set('layer_height', 0.3);
+    is_deeply $config->diff_static($object_config), [], 'diff() skips options missing from the other config';
+    
+    # 0.3000001 serializes as 0.3
+    $object_config->set('layer_height', 0.3000001);
+    is_deeply $config->diff_static($object_config), ['layer_height'], 'diff() compares floats by value';
+    
+    my $region_config = Slic3r::Config::Static::new_PrintRegionConfig;
+    $region_config->set('fill_pattern', 'honeycomb');
+    ok !(grep $_ eq 'fill_pattern', @{$config->diff_static($region_config)}), 'diff() compares enums';
+    
+    my $empty = Slic3r::Config->new;
+    ok $empty->equals($config), 'empty config equals any config';
+    ok $config->equals($empty), 'any config equals an empty config';
+    
+    my $config2 = Slic3r::Config->new;
+    $config2->apply($config);
+    ok $config->equals($config2), 'equals() after apply()';
+    $config2->set('layer_height', 0.3000001);
+    ok !$config->equals($config2), 'equals() detects float changes beyond the serialized precision';
+    is_deeply $config->diff($config2), ['layer_height'], 'diff() between dynamic configs';
+}
+
 {
     my $config = Slic3r::Config->new;
     $config->set('extruder', 2);
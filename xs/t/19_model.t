@@ -4,7 +4,8 @@ use strict;
 use warnings;
 
 use Slic3r::XS;
-use Test::More tests => 4;
+use Test::More tests => 18;
+use File::Temp qw(tempdir);
 
 {
     my $model = Slic3r::Model->new;
@@ -19,4 +20,89 @@ use Test::More tests => 4;
     is_deeply $object->layer_height_ranges, $lhr, 'layer_height_ranges roundtrip';
 }
 
+{
+    my $cube = {
+        vertices    => [ [20,20,0], [20,0,0], [0,0,0], [0,20,0], [20,20,20], [0,20,20], [0,0,20], [20,0,20] ],
+        facets      => [ [0,1,2], [0,2,3], [4,5,6], [4,6,7], [0,4,7], [0,7,1], [1,7,6], [1,6,2], [2,6,5], [2,5,3], [4,0,3], [4,3,5] ],
+    };
+    my $mesh = Slic3r::TriangleMesh->new;
+    $mesh->ReadFromPerl($cube->{vertices}, $cube->{facets});
+    $mesh->repair;
+    
+    my $model = Slic3r::Model->new;
+    my $object = $model->_add_object;
+    my $volume = $object->_add_volume($mesh);
+    $volume->config->set_deserialize('perimeters', '5');
+    $object->_add_instance;
+    
+    my $dir = tempdir(CLEANUP => 1);
+    
+    {
+        my $path = "$dir/cube.snapshot";
+        ok $model->write_snapshot($path), 'snapshot is written';
+        my $model2 = Slic3r::Model->new;
+        ok $model2->read_snapshot($path), 'snapshot is read back';
+        my $volume2 = $model2->get_object(0)->get_volume(0);
+        is_deeply $volume2->mesh->facets, $volume->mesh->facets, 'snapshot roundtrip preserves the mesh';
+        is $volume2->config->serialize('perimeters'), '5', 'snapshot roundtrip preserves the volume config';
+        
+        # cut the file in the middle of the facets: the header then promises more facets than the file holds
+        my $data = do { local $/; open my $fh, '<:raw', $path or die; <$fh> };
+        open my $fh, '>:raw', $path or die;
+        print $fh substr($data, 0, int(length($data) / 2));
+        close $fh;
+        ok !Slic3r::Model->new->read_snapshot($path), 'truncated snapshot is rejected';
+        unlink $path;
+    }
+    
+    {
+        my $schematic = $object->schematic;
+        $schematic->setFilename('led.sch');
+        my $resistor = Slic3r::Electronics::ElectronicPart->new('R1', 'rcl', 'R-EU_', 'R0805', 'R0805');
+        $resistor->setSize(2, 1.25, 0.5);
+        $resistor->addPad('smd', '1', '1', 'G$1', -0.95, 0, 0, 1.3, 1.5, 0, '');
+        $resistor->addPad('smd', '2', '2', 'G$1', 0.95, 0, 0, 1.3, 1.5, 0, '');
+        $schematic->addElectronicPart($resistor);
+        my $led = Slic3r::Electronics::ElectronicPart->new('LED1', 'led', 'LED', '3MM', 'LED3MM');
+        $led->setSize(3, 3, 4);
+        $led->addPad('pad', 'A', 'A', 'G$1', -1.27, 0, 0, 0, 0, 0.8, 'round');
+        $led->addPad('pad', 'K', 'C', 'G$1', 1.27, 0, 0, 0, 0, 0.8, 'round');
+        $schematic->addElectronicPart($led);
+        my $net = Slic3r::Electronics::ElectronicNet->new('N1');
+        $net->addPin('R1', '2', 'G$1');
+        $net->addPin('LED1', 'A', 'G$1');
+        $schematic->addElectronicNet($net);
+        
+        $resistor->setPosition(5, 5, 2);
+        $resistor->setRotation(0, 0, 90);
+        $resistor->setPlaced(1);
+        $led->setPosition(15, 12, 2);
+        $led->setPlaced(1);
+        $schematic->updateRubberBands;
+        # route the net over a waypoint
+        $schematic->addWire($schematic->getNetPoints->[0], Slic3r::Pointf3->new(10, 2, 3));
+        
+        my $path = "$dir/led.snapshot";
+        ok $model->write_snapshot($path), 'snapshot with schematic is written';
+        my $model2 = Slic3r::Model->new;
+        ok $model2->read_snapshot($path), 'snapshot with schematic is read back';
+        my $schematic2 = $model2->get_object(0)->schematic;
+        is $schematic2->getFilename, 'led.sch', 'snapshot roundtrip preserves the schematic file name';
+        my $parts = sub { [ map [ $_->getName, $_->isPlaced, [ @{$_->getPosition} ], [ @{$_->getRotation} ] ], @{$_[0]->getPartlist} ] };
+        is_deeply $parts->($schematic2), $parts->($schematic), 'snapshot roundtrip preserves the parts and their placing';
+        my $net_points = sub { [ map [ $_->getNetName, $_->isWaypointType, [ @{$_->getPoint} ] ], @{$_[0]->getNetPoints} ] };
+        is_deeply $net_points->($schematic2), $net_points->($schematic), 'snapshot roundtrip preserves the net points';
+        is scalar(grep $_->isWired, @{$schematic2->getRubberBands}), 1, 'snapshot roundtrip preserves the wires';
+    }
+    
+    {
+        my $path = "$dir/cube.amf";
+        ok $model->write_amf($path, 1), 'compressed AMF is written';
+        my $model2 = Slic3r::Model->new;
+        ok $model2->read_amf($path), 'compressed AMF is read back';
+        is $model2->get_object(0)->get_volume(0)->mesh->facets_count, 12, 'compressed AMF roundtrip preserves the mesh';
+        unlink $path;
+    }
+}
+
 __END__